@@ -54,18 +54,105 @@
       lastPersist = now;
     } catch(e){ /* storage full or denied */ }
   }
+  // Fresh browser (nothing in localStorage): seed the chart from the device-side history log
+  async function loadDeviceHistory(){
+    if (dataHistory.length) return;
+    try {
+      const to = Math.floor(Date.now() / 1000);
+      const from = to - Math.floor(HISTORY_MAX_AGE_MS / 1000);
+      const r = await fetch(`/api/history?from=${from}&to=${to}&step=180`, { cache: 'no-store' });
+      if (!r.ok) return;
+      const d = await r.json();
+      if (!Array.isArray(d.points) || !d.points.length || dataHistory.length) return;
+      dataHistory = d.points.map(p => ({ timestamp: p[0] * 1000, temperature: p[1], humidity: p[2], units: d.units }));
+      window.__momo_history = dataHistory;
+      try { window.dispatchEvent(new Event('momo-data')); } catch(e) {}
+    } catch(e){ /* device history unavailable (clock not synced yet) */ }
+  }
   // Save on tab close / hide for extra safety
   window.addEventListener('beforeunload', () => persistHistory(true));
   document.addEventListener('visibilitychange', () => { if (document.visibilityState === 'hidden') persistHistory(true); });
 
+  // Binary live telemetry (layout in include/telemetry_frame.h), negotiated via WebSocket
+  // subprotocol. Frames are merged onto the last full JSON document so render() sees one shape.
+  const TELEMETRY_PROTO = 'reptimon.bin.v2';
+  const TELEMETRY_STATUS = ['Perfect', 'Too Cold', 'Too Hot', 'Too Dry', 'Too Wet'];
+  function openTelemetrySocket(plain){
+    const socket = plain ? new WebSocket(`ws://${location.host}/ws`) : new WebSocket(`ws://${location.host}/ws`, TELEMETRY_PROTO);
+    socket.binaryType = 'arraybuffer';
+    return socket;
+  }
+  function decodeTelemetry(data){
+    if (typeof data === 'string') {
+      // JSON: full document on connect, then live frames and occasional {"type":"system"} frames.
+      // Partial frames are merged onto the last known document.
+      const pkt = JSON.parse(data);
+      if (pkt.event) return pkt;
+      const base = window.__momo_last || {};
+      const merged = { ...base, ...pkt, system: { ...(base.system || {}), ...(pkt.system || {}) } };
+      delete merged.type;
+      return merged;
+    }
+    const v = new DataView(data);
+    if (v.byteLength < 96 || v.getUint8(0) !== 0xA5 || v.getUint8(1) !== 2 || v.getUint8(2) !== 1) return null;
+    const f32 = (o) => v.getFloat32(o, true);
+    const u32 = (o) => v.getUint32(o, true);
+    const flags = v.getUint8(3);
+    const base = window.__momo_last || {};
+    const pkt = {
+      ...base,
+      temperature: f32(16), humidity: f32(20), dewPoint: f32(24), heatIndex: f32(28),
+      vpd: f32(32), absoluteHumidity: f32(36),
+      timestamp: u32(8), valid: !!(flags & 0x01), units: (flags & 0x02) ? 'F' : 'C',
+      tempStatus: TELEMETRY_STATUS[v.getUint8(40)] || 'Perfect',
+      humStatus: TELEMETRY_STATUS[v.getUint8(41)] || 'Perfect',
+      system: { ...(base.system || {}), uptime: u32(12), rssi: v.getInt8(42), freeHeap: u32(84), freePsram: u32(88),
+                sensorHz: f32(92), sta: !!(flags & 0x08), camera: !!(flags & 0x10) }
+    };
+    if (flags & 0x04) {
+      // Keep the rolling windows from the last JSON document; the frame carries since-boot values only
+      pkt.stats = { ...(base.stats || {}), tempMin: f32(44), tempMax: f32(48), tempAvg: f32(52), humMin: f32(56), humMax: f32(60), humAvg: f32(64),
+                    dewMin: f32(68), dewMax: f32(72), dewAvg: f32(76), readingCount: u32(80) };
+    }
+    // Channel records (20 bytes each) follow the header; ids/kinds come from the JSON document
+    const nch = v.getUint8(43);
+    if (nch && Array.isArray(base.channels)) {
+      const channels = base.channels.slice();
+      for (let i = 0, o = 96; i < nch && o + 20 <= v.byteLength; i++, o += 20) {
+        const idx = v.getUint8(o), cf = v.getUint8(o + 1);
+        if (!channels[idx]) continue;
+        const ch = { ...channels[idx], valid: !!(cf & 0x01), temperature: f32(o + 4),
+                     tempStatus: TELEMETRY_STATUS[v.getUint8(o + 2)] || 'Perfect' };
+        if (cf & 0x02) {
+          ch.humidity = f32(o + 8); ch.dewPoint = f32(o + 12); ch.vpd = f32(o + 16);
+          ch.humStatus = TELEMETRY_STATUS[v.getUint8(o + 3)] || 'Perfect';
+        }
+        channels[idx] = ch;
+      }
+      pkt.channels = channels;
+    }
+    return pkt;
+  }
+
   // App entry
+  // Partials and components: the bundled index.html carries them as inert
+  // <template data-src> elements, instantiated only when first shown. Otherwise
+  // fetch the content-hashed file named by the build manifest (never changes, so
+  // cacheable), or the plain path for an image built straight from data/.
+  async function assetText(url) {
+    const tpl = document.querySelector(`template[data-src="${url}"]`);
+    if (tpl) return tpl.innerHTML;
+    const hashed = window.ASSET_MANIFEST && window.ASSET_MANIFEST[url];
+    const r = await (hashed ? fetch(hashed) : fetch(url, { cache: 'no-store' }));
+    if (!r.ok) throw new Error('failed');
+    return r.text();
+  }
+
   async function loadPartial(id, url) {
     const host = document.getElementById(id);
     if (!host) return null;
     try {
-      const r = await fetch(url, { cache: 'no-store' });
-      if (!r.ok) throw new Error('failed');
-      host.innerHTML = await r.text();
+      host.innerHTML = await assetText(url);
       return host;
     } catch (e) {
       console.warn('Partial load failed', id, url, e);
@@ -116,6 +203,7 @@
     setInterval(updateFooterNet, 5000);
     // Load any persisted history before components mount so charts can show instantly
     loadPersistedHistory();
+    loadDeviceHistory();
     window.addEventListener('resize', applyFixedBars);
     window.addEventListener('orientationchange', applyFixedBars);
 
@@ -188,15 +276,20 @@
     });
 
     // 5. Live data websocket + fallback polling
-    function connectWS() {
+    function connectWS(plain = false) {
       try {
-        const socket = new WebSocket(`ws://${location.host}/ws`);
+        const socket = openTelemetrySocket(plain);
         const badge = $('#connBadge');
-        socket.onopen = () => { setStatus('Live data connected'); if (badge){ badge.textContent='Live'; badge.classList.remove('muted'); } };
-        socket.onclose = () => { setStatus('Live data disconnected'); if (badge){ badge.textContent='Idle'; badge.classList.add('muted'); } };
+        let opened = false;
+        socket.onopen = () => { opened = true; setStatus('Live data connected'); if (badge){ badge.textContent='Live'; badge.classList.remove('muted'); } };
+        socket.onclose = () => {
+          setStatus('Live data disconnected'); if (badge){ badge.textContent='Idle'; badge.classList.add('muted'); }
+          if (!opened && !plain) connectWS(true); // firmware without binary telemetry: retry as plain JSON
+        };
         socket.onmessage = (e) => {
           try {
-            const pkt = JSON.parse(e.data);
+            const pkt = decodeTelemetry(e.data);
+            if (!pkt) return;
             window.__momo_last = pkt;
             if (document.hidden) return; // avoid catch-up bursts while hidden
             render(pkt);
@@ -243,9 +336,7 @@
     const view = document.getElementById('view');
     if (!view) return;
     try {
-      const r = await fetch(`/components/${name}.html`, { cache: 'no-store' });
-      if (!r.ok) throw new Error('failed');
-      const html = await r.text();
+      const html = await assetText(`/components/${name}.html`);
       try {
         currentCleanup && currentCleanup();
       } catch (e) {}
@@ -269,7 +360,10 @@
   // Render incoming data across UI
   function render(d) {
     const now = Date.now();
-    dataHistory.push({ ...d, timestamp: now });
+    // Binary telemetry arrives at up to 5 Hz: keep history at ~1 point/s by updating the newest point in place
+    const lastPoint = dataHistory[dataHistory.length - 1];
+    if (lastPoint && (now - lastPoint.timestamp) < 1000) dataHistory[dataHistory.length - 1] = { ...d, timestamp: lastPoint.timestamp };
+    else dataHistory.push({ ...d, timestamp: now });
     window.__momo_last = d;
     window.__momo_history = dataHistory;
     if (dataHistory.length > 240) dataHistory.shift();
@@ -1366,18 +1460,23 @@
 
     // Mini camera bindings
     const mini = document.getElementById('snapshotMini');
-    const refreshMini = () => mini && (mini.src = '/api/camera/snapshot?ts=' + Date.now());
+    // The dashboard card only needs a thumbnail
+    const refreshMini = () => mini && (mini.src = '/api/camera/thumb?scale=2&ts=' + Date.now());
     document.getElementById('refreshMini')?.addEventListener('click', refreshMini);
     let miniAuto = false;
     const miniAutoBtn = document.getElementById('miniAuto');
     function reflectMiniAuto() {
       miniAutoBtn?.classList.toggle('on', !!miniAuto);
     }
+    // Paced on the client at the device's thumbnail rate (THUMB_INTERVAL_MS):
+    // any thumbnail from the current interval is accepted, so a reload never
+    // waits for an encode and back-to-back reloads would only repeat it
+    const MINI_REFRESH_MS = 250;
     function miniStep() {
       if (!miniAuto || !mini) return;
-      mini.src = '/api/camera/snapshot?ts=' + Date.now();
+      mini.src = '/api/camera/thumb?scale=2&maxAge=' + MINI_REFRESH_MS + '&ts=' + Date.now();
     }
-    if (mini) mini.onload = () => { if (miniAuto) setTimeout(miniStep, 0); };
+    if (mini) mini.onload = () => { if (miniAuto) setTimeout(miniStep, MINI_REFRESH_MS); };
     function toggleMiniAuto() {
       miniAuto = !miniAuto;
       reflectMiniAuto();
@@ -1399,12 +1498,14 @@
   function initCameraBindings() {
     const img = document.getElementById('snapshot');
     const wrap = document.getElementById('camWrap');
+    // A hidden tab keeps a 1 fps feed so the stream resumes instantly without using the link
+    const streamUrl = () => '/api/camera/stream' + (document.hidden ? '?fps=1' : '');
     const refresh = () => {
       if (!img) return;
       // When live, restarting reassigns stream URL to force reconnect
       if (img.src && img.src.includes('/api/camera/stream')) {
         img.src = '';
-        setTimeout(() => img && (img.src = '/api/camera/stream'), 30);
+        setTimeout(() => img && (img.src = streamUrl()), 30);
       } else {
         img.src = '/api/camera/snapshot?ts=' + Date.now();
       }
@@ -1436,21 +1537,26 @@
       autoBtn?.classList.toggle('on', live);
       if (!img) return;
       if (live) {
-        img.src = '/api/camera/stream';
+        img.src = streamUrl();
       } else {
         img.src = '/api/camera/snapshot?ts=' + Date.now();
       }
     }
     // Live data: WebSocket + poll fallback
-    function connectWS() {
+    function connectWS(plain = false) {
       try {
-        const socket = new WebSocket(`ws://${location.host}/ws`);
+        const socket = openTelemetrySocket(plain);
         const badge = document.getElementById('connBadge');
-        socket.onopen = () => { setStatus('Live data connected'); if (badge){ badge.textContent='Live'; badge.classList.remove('muted'); } };
-        socket.onclose = () => { setStatus('Live data disconnected'); if (badge){ badge.textContent='Idle'; badge.classList.add('muted'); } };
-        socket.onmessage = (e) => { try { render(JSON.parse(e.data)); } catch (err) {} };
+        let opened = false;
+        socket.onopen = () => { opened = true; setStatus('Live data connected'); if (badge){ badge.textContent='Live'; badge.classList.remove('muted'); } };
+        socket.onclose = () => {
+          setStatus('Live data disconnected'); if (badge){ badge.textContent='Idle'; badge.classList.add('muted'); }
+          if (!opened && !plain) connectWS(true);
+        };
+        socket.onmessage = (e) => { try { const pkt = decodeTelemetry(e.data); if (pkt) render(pkt); } catch (err) {} };
       } catch (err) {}
     }
+    document.addEventListener('visibilitychange', () => { if (live && img) img.src = streamUrl(); });
     connectWS();
     setStatus('Initializing...');
     setLive(true);
@@ -1731,6 +1837,12 @@
           f.camsize.value = d.camera.frameSize;
           f.camq.value = d.camera.quality;
         }
+        if (d.filter && f.fmed) {
+          f.fmed.value = d.filter.median;
+          f.fsmooth.value = d.filter.smoothing;
+          f.falpha.value = d.filter.alpha;
+          f.fdec.value = d.filter.decimation;
+        }
       } catch (e) {}
     }
     loadSettings();
@@ -1756,6 +1868,12 @@
           frameSize: parseInt(f.camsize.value, 10),
           quality: parseInt(f.camq.value, 10),
         },
+        filter: f.fmed ? {
+          median: parseInt(f.fmed.value, 10),
+          smoothing: parseInt(f.fsmooth.value, 10),
+          alpha: parseFloat(f.falpha.value),
+          decimation: parseInt(f.fdec.value, 10),
+        } : undefined,
       };
       try {
         await fetch('/api/settings/save', { method: 'POST', headers: { 'Content-Type': 'application/json' }, body: JSON.stringify(payload) });
@@ -0,0 +1,49 @@
+#pragma once
+// Dispatcher for the JSON API, mounted ahead of static file serving.
+//
+// ESPAsyncWebServer tries its handlers in registration order, so API requests
+// used to pass the LittleFS serveStatic handlers (and their filesystem
+// existence checks) before reaching a route. The router is mounted as one
+// prefix handler per API root ("/api/*", ...) registered before the static
+// handlers; inside, routes live in a segment trie keyed by path (route_trie.h),
+// with a method mask per route, so matching costs one walk over the path regardless of how
+// many routes exist. Unknown API paths get a JSON 404 (405 for a known path
+// with another method) instead of falling through to the filesystem.
+//
+// Routes are added during setup; tables are fixed-size and never reallocate.
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include "route_trie.h"
+
+#define API_ROUTER_MAX_ROUTES 64
+#define API_ROUTER_MAX_NODES  96
+
+class ApiRouter {
+public:
+  // Register prefix ("/api/*") or an exact path on the server, dispatching into this router
+  void mount(AsyncWebServer &server, const char *prefix);
+  // Same shape as server.on(); false if the tables are full. path must outlive the router.
+  bool on(const char *path, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest,
+          ArUploadHandlerFunction onUpload = nullptr, ArBodyHandlerFunction onBody = nullptr);
+
+  int routeCount() const { return _routeCount; }
+  int nodeCount() const { return _trie.nodeCount(); }
+
+private:
+  struct Route {
+    WebRequestMethodComposite method;
+    ArRequestHandlerFunction onRequest;
+    ArUploadHandlerFunction onUpload;
+    ArBodyHandlerFunction onBody;
+    int16_t next;          // next route on the same node (other methods), -1 = none
+  };
+  // Route for the request's path and method; *pathKnown set when only the method differs
+  const Route *match(AsyncWebServerRequest *request, bool *pathKnown = nullptr) const;
+  void dispatch(AsyncWebServerRequest *request);
+
+  Route _routes[API_ROUTER_MAX_ROUTES];
+  RouteTrie<API_ROUTER_MAX_NODES> _trie;   // node value: first route ending there
+  int _routeCount = 0;
+};
+
+extern ApiRouter apiRouter;
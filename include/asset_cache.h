@@ -0,0 +1,70 @@
+#pragma once
+// PSRAM-resident cache of web UI files with preformatted response headers.
+//
+// A file is read from LittleFS on its first request (the .gz variant when the
+// asset pipeline produced one) into a PSRAM buffer, together with its content
+// type, an ETag over the stored bytes and the header lines it is served with;
+// later requests go out from memory through the response arena without
+// touching the filesystem. Buffers are reference counted, so an entry evicted
+// (LRU, within ASSET_CACHE_BUDGET bytes) or invalidated while a response is
+// still sending stays valid until that response is done.
+//
+// Lookups run on the AsyncTCP task only; invalidate() may be called from any
+// task (e.g. after a filesystem OTA) and takes effect at the next lookup.
+// Without PSRAM nothing is cached and callers fall back to the filesystem.
+#include <Arduino.h>
+#include <FS.h>
+#include <ESPAsyncWebServer.h>
+#include <memory>
+
+#ifndef ASSET_CACHE_BUDGET
+#define ASSET_CACHE_BUDGET   (512 * 1024)   // bytes of file data held in PSRAM
+#endif
+#define ASSET_CACHE_ENTRIES  32
+#define ASSET_CACHE_MAX_PATH 56
+
+struct AssetCacheStats {
+  uint32_t entries;
+  uint32_t bytes;
+  uint32_t hits;
+  uint32_t misses;      // loads from the filesystem
+  uint32_t evictions;
+  uint32_t notModified; // 304s answered from the cached ETag
+};
+
+class AssetCache {
+public:
+  void begin(fs::FS &fs, size_t budget = ASSET_CACHE_BUDGET);
+  // Respond to request with the file at path (or path.gz) from memory, loading
+  // it first if needed; false if it does not exist or cannot be cached
+  bool send(AsyncWebServerRequest *request, const char *path);
+  void invalidate() { _generation++; }
+  AssetCacheStats stats() const;
+  size_t budget() const { return _budget; }
+
+private:
+  struct Entry {
+    char path[ASSET_CACHE_MAX_PATH];   // request path; empty = free
+    std::shared_ptr<const uint8_t> data;
+    uint32_t len;
+    const char *type;
+    char etag[12];
+    char headers[112];                 // ETag, Cache-Control, Content-Encoding lines
+    uint32_t lastUsed;
+  };
+  Entry *find(const char *path);
+  Entry *load(const char *path);
+  void evictFor(uint32_t len);
+  void clear();
+
+  fs::FS *_fs = nullptr;
+  size_t _budget = 0;
+  size_t _bytes = 0;
+  Entry _entries[ASSET_CACHE_ENTRIES] = {};
+  uint32_t _clock = 0;
+  volatile uint32_t _generation = 0;
+  uint32_t _seen = 0;
+  uint32_t _hits = 0, _misses = 0, _evictions = 0, _notModified = 0;
+};
+
+extern AssetCache assetCache;
@@ -0,0 +1,50 @@
+#pragma once
+// 1/2, 1/4 and 1/8 scale JPEGs derived from the shared camera frames.
+//
+// Each scale has its own FrameRing. A consumer asking for a scale marks that
+// ring wanted; after each capture the camera task decodes the new frame with
+// the JPEG decoder's built-in downscaling (only 1/2^k of the pixels are ever
+// produced), re-encodes the result and publishes it, at most once per
+// THUMB_INTERVAL_MS per scale. Thumbnails are therefore made once per capture
+// epoch however many clients read them, and never on the AsyncTCP task.
+//
+// update() runs in the camera task only; stats() may be read from any task.
+#include <Arduino.h>
+#include "frame_ring.h"
+#include "histogram.h"
+
+#define THUMB_SCALES        3      // 1/2, 1/4, 1/8
+#define THUMB_INTERVAL_MS   250    // per scale, while wanted
+#define THUMB_JPEG_QUALITY  70     // 1..100, higher is better
+
+struct ThumbStats {
+  uint32_t encoded;
+  uint32_t failed;
+  Log2Histogram<24> encodeUs;    // decode + re-encode of one thumbnail
+};
+
+class CameraThumbs {
+public:
+  // 2, 4 or 8 -> ring index; -1 for anything else
+  static int indexFor(int scale);
+  FrameRing &ring(int index) { return _rings[index]; }
+  bool begin();
+
+  // Camera task: refresh every wanted scale from a just-published frame; true
+  // if any thumbnail was published
+  bool update(const CameraFramePtr &frame);
+  ThumbStats stats(int index) const;
+  size_t scratchBytes() const { return _rgbCap; }
+
+private:
+  bool encode(const CameraFrame &src, int index);
+
+  FrameRing _rings[THUMB_SCALES];
+  uint32_t _lastMs[THUMB_SCALES] = {};
+  ThumbStats _stats[THUMB_SCALES] = {};
+  mutable portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+  uint8_t *_rgb = nullptr;       // RGB565 decode target, grown to the largest scale used
+  size_t _rgbCap = 0;
+};
+
+extern CameraThumbs cameraThumbs;
@@ -0,0 +1,86 @@
+#pragma once
+// Latest-frame ring shared by every camera consumer.
+//
+// One capture task grabs each JPEG from the driver, copies it into a PSRAM
+// slot and publishes it; MJPEG streams and snapshots take a reference to the
+// newest published frame without touching the camera or cameraMutex. Frames
+// are shared_ptrs owned by the ring: a reader's copy keeps its slot alive, and
+// the writer only reuses a slot that is neither the latest nor referenced by
+// anyone. The writer never waits for readers: when every other slot is still
+// held the capture is dropped and counted, so a slow client simply picks up the
+// newest frame when it asks for its next one.
+//
+// Capture runs while there is demand (a consumer asked within the last
+// FRAME_RING_IDLE_MS) and sleeps otherwise. Slot bookkeeping is guarded by a
+// portMUX; frame bytes are written outside it into a slot no reader can reach
+// until it is published.
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <memory>
+
+// Sized so that stream viewers alone can never hold every slot: in the worst
+// case each one has all its in-flight frames unacknowledged and none of them is
+// the latest, which still leaves the latest, one to write into and one for
+// snapshot responses
+#define FRAME_RING_VIEWERS       4  // stream viewers accepted at once
+#define FRAME_RING_VIEWER_FRAMES 2  // frames one viewer may have unacknowledged
+#ifndef FRAME_RING_SLOTS
+#define FRAME_RING_SLOTS   (FRAME_RING_VIEWERS * FRAME_RING_VIEWER_FRAMES + 3)
+#endif
+#define FRAME_RING_IDLE_MS 3000   // capture stops this long after the last consumer request
+
+struct CameraFrame {
+  uint8_t *buf;
+  size_t len;
+  size_t capacity;        // bytes allocated for buf; grows with the frame size
+  uint32_t seq;           // publish count, 1-based
+  uint32_t capturedMs;
+  uint16_t width;
+  uint16_t height;
+};
+typedef std::shared_ptr<const CameraFrame> CameraFramePtr;
+
+struct FrameRingStats {
+  uint32_t published;
+  uint32_t dropped;       // captures discarded: no free slot or no memory
+  uint32_t slotBytes;     // frame buffer bytes allocated across slots
+  bool psram;
+  bool capturing;         // demand within FRAME_RING_IDLE_MS
+};
+
+class FrameRing {
+public:
+  bool begin();
+
+  // ---- Capture task ----
+  // Copy a frame in and make it the latest; false if it was dropped
+  bool publish(const uint8_t *data, size_t len, uint16_t width, uint16_t height);
+  bool wanted() const { return _demanded && millis() - _demandMs < FRAME_RING_IDLE_MS; }
+  // Block until a consumer calls demand() or the timeout passes
+  void waitForDemand(TickType_t timeout);
+
+  // ---- Consumers (any task) ----
+  // Keep the capture task running
+  void demand();
+  // Newest frame, or null before the first capture. Consumers never wait for
+  // the next one; see cameraWaiters (tcp_wake.h) for being woken on publish.
+  CameraFramePtr latest() const;
+
+  FrameRingStats stats() const;
+
+private:
+  bool reserve(CameraFrame &f, size_t len);
+
+  std::shared_ptr<CameraFrame> _slots[FRAME_RING_SLOTS];
+  int _latest = -1;
+  mutable portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+  TaskHandle_t _writer = nullptr;
+  volatile uint32_t _demandMs = 0;
+  volatile bool _demanded = false;
+  uint32_t _published = 0;
+  uint32_t _dropped = 0;
+  bool _psram = false;
+};
+
+extern FrameRing frameRing;
@@ -0,0 +1,61 @@
+#pragma once
+// Fixed-size histograms for timing measurements (no allocation, POD, safe to
+// copy out under a critical section).
+#include <stdint.h>
+#include <string.h>
+
+// Power-of-two buckets: bin 0 holds 0, bin b holds [2^(b-1), 2^b - 1]; the last
+// bin also takes everything larger. Suited to latencies spanning decades.
+template <int N>
+struct Log2Histogram {
+  uint32_t bins[N];
+  uint32_t count;
+  uint32_t max;
+  uint64_t sum;
+
+  void reset() { memset(this, 0, sizeof(*this)); }
+  void add(uint32_t v) {
+    int b = v ? 32 - __builtin_clz(v) : 0;
+    if (b >= N) b = N - 1;
+    bins[b]++;
+    count++;
+    sum += v;
+    if (v > max) max = v;
+  }
+  static uint32_t binUpper(int b) { return b == 0 ? 0 : (b >= 32 ? 0xFFFFFFFFu : (1u << b) - 1); }
+  // Upper bound of the bin containing the p-th percentile (0..100)
+  uint32_t percentile(float p) const {
+    if (!count) return 0;
+    uint32_t target = (uint32_t)((count - 1) * p / 100.0f) + 1, seen = 0;
+    for (int b = 0; b < N; b++) {
+      seen += bins[b];
+      if (seen >= target) return b == N - 1 ? max : binUpper(b);
+    }
+    return max;
+  }
+  uint32_t mean() const { return count ? (uint32_t)(sum / count) : 0; }
+};
+
+// Linear buckets of `width` starting at `origin`; the first and last bins catch
+// underflow and overflow. Suited to a value expected near a nominal point.
+template <int N>
+struct LinearHistogram {
+  int32_t origin;
+  int32_t width;
+  uint32_t bins[N];
+  uint32_t count;
+  int32_t min, max;
+
+  void reset(int32_t o, int32_t w) { memset(this, 0, sizeof(*this)); origin = o; width = w; }
+  // Bins of width w with `nominal` in the middle of the middle bin (N odd)
+  void resetCentered(int32_t nominal, int32_t w) { reset(nominal - N * w / 2, w); }
+  void add(int32_t v) {
+    int b = v < origin ? 0 : (int)((v - origin) / width);
+    if (b >= N) b = N - 1;
+    bins[b]++;
+    if (!count || v < min) min = v;
+    if (!count || v > max) max = v;
+    count++;
+  }
+  int32_t binStart(int b) const { return origin + b * width; }
+};
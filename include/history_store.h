@@ -0,0 +1,119 @@
+#pragma once
+// Append-only sensor history on LittleFS.
+//
+// Samples coming from sensorTask are averaged into one record per
+// HISTORY_SAMPLE_INTERVAL_S and parked in a small RAM ring. flush() (called from
+// a low-priority task, never from sensorTask) appends the ring to a segment file
+// in one write, so flash sees one small append every few minutes instead of one
+// per sample. Each segment covers a fixed wall-clock span and is named after its
+// start time, which lets queries open only the segments that overlap the range.
+// Records carry a CRC so a write torn by a reset is skipped on read. Records are
+// only ever appended in time order; samples from a wall clock that stepped back
+// are dropped (see addSample).
+#include <Arduino.h>
+#include <FS.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#ifndef HISTORY_SAMPLE_INTERVAL_S
+#define HISTORY_SAMPLE_INTERVAL_S   10      // one stored record per 10 s
+#endif
+#ifndef HISTORY_SEGMENT_SPAN_S
+#define HISTORY_SEGMENT_SPAN_S      21600   // 6 h per segment file (~21 KB)
+#endif
+#ifndef HISTORY_MAX_SEGMENTS
+#define HISTORY_MAX_SEGMENTS        12      // retention: 3 days
+#endif
+#ifndef HISTORY_FLUSH_INTERVAL_S
+#define HISTORY_FLUSH_INTERVAL_S    300     // write to flash at most every 5 min
+#endif
+#define HISTORY_PENDING_CAP         64      // RAM ring (must exceed flush interval / sample interval)
+#define HISTORY_DIR                 "/hist"
+
+// On-flash record (10 bytes). Values are fixed-point to keep segments small.
+struct __attribute__((packed)) HistoryRecord {
+  uint32_t ts;        // unix seconds (start of the averaging interval)
+  int16_t  tempC100;  // °C * 100
+  uint16_t humC100;   // %RH * 100
+  uint8_t  flags;     // reserved, 0
+  uint8_t  crc;       // CRC-8 over the preceding bytes
+};
+
+class HistoryStore {
+public:
+  bool begin(fs::FS &fs);
+  // Called from sensorTask for every valid reading. Cheap: no I/O.
+  void addSample(uint32_t unixTs, float tempC, float humidity);
+  // Persist pending records. Writes only when the batch is due unless force is set.
+  // Callers on different tasks (webTask, reboot handler, serial) are serialized.
+  void flush(bool force = false);
+
+  // Streaming query cursor: fills a caller buffer with a JSON document
+  // {"from":..,"to":..,"step":..,"units":"C","points":[[ts,t,h],...]}
+  // reading one segment at a time. Points are averaged into step-second buckets.
+  class Cursor {
+  public:
+    Cursor(HistoryStore &store, uint32_t from, uint32_t to, uint32_t step, bool fahrenheit);
+    ~Cursor();
+    size_t read(uint8_t *buf, size_t maxLen);
+  private:
+    bool nextRecord(HistoryRecord &rec);
+    bool openNextSegment();
+    void emitBucket();
+    HistoryStore &_store;
+    uint32_t _from, _to, _step;
+    bool _fahrenheit;
+    uint32_t _segStart;      // start of the segment currently open / next to open
+    File _file;
+    bool _segmentsDone = false;
+    size_t _pendingIdx = 0;  // index into RAM snapshot once segments are exhausted
+    uint32_t _lastTs = 0;    // newest record returned from flash
+    HistoryRecord _ram[HISTORY_PENDING_CAP];
+    size_t _ramCount = 0;
+    // Bucket accumulator
+    uint32_t _bucket = 0;
+    uint32_t _bucketN = 0;
+    float _sumT = 0, _sumH = 0;
+    bool _first = true;
+    bool _headerDone = false;
+    bool _footerDone = false;
+    char _text[96];
+    size_t _textLen = 0, _textOff = 0;
+  };
+
+  uint32_t oldestSegment() const { return _oldest; }
+  uint32_t recordsWritten() const { return _written; }
+  uint32_t flushCount() const { return _flushes; }
+  uint32_t samplesDropped() const { return _dropped; }
+  size_t pendingCount() const;
+
+  static uint8_t crc8(const uint8_t *data, size_t len);
+  static String segmentPath(uint32_t segStart);
+
+private:
+  void pushRecord(const HistoryRecord &rec);
+  size_t snapshotPending(HistoryRecord *out, size_t cap) const;
+  void enforceRetention();
+  uint32_t newestStoredTs();
+  bool appendAligned(uint32_t segStart, const HistoryRecord *recs, size_t n);
+
+  fs::FS *_fs = nullptr;
+  mutable portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+  SemaphoreHandle_t _flushMutex = NULL;   // one flush at a time: snapshot, write, drop
+  // Current averaging interval (sensorTask side)
+  uint32_t _accTs = 0;
+  uint32_t _accN = 0;
+  uint32_t _minSlot = 0;                  // oldest slot still accepted
+  uint32_t _dropped = 0;                  // samples behind _minSlot
+  float _accT = 0, _accH = 0;
+  // Completed records waiting for flash
+  HistoryRecord _pending[HISTORY_PENDING_CAP];
+  size_t _pendHead = 0, _pendCount = 0;
+  uint32_t _lastFlushMs = 0;
+  uint32_t _oldest = 0;
+  uint32_t _newest = 0;                   // start of the newest segment, 0 = none
+  uint32_t _written = 0;
+  uint32_t _flushes = 0;
+};
+
+extern HistoryStore historyStore;
@@ -0,0 +1,58 @@
+#pragma once
+// OpenMetrics text exposition, produced one line at a time.
+//
+// Metrics are described by a static table of families; each family's sampler
+// is called with an increasing index and fills in one sample (labels + value)
+// per call. MetricsCursor::read() formats lines into the caller's buffer (a
+// chunked response callback), so a scrape never materialises the whole body:
+// memory stays one line regardless of how many metrics are added.
+//
+// Counter families get the `_total` suffix and info families `_info`; for
+// stateset families the sampler's labels carry the state. Hardware-free.
+#include <stdint.h>
+#include <stddef.h>
+
+enum MetricType : uint8_t { METRIC_GAUGE, METRIC_COUNTER, METRIC_STATESET, METRIC_INFO };
+
+enum MetricStep : uint8_t {
+  METRIC_END,    // no sample at this index or beyond
+  METRIC_SKIP,   // nothing at this index (e.g. invalid channel), try the next
+  METRIC_EMIT
+};
+
+struct MetricSample {
+  char labels[96];   // `key="value",...` without braces; empty for none
+  double value;
+};
+
+// ctx is the scrape context handed to the cursor (a snapshot taken per scrape)
+typedef MetricStep (*MetricSampler)(const void *ctx, int index, MetricSample &out);
+
+struct MetricFamily {
+  const char *name;    // must end in _<unit> when unit is set
+  MetricType type;
+  const char *unit;    // nullptr for none
+  const char *help;
+  MetricSampler sample;
+};
+
+class MetricsCursor {
+public:
+  MetricsCursor(const MetricFamily *families, size_t count, const void *ctx)
+    : _families(families), _count(count), _ctx(ctx) {}
+  // Fill buf with up to maxLen bytes; 0 once "# EOF" has been sent
+  size_t read(uint8_t *buf, size_t maxLen);
+
+private:
+  int nextLine();   // format the next line into _text; length, or 0 at the end
+
+  const MetricFamily *_families;
+  size_t _count;
+  const void *_ctx;
+  size_t _family = 0;
+  uint8_t _phase = 0;    // 0 TYPE, 1 UNIT, 2 HELP, 3 samples
+  int _index = 0;
+  bool _eofDone = false;
+  char _text[224];
+  size_t _textLen = 0, _textOff = 0;
+};
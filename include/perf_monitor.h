@@ -0,0 +1,67 @@
+#pragma once
+// Per-task CPU share and stack headroom, sampled on a fixed cadence.
+//
+// sample() walks every FreeRTOS task (uxTaskGetSystemState) and turns the
+// run-time counters into a share of one core over the interval since the
+// previous sample, so the numbers show current load rather than a lifetime
+// average. Core load is 100 % minus that core's idle task. When the core is
+// built without run-time stats only the stack high-water marks of tasks
+// registered with track() are reported. Short-lived tasks (OTA) call
+// taskExiting() just before deleting themselves, so their final high-water
+// mark is still reported after they are gone.
+//
+// sample() runs in one task (webTask); readers take a consistent copy with
+// read() from any task.
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "seqlock.h"
+
+#define PERF_MAX_TASKS          24
+#define PERF_EXITED_TASKS       4     // finished tasks remembered by name
+#define PERF_SAMPLE_INTERVAL_MS 2000
+
+struct PerfTask {
+  char name[16];
+  int8_t core;            // -1 = not pinned / unknown
+  uint8_t priority;
+  uint32_t stackFree;     // bytes never used (high-water mark)
+  float cpu;              // % of one core over the last interval, -1 if unavailable
+  bool exited;            // finished: stackFree is its final high-water mark
+};
+
+struct PerfSample {
+  uint32_t timeMs;
+  uint32_t intervalMs;
+  float coreLoad[2];      // -1 if unavailable
+  bool runtimeStats;
+  uint8_t taskCount;
+  PerfTask tasks[PERF_MAX_TASKS];
+};
+
+class PerfMonitor {
+public:
+  // Fallback list for builds without uxTaskGetSystemState()
+  void track(TaskHandle_t task);
+  // Called by a task right before vTaskDelete(NULL)
+  void taskExiting();
+  void sample();
+  uint32_t read(PerfSample &out) const { return _state.read(out); }
+
+private:
+  TaskHandle_t _tracked[8] = {};
+  uint8_t _trackedCount = 0;
+  PerfTask _exited[PERF_EXITED_TASKS] = {};
+  uint8_t _exitedCount = 0;
+  portMUX_TYPE _exitedMux = portMUX_INITIALIZER_UNLOCKED;
+  // Previous run-time counters keyed by task number
+  uint32_t _prevNumber[PERF_MAX_TASKS] = {};
+  uint32_t _prevRun[PERF_MAX_TASKS] = {};
+  uint8_t _prevCount = 0;
+  uint32_t _prevTotal = 0;
+  uint32_t _prevMs = 0;
+  PerfSample _work = {};
+  SeqLock<PerfSample> _state;
+};
+
+extern PerfMonitor perfMonitor;
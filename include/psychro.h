@@ -0,0 +1,48 @@
+#pragma once
+// Psychrometrics for one (temperature, relative humidity) sample in a single
+// pass: saturation and actual vapour pressure are computed once and shared by
+// VPD and absolute humidity, and dew point reuses the same Magnus exponent
+// shape instead of going through separate helpers.
+//
+// Formulas (unchanged from the original per-value helpers, °C / %RH in):
+//   es  = 0.6108 * exp(17.27 T / (T + 237.3))        kPa (Tetens)
+//   ea  = es * RH / 100                              kPa
+//   vpd = es - ea                                    kPa
+//   ah  = ea * 2.16679 / (T + 273.15)
+//   td  = 237.7 g / (17.27 - g),  g = 17.27 T / (237.7 + T) + ln(RH / 100)
+//   hi  = T below 27 °C, else the simplified linear fit
+//
+// PSYCHRO_FAST swaps expf/logf for range-reduced polynomials. Over
+// T in [-20, 60] °C and RH in [1, 100] % it stays within 5e-6 relative error on
+// es/ea/vpd/ah and 1e-4 °C on dew point, far below SHT3x resolution. The host
+// test (test/test_psychro) checks both paths against the original formulas;
+// psychroBench() measures speed and error on target (serial command "bench").
+#include <stdint.h>
+#include <stddef.h>
+
+enum PsychroMode : uint8_t {
+  PSYCHRO_EXACT = 0,    // libm expf/logf
+  PSYCHRO_FAST,         // polynomial exp/log, bounded error (see above)
+};
+
+struct Psychro {
+  float es;               // saturation vapour pressure, kPa
+  float ea;               // actual vapour pressure, kPa
+  float dewPoint;         // °C
+  float vpd;              // kPa
+  float absoluteHumidity;
+  float heatIndex;        // °C
+};
+
+void psychroCompute(float tempC, float rh, Psychro &out, PsychroMode mode = PSYCHRO_EXACT);
+// Same kernel over arrays of samples (e.g. when re-deriving stored readings)
+void psychroBatch(const float *tempC, const float *rh, Psychro *out, size_t n, PsychroMode mode = PSYCHRO_EXACT);
+
+struct PsychroBenchResult {
+  uint32_t samples;
+  float exactNs, fastNs;      // per sample
+  float maxRelErr;            // worst of es/ea/vpd/ah, fast vs exact
+  float maxDewErr;            // °C
+};
+// Sweep the supported T/RH grid through both paths; a few ms of CPU
+PsychroBenchResult psychroBench();
@@ -0,0 +1,99 @@
+#pragma once
+// Allocation-free HTTP responses for the hot API endpoints.
+//
+// ArenaResponse objects come from a fixed pool (class-level operator new/delete,
+// so the web server's own `delete response` returns them to the pool). The body
+// is either serialized straight into the slot's inline buffer or referenced from
+// a shared snapshot buffer, and the status line/headers are formatted into a
+// fixed buffer and written to the TCP client directly, bypassing the String-based
+// head assembly of AsyncAbstractResponse.
+//
+// With REPTIMON_ALLOC_TRACE, malloc/calloc/realloc are wrapped at link time and
+// calls made from the AsyncTCP task are counted; AllocScope attributes them to
+// a route so /api/alloc can show which handlers still touch the heap.
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include <ArduinoJson.h>
+
+#ifndef ARENA_SLOTS
+#define ARENA_SLOTS          4      // concurrent pooled responses; more fall back to the heap
+#endif
+#ifndef ARENA_BODY_CAP
+#define ARENA_BODY_CAP       2048   // inline body bytes per slot
+#endif
+#define ARENA_HEAD_CAP       320
+#define ALLOC_TRACE_ROUTES   16
+
+class ArenaResponse : public AsyncWebServerResponse {
+public:
+  // Serialize doc into the inline body; nullptr if it does not fit
+  static ArenaResponse *json(int code, const JsonDocument &doc);
+  // Reference an immutable shared buffer (no copy)
+  static ArenaResponse *shared(int code, const char *contentType, AsyncWebSocketSharedBuffer body);
+  // Reference an immutable raw buffer (e.g. in PSRAM); `body` keeps it alive until sent
+  static ArenaResponse *blob(int code, const char *contentType, std::shared_ptr<const uint8_t> body, size_t len);
+  // Inline literal body (e.g. {"status":"ok"})
+  static ArenaResponse *text(int code, const char *contentType, const char *body);
+  static ArenaResponse *empty(int code);
+
+  // Extra header written verbatim; values are copied into the fixed head buffer
+  bool header(const char *name, const char *value);
+  // Pre-formatted header lines ("Name: value\r\n" each), appended as-is
+  bool headers(const char *lines);
+
+  static void *operator new(size_t size);
+  static void operator delete(void *p);
+
+  void _respond(AsyncWebServerRequest *request) override;
+  size_t _ack(AsyncWebServerRequest *request, size_t len, uint32_t time) override;
+  bool _sourceValid() const override { return true; }
+
+  static uint32_t poolHits();
+  static uint32_t poolMisses();
+
+private:
+  ArenaResponse(int code, const char *contentType);
+  size_t bodyLength() const { return _shared ? _shared->size() : _bodyLen; }
+  const uint8_t *bodyData() const {
+    return _shared ? _shared->data() : _blob ? _blob.get() : (const uint8_t*)_body;
+  }
+  void pump(AsyncWebServerRequest *request);
+
+  const char *_type;
+  AsyncWebSocketSharedBuffer _shared;
+  std::shared_ptr<const uint8_t> _blob;   // length in _bodyLen
+  char _extra[128];
+  size_t _extraLen = 0;
+  char _head[ARENA_HEAD_CAP];
+  size_t _headLen = 0;
+  size_t _written = 0;
+  size_t _acked = 0;
+  size_t _bodyLen = 0;
+  char _body[ARENA_BODY_CAP];
+};
+
+// Send doc via the arena, falling back to a String response if it does not fit
+void sendJson(AsyncWebServerRequest *request, const JsonDocument &doc, int code = 200);
+
+// ---- Allocation tracing ----
+struct AllocRouteStats {
+  const char *path;
+  uint32_t requests;
+  uint32_t allocs;      // total over all requests
+  uint32_t last;        // allocations during the most recent request
+  uint32_t max;
+};
+
+AllocRouteStats *allocTraceRoute(const char *path);
+size_t allocTraceRoutes(AllocRouteStats *out, size_t cap);
+bool allocTraceEnabled();
+
+// Counts heap calls made by the current (AsyncTCP) task while in scope
+class AllocScope {
+public:
+  explicit AllocScope(AllocRouteStats *route);
+  ~AllocScope();
+private:
+  AllocRouteStats *_route;
+  uint32_t _start;
+};
@@ -0,0 +1,99 @@
+#pragma once
+// Sliding-window statistics (min/max/mean/stddev) for temperature, humidity and
+// dew point, plus since-boot totals.
+//
+// Samples are first folded into fixed-length blocks (10 s for the 1 h window,
+// 5 min for 24 h). Closed blocks enter a FIFO and, per channel, a monotonic
+// min deque and max deque; blocks leaving the window are popped from the front.
+// Each block is pushed and popped once, so ingest is O(1) amortized and a
+// summary is O(1). Window sums are kept relative to the first sample and
+// accumulated with Kahan compensation so add/evict cycles do not drift;
+// since-boot mean/variance use Welford's update.
+//
+// Not thread-safe: owned by sensorTask, which publishes summaries.
+#include <stdint.h>
+#include <stddef.h>
+
+#define STATS_WINDOWS 2
+
+enum StatChannel { STAT_TEMP = 0, STAT_HUM, STAT_DEW, STAT_CHANNELS };
+
+struct StatWindowConfig {
+  const char *name;     // JSON key, e.g. "1h"
+  uint32_t seconds;     // window length
+  uint32_t blockSec;    // block length; window / block blocks are retained
+};
+
+struct StatSummary {
+  uint32_t count;                 // samples in the window
+  float min[STAT_CHANNELS];
+  float max[STAT_CHANNELS];
+  float mean[STAT_CHANNELS];
+  float stddev[STAT_CHANNELS];
+};
+
+class RollingStats {
+public:
+  static constexpr StatWindowConfig kWindows[STATS_WINDOWS] = {
+    { "1h", 3600, 10 }, { "24h", 86400, 300 }
+  };
+
+  bool begin();
+  // t: seconds (uptime, monotonic: must not wrap); x: one value per StatChannel
+  void add(uint32_t t, const float x[STAT_CHANNELS]);
+
+  void window(int w, StatSummary &out) const;
+  void sinceBoot(StatSummary &out) const;
+  uint64_t totalSamples() const { return _n; }
+
+  size_t memoryBytes() const { return _bytes; }
+  bool inPsram() const { return _psram; }
+
+private:
+  struct KahanSum {
+    double sum = 0, c = 0;
+    void add(double x) {
+      double y = x - c;
+      double t = sum + y;
+      c = (t - sum) - y;
+      sum = t;
+    }
+  };
+  struct Block {
+    uint32_t idx;
+    uint32_t count;
+    double sum[STAT_CHANNELS];    // relative to _ref
+    double sumSq[STAT_CHANNELS];
+  };
+  struct MonoEntry { uint32_t idx; float v; };
+  // Fixed-capacity ring deque; keeps values monotonic (ascending for min, descending for max)
+  struct MonoDeque {
+    MonoEntry *buf = nullptr;
+    uint32_t cap = 0, head = 0, size = 0;
+    void push(uint32_t idx, float v, bool isMax);
+    void expire(uint32_t oldestIdx);
+    const MonoEntry &front() const { return buf[head]; }
+  };
+  struct Window {
+    Block *fifo = nullptr;
+    uint32_t cap = 0, head = 0, size = 0;
+    MonoDeque minQ[STAT_CHANNELS], maxQ[STAT_CHANNELS];
+    KahanSum sum[STAT_CHANNELS], sumSq[STAT_CHANNELS];
+    uint32_t count = 0;           // samples in closed blocks
+    Block cur;
+    float curMin[STAT_CHANNELS], curMax[STAT_CHANNELS];
+    bool open = false;
+  };
+
+  void closeBlock(Window &w);
+  void evict(Window &w, uint32_t oldestIdx);
+
+  Window _w[STATS_WINDOWS];
+  float _ref[STAT_CHANNELS] = { 0 };
+  // Since boot (Welford)
+  uint64_t _n = 0;
+  double _mean[STAT_CHANNELS] = { 0 }, _m2[STAT_CHANNELS] = { 0 };
+  float _min[STAT_CHANNELS] = { 0 }, _max[STAT_CHANNELS] = { 0 };
+  size_t _bytes = 0;
+  bool _psram = false;
+};
@@ -0,0 +1,77 @@
+#pragma once
+// Multi-resolution rollup pyramid for temperature/humidity.
+//
+// Each tier is a fixed ring of min/max/sum/count buckets at one resolution
+// (1 s, 1 min, 15 min, 1 h). A sample updates the current bucket of every tier,
+// so ingest is O(1) regardless of history length. Ring slots are addressed by
+// (t / resolution) % capacity and stamped with their bucket start, so stale or
+// skipped slots are recognised on read without any advance/cleanup pass.
+// Buckets live in PSRAM when available.
+#include <stdint.h>
+#include <stddef.h>
+#include <freertos/FreeRTOS.h>
+
+#define ROLLUP_TIERS 4
+
+struct RollupBucket {
+  uint32_t start;   // bucket start (seconds, engine timebase)
+  uint32_t count;
+  float tMin, tMax;
+  float hMin, hMax;
+  double tSum, hSum;
+};
+
+struct RollupTierConfig {
+  uint32_t resolution;  // seconds per bucket
+  uint32_t capacity;    // buckets kept
+};
+
+class RollupEngine {
+public:
+  // 1 s x 1 h, 1 min x 24 h, 15 min x 7 d, 1 h x 30 d  (~250 KB total)
+  static constexpr RollupTierConfig kTiers[ROLLUP_TIERS] = {
+    { 1, 3600 }, { 60, 1440 }, { 900, 672 }, { 3600, 720 }
+  };
+
+  bool begin();
+  // Called from sensorTask; t is seconds in the engine timebase: wrap-free
+  // uptime (SensorSnapshot::uptimeSec), not millis() / 1000, which jumps back
+  // to 0 after 49.7 days
+  void add(uint32_t t, float tempC, float humidity);
+
+  // Coarsest tier that still yields at least minPoints buckets over [from, to]
+  // and retains data back to `from`; falls back to the finest tier covering the range.
+  int selectTier(uint32_t from, uint32_t to, uint32_t now, uint32_t minPoints) const;
+  // Copy one bucket out under the lock; false when the slot is empty or stale
+  bool bucketAt(int tier, uint32_t bucketStart, RollupBucket &out) const;
+
+  size_t memoryBytes() const { return _bytes; }
+  bool inPsram() const { return _psram; }
+
+  // Streams {"tier":R,"from":..,"to":..,"units":"C","points":[[ts,tMin,tAvg,tMax,hMin,hAvg,hMax,n],...]}
+  // tsOffset is added to every emitted timestamp (e.g. uptime -> unix).
+  class Cursor {
+  public:
+    Cursor(const RollupEngine &engine, int tier, uint32_t from, uint32_t to, int64_t tsOffset, bool fahrenheit);
+    size_t read(uint8_t *buf, size_t maxLen);
+  private:
+    const RollupEngine &_engine;
+    int _tier;
+    uint32_t _res;
+    uint32_t _cur, _to;
+    uint32_t _from;
+    int64_t _tsOffset;
+    bool _fahrenheit;
+    bool _first = true, _headerDone = false, _footerDone = false;
+    char _text[160];
+    size_t _textLen = 0, _textOff = 0;
+  };
+
+private:
+  RollupBucket *_buckets[ROLLUP_TIERS] = { nullptr };
+  size_t _bytes = 0;
+  bool _psram = false;
+  mutable portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+};
+
+extern RollupEngine rollups;
@@ -0,0 +1,78 @@
+#pragma once
+// Per-route request metrics for the async web server.
+//
+// Routes registered through RouteMetrics::on() get their request, body and
+// upload handlers wrapped: the time spent inside them (the AsyncTCP task is
+// blocked for every client meanwhile), the time from the first body chunk or
+// the request handler until the connection closes, response bytes and status
+// class, and the number of requests in flight. Histograms are
+// log2-bucketed and the table is allocated once at begin(), so recording never
+// touches the heap.
+//
+// Everything runs on the AsyncTCP task (handlers, disconnect callbacks and the
+// /api/routes reader), so the table needs no locking.
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include "histogram.h"
+
+#define ROUTE_METRICS_MAX      64
+#define ROUTE_METRICS_INFLIGHT 16   // tracked open requests; more are counted but not timed to close
+
+struct RouteStats {
+  const char *path;         // registration string (static literal)
+  uint32_t method;          // WebRequestMethodComposite bits
+  uint32_t requests;
+  uint16_t inFlight;        // handled, connection not yet closed
+  uint16_t peakInFlight;
+  uint32_t status[5];       // 1xx..5xx
+  uint64_t bytesOut;        // headers + body handed to the TCP stack
+  Log2Histogram<24> handlerUs; // request handler plus every body/upload chunk
+  Log2Histogram<26> totalUs;   // first handler entry to disconnect (streams included)
+};
+
+class RouteMetrics {
+public:
+  // Allocate the table (PSRAM when available); routes registered before or
+  // without it are served unmeasured
+  bool begin();
+  // Drop-in for server.on() (or ApiRouter::on()); path must outlive the
+  // server (string literal)
+  template <class Target>
+  auto on(Target &target, const char *path, WebRequestMethodComposite method,
+          ArRequestHandlerFunction onRequest, ArUploadHandlerFunction onUpload = nullptr,
+          ArBodyHandlerFunction onBody = nullptr) -> decltype(target.on(path, method, onRequest, onUpload, onBody)) {
+    const int idx = add(path, method);
+    if (idx < 0) return target.on(path, method, onRequest, onUpload, onBody);
+    return target.on(path, method, wrap(idx, onRequest), wrapUpload(idx, onUpload), wrapBody(idx, onBody));
+  }
+
+  int count() const { return _count; }
+  const RouteStats &route(int i) const { return _routes[i]; }
+  size_t memoryBytes() const { return sizeof(RouteStats) * ROUTE_METRICS_MAX; }
+  bool inPsram() const { return _psram; }
+
+private:
+  struct Open {
+    AsyncWebServerRequest *request;   // nullptr = free
+    uint32_t startUs;
+    uint32_t bodyUs;                  // body/upload handler time before the request handler
+    uint8_t route;
+  };
+  // Table index for a new route; -1 once the table is full (served unmeasured)
+  int add(const char *path, WebRequestMethodComposite method);
+  // Measuring wrappers; a null handler stays null
+  ArRequestHandlerFunction wrap(uint8_t route, ArRequestHandlerFunction onRequest);
+  ArUploadHandlerFunction wrapUpload(uint8_t route, ArUploadHandlerFunction onUpload);
+  ArBodyHandlerFunction wrapBody(uint8_t route, ArBodyHandlerFunction onBody);
+  Open *find(AsyncWebServerRequest *request);
+  Open *opened(uint8_t route, AsyncWebServerRequest *request, uint32_t startUs);
+  void chunk(uint8_t route, AsyncWebServerRequest *request, uint32_t startUs);
+  void closed(AsyncWebServerRequest *request);
+
+  RouteStats *_routes = nullptr;
+  Open _open[ROUTE_METRICS_INFLIGHT] = {};
+  int _count = 0;
+  bool _psram = false;
+};
+
+extern RouteMetrics routeMetrics;
@@ -0,0 +1,84 @@
+#pragma once
+// Segment trie over '/'-separated paths, the matching core of ApiRouter.
+//
+// Each node is one path segment (pointing into the registered path, not
+// copied) with first-child/next-sibling links, and carries an int16 value
+// (ApiRouter: its first route). Empty segments are skipped, so "/api//x/" and
+// "/api/x" are the same path. Lookup walks the path once; cost depends on
+// path depth and siblings per level, not on the number of routes.
+//
+// Fixed capacity, no allocation, no hardware dependency (host-tested).
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+template <int MaxNodes>
+class RouteTrie {
+  static_assert(MaxNodes > 0 && MaxNodes <= 32767, "node indices are int16_t");
+public:
+  RouteTrie() { _nodes[0] = { nullptr, 0, -1, -1, -1 }; }
+
+  // Node for path, created as needed; -1 when the table is full or a segment
+  // is longer than 255 bytes. path must outlive the trie.
+  int16_t insert(const char *path) {
+    int16_t node = 0;
+    size_t len;
+    while (const char *seg = nextSegment(&path, &len)) {
+      int16_t c = child(node, seg, len);
+      if (c < 0) {
+        if (_count >= MaxNodes || len > 255) return -1;
+        c = (int16_t)_count++;
+        _nodes[c] = { seg, (uint8_t)len, -1, _nodes[node].child, -1 };
+        _nodes[node].child = c;
+      }
+      node = c;
+    }
+    return node;
+  }
+
+  // Node for path, or -1 if no registered path has exactly these segments
+  int16_t find(const char *path) const {
+    int16_t node = 0;
+    size_t len;
+    while (const char *seg = nextSegment(&path, &len)) {
+      node = child(node, seg, len);
+      if (node < 0) return -1;
+    }
+    return node;
+  }
+
+  int16_t value(int16_t node) const { return _nodes[node].value; }
+  void setValue(int16_t node, int16_t v) { _nodes[node].value = v; }
+  int nodeCount() const { return _count; }
+
+private:
+  struct Node {
+    const char *seg;
+    uint8_t segLen;
+    int16_t child;         // first child, -1 = none
+    int16_t sibling;       // -1 = none
+    int16_t value;         // -1 = none
+  };
+
+  // Next non-empty path segment starting at *p; advances *p past it
+  static const char *nextSegment(const char **p, size_t *len) {
+    const char *s = *p;
+    while (*s == '/') s++;
+    const char *e = s;
+    while (*e && *e != '/') e++;
+    *p = e;
+    *len = (size_t)(e - s);
+    return *len ? s : nullptr;
+  }
+
+  int16_t child(int16_t parent, const char *seg, size_t len) const {
+    for (int16_t c = _nodes[parent].child; c >= 0; c = _nodes[c].sibling) {
+      const Node &n = _nodes[c];
+      if (n.segLen == len && n.seg[0] == seg[0] && memcmp(n.seg, seg, len) == 0) return c;
+    }
+    return -1;
+  }
+
+  Node _nodes[MaxNodes];
+  int _count = 1;          // node 0 is the root
+};
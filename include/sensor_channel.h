@@ -0,0 +1,72 @@
+#pragma once
+// Sensor channels: one physical sensor each, polled together once per
+// sensorTask cycle through the SensorDriver interface.
+//
+// Drivers never wait for a conversion: a cycle costs one short transaction per
+// sensor that has data (see sensor_drivers.h for the SHT3x and DS18B20
+// drivers). Sensors that share a bus-wide operation, like a DS18B20 broadcast
+// conversion, register that bus once as a SensorBus.
+//
+// No hardware dependency, so the hub also runs in the native simulator with
+// replayed traces.
+#include <stdint.h>
+#include <stddef.h>
+#include "signal_filter.h"
+
+#define SENSOR_MAX_CHANNELS 6
+
+enum SensorPoll : uint8_t { SENSOR_OK = 0, SENSOR_NOT_READY, SENSOR_ERROR };
+
+struct SensorDriverCounters {
+  uint32_t ok, notReady, errors, restarts;
+};
+
+class SensorDriver {
+public:
+  virtual ~SensorDriver() {}
+  virtual const char *kind() const = 0;
+  virtual bool hasHumidity() const = 0;
+  // Worth one more fetch later in the same cycle when NOT_READY (sensor clock skew)
+  virtual bool retryable() const { return false; }
+  // Latest measurement if a new one is available; humidity untouched if unsupported
+  virtual SensorPoll collect(float &tempC, float &humidity) = 0;
+  virtual SensorDriverCounters counters() const = 0;
+  // Human-readable address, e.g. "0x45" or a 1-Wire ROM id
+  virtual void address(char *out, size_t len) const = 0;
+};
+
+// Bus-wide step run once per cycle before any channel on it is collected
+class SensorBus {
+public:
+  virtual ~SensorBus() {}
+  virtual void poll(uint32_t nowMs) = 0;
+};
+
+struct SensorChannel {
+  char id[12];            // stable key, e.g. "sht1", "ds1"
+  SensorDriver *driver;
+  SignalFilter tempFilter, humFilter;
+};
+
+class SensorHub {
+public:
+  // Register a channel; returns its index or -1 when full
+  int add(const char *id, SensorDriver *driver);
+  void setBus(SensorBus *bus) { _bus = bus; }
+  int count() const { return _count; }
+  SensorChannel &channel(int i) { return _channels[i]; }
+  const SensorChannel &channel(int i) const { return _channels[i]; }
+
+  void configureFilters(const FilterConfig &temp, const FilterConfig &hum);
+  // One batched cycle over all channels. Retryable channels that were not
+  // ready are fetched again once after retryMs. For each channel with a new
+  // conditioned sample, bit i of the result is set and temp[i]/hum[i] filled.
+  uint32_t poll(uint32_t nowMs, uint32_t retryMs, float *temp, float *hum);
+
+private:
+  SensorChannel _channels[SENSOR_MAX_CHANNELS];
+  int _count = 0;
+  SensorBus *_bus = nullptr;
+};
+
+extern SensorHub sensorHub;
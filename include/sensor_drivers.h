@@ -0,0 +1,66 @@
+#pragma once
+// SensorDriver implementations for the board: SHT3x in periodic mode on I2C
+// (0x44/0x45) and DS18B20 probes on one 1-Wire bus.
+//
+// SHT3x channels are fetched every cycle. DS18B20 probes share one bus: a
+// single broadcast Convert T starts every probe at once, and each probe's
+// scratchpad is read once the conversion time has elapsed.
+#include <Arduino.h>
+#include <Wire.h>
+#include <OneWire.h>
+#include "sensor_channel.h"
+#include "sht3x_periodic.h"
+
+class Sht3xDriver : public SensorDriver {
+public:
+  explicit Sht3xDriver(uint8_t addr) : _sht(addr), _addr(addr) {}
+  bool begin(TwoWire &wire, uint16_t mode) { return _sht.begin(wire, mode); }
+  const char *kind() const override { return "sht3x"; }
+  bool hasHumidity() const override { return true; }
+  bool retryable() const override { return true; }
+  SensorPoll collect(float &tempC, float &humidity) override;
+  SensorDriverCounters counters() const override;
+  void address(char *out, size_t len) const override { snprintf(out, len, "0x%02x", _addr); }
+  Sht3xPeriodic &device() { return _sht; }
+private:
+  Sht3xPeriodic _sht;
+  uint8_t _addr;
+};
+
+// One 1-Wire bus of DS18B20 probes sharing broadcast conversions
+class Ds18b20Bus : public SensorBus {
+public:
+  explicit Ds18b20Bus(uint8_t pin) : _wire(pin) {}
+  // Enumerate probes (family 0x28) and set their resolution; returns the number found
+  uint8_t begin(uint8_t resolutionBits = 11);
+  // Once per cycle: completes a conversion whose time has elapsed (new
+  // generation), otherwise starts one if idle
+  void poll(uint32_t nowMs) override;
+  uint8_t count() const { return _count; }
+  const uint8_t *rom(uint8_t i) const { return _roms[i]; }
+  uint32_t generation() const { return _generation; }
+  bool readScratchpad(const uint8_t *rom, float &tempC);
+private:
+  OneWire _wire;
+  uint8_t _roms[SENSOR_MAX_CHANNELS][8];
+  uint8_t _count = 0;
+  uint32_t _convMs = 375;
+  bool _converting = false;
+  uint32_t _convertStart = 0;
+  uint32_t _generation = 0;
+};
+
+class Ds18b20Probe : public SensorDriver {
+public:
+  Ds18b20Probe(Ds18b20Bus &bus, uint8_t index) : _bus(bus), _index(index) {}
+  const char *kind() const override { return "ds18b20"; }
+  bool hasHumidity() const override { return false; }
+  SensorPoll collect(float &tempC, float &humidity) override;
+  SensorDriverCounters counters() const override { return _counters; }
+  void address(char *out, size_t len) const override;
+private:
+  Ds18b20Bus &_bus;
+  uint8_t _index;
+  uint32_t _seenGeneration = 0;
+  SensorDriverCounters _counters = {};
+};
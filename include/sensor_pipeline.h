@@ -0,0 +1,67 @@
+#pragma once
+// Per-cycle processing of conditioned sensor samples: derived psychrometrics,
+// per-channel rolling statistics, and the snapshot that sensorTask publishes.
+//
+// Hardware-independent: the firmware and the native simulator run the same
+// code between SensorHub::poll() and the seqlock publish.
+// Not thread-safe: owned by the sensor task.
+#include <stdint.h>
+#include <stddef.h>
+#include "sensor_channel.h"
+#include "rolling_stats.h"
+#include "psychro.h"
+
+struct EnvironmentData {
+  float temperature;
+  float humidity;
+  float dewPoint;
+  float heatIndex;
+  float vaporPressureDeficit;
+  float absoluteHumidity;
+  unsigned long timestamp;
+  bool valid;
+};
+
+// Statistics summaries (since boot and per RollingStats window)
+struct Statistics {
+  StatSummary boot;
+  StatSummary windows[STATS_WINDOWS];
+  bool initialized;
+};
+
+struct ChannelState {
+  EnvironmentData data;
+  Statistics stats;
+  bool hasHumidity;
+};
+
+// Latest reading and statistics of every channel, published together once per
+// sensor cycle. Channel 0 is the primary: it feeds the top-level JSON fields,
+// history, rollups and the LED.
+struct SensorSnapshot {
+  ChannelState channels[SENSOR_MAX_CHANNELS];
+  uint8_t channelCount;
+  uint32_t uptimeSec;           // wrap-free uptime of the last process() (rollup timebase)
+};
+
+class SensorPipeline {
+public:
+  // Size the snapshot to the hub's channels and allocate their statistics;
+  // false if any channel's statistics could not be allocated
+  bool begin(const SensorHub &hub, PsychroMode mode);
+  // Fold in the channels flagged in `ready` (SensorHub::poll() output) taken
+  // at nowMs and return the updated snapshot
+  const SensorSnapshot &process(uint32_t ready, const float *temp, const float *hum, uint32_t nowMs);
+  const SensorSnapshot &snapshot() const { return _work; }
+
+  size_t statsBytes() const;
+  bool statsInPsram() const;
+
+private:
+  SensorSnapshot _work = {};
+  RollingStats _stats[SENSOR_MAX_CHANNELS];
+  PsychroMode _mode = PSYCHRO_EXACT;
+  uint64_t _uptimeMs = 0;       // wrap-free time base for the statistics windows
+  uint32_t _lastMs = 0;
+  bool _clockStarted = false;
+};
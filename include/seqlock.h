@@ -0,0 +1,53 @@
+#pragma once
+// Single-writer sequence lock for publishing a small POD across cores.
+//
+// The writer bumps the sequence to odd, copies the value in, then bumps it back
+// to even; it never blocks and never waits for readers. A reader copies the
+// value out and retries if the sequence was odd or changed meanwhile, so it
+// always returns a snapshot from exactly one publish. Intended for state written
+// at sensor rate and read at UI rate, where retries are rare and cheap.
+//
+// No FreeRTOS dependency, so it builds and can be exercised on the host.
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <type_traits>
+
+template <typename T>
+class SeqLock {
+  static_assert(std::is_trivially_copyable<T>::value, "SeqLock payload must be trivially copyable");
+public:
+  // Writer side: one task only. Returns the publish count (1, 2, 3, ...).
+  uint32_t publish(const T &value) {
+    uint32_t s = _seq.load(std::memory_order_relaxed);
+    _seq.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy((void*)&_value, &value, sizeof(T));
+    std::atomic_thread_fence(std::memory_order_release);
+    _seq.store(s + 2, std::memory_order_relaxed);
+    return (s + 2) / 2;
+  }
+
+  // Reader side: any task, any core. Returns the publish count of the copy
+  // (0 if nothing has been published yet; out is then zero-initialised).
+  uint32_t read(T &out) const {
+    for (;;) {
+      uint32_t s0 = _seq.load(std::memory_order_acquire);
+      if (s0 & 1) continue;
+      memcpy(&out, (const void*)&_value, sizeof(T));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      uint32_t s1 = _seq.load(std::memory_order_relaxed);
+      if (s0 == s1) return s0 / 2;
+      _retries.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  uint32_t sequence() const { return _seq.load(std::memory_order_acquire) / 2; }
+  // Reads that had to be repeated because a publish overlapped them
+  uint32_t retries() const { return _retries.load(std::memory_order_relaxed); }
+
+private:
+  std::atomic<uint32_t> _seq{0};
+  mutable std::atomic<uint32_t> _retries{0};
+  volatile T _value{};
+};
@@ -0,0 +1,50 @@
+#pragma once
+// SHT3x/SHT85 driver using periodic data acquisition.
+//
+// The sensor is put into periodic mode once and converts on its own clock;
+// each fetch is a short I2C transaction (command + 6 bytes) that never waits
+// for a conversion. If no new measurement is available yet the sensor NACKs
+// the read and fetch() returns SHT_NOT_READY, so the caller decides whether
+// to retry. Repeated bus/CRC errors restart periodic mode.
+#include <Arduino.h>
+#include <Wire.h>
+
+// Periodic mode commands (high repeatability)
+#define SHT3X_PERIODIC_1MPS_HIGH    0x2130
+#define SHT3X_PERIODIC_2MPS_HIGH    0x2236
+#define SHT3X_PERIODIC_4MPS_HIGH    0x2334
+#define SHT3X_PERIODIC_10MPS_HIGH   0x2737
+
+class Sht3xPeriodic {
+public:
+  enum Result : uint8_t { SHT_OK = 0, SHT_NOT_READY, SHT_CRC_ERROR, SHT_BUS_ERROR };
+  enum State : uint8_t { SHT_STOPPED = 0, SHT_RUNNING, SHT_RECOVERING };
+
+  explicit Sht3xPeriodic(uint8_t address = 0x44) : _addr(address) {}
+
+  bool begin(TwoWire &wire, uint16_t mode = SHT3X_PERIODIC_10MPS_HIGH);
+  Result fetch(float &tempC, float &humidity);
+  bool restart();
+  void stop();
+
+  State state() const { return _state; }
+  // Nominal sample period of the configured mode
+  uint32_t periodMs() const;
+
+  struct Counters {
+    uint32_t ok, notReady, crcErrors, busErrors, restarts;
+  };
+  Counters counters() const { return _counters; }
+
+private:
+  bool command(uint16_t cmd);
+  static uint8_t crc8(const uint8_t *data, size_t len);
+  void fault(Result r);
+
+  TwoWire *_wire = nullptr;
+  uint8_t _addr;
+  uint16_t _mode = SHT3X_PERIODIC_10MPS_HIGH;
+  State _state = SHT_STOPPED;
+  uint8_t _consecutiveErrors = 0;
+  Counters _counters = {};
+};
@@ -0,0 +1,73 @@
+#pragma once
+// Per-channel signal conditioning for sensor readings.
+//
+// Stages, in order (each can be disabled):
+//   1. Outlier rejection: rate-of-change limit against the last accepted value,
+//      and a MAD test against the recent raw window (|x - median| > k * 1.4826 * MAD)
+//   2. Median of the last N accepted samples
+//   3. Smoothing: EMA or a scalar Kalman filter (random-walk model)
+//   4. Decimation: mean of every D smoothed samples is emitted
+//
+// Everything lives in fixed-size arrays inside the object; no allocation.
+// Not thread-safe: owned by the sensor task.
+#include <stdint.h>
+
+#define FILTER_MAX_WINDOW   9     // largest median / MAD window
+#define FILTER_MAX_REJECTS  5     // consecutive rejections before re-seeding (real step change)
+
+enum FilterSmoothing : uint8_t {
+  FILTER_SMOOTH_NONE = 0,
+  FILTER_SMOOTH_EMA,
+  FILTER_SMOOTH_KALMAN,
+};
+
+struct FilterConfig {
+  uint8_t decimation = 1;       // emit one value per D inputs (1 = every input)
+  uint8_t median = 1;           // median window, odd, 1 = off
+  uint8_t smoothing = FILTER_SMOOTH_NONE;
+  float emaAlpha = 0.3f;        // weight of the new sample
+  float kalmanQ = 0.001f;       // process noise (units^2 per sample)
+  float kalmanR = 0.04f;        // measurement noise (units^2)
+  float maxRate = 0.0f;         // units per second, 0 = off
+  float madK = 0.0f;            // MAD multiplier, 0 = off
+};
+
+class SignalFilter {
+public:
+  void configure(const FilterConfig &cfg);
+  void reset();
+  // Feed one raw sample taken at tMs; returns true when `out` holds a new output.
+  // Rejected samples count towards decimation (as the previous value), so
+  // channels fed in lockstep emit in lockstep.
+  bool push(float x, uint32_t tMs, float &out);
+
+  uint32_t rejectedRate() const { return _rejectedRate; }
+  uint32_t rejectedMad() const { return _rejectedMad; }
+  const FilterConfig &config() const { return _cfg; }
+
+private:
+  bool isOutlier(float x, uint32_t tMs);
+  float condition(float x, uint32_t tMs);   // stages 2-3 on an accepted sample
+  static float medianOf(const float *v, uint8_t n);
+
+  FilterConfig _cfg;
+  // Raw accepted samples (MAD reference and median input)
+  float _win[FILTER_MAX_WINDOW];
+  uint8_t _winHead = 0, _winCount = 0;
+  // Last accepted raw value, for the rate test
+  float _last = 0;
+  uint32_t _lastMs = 0;
+  bool _haveLast = false;
+  uint8_t _rejectRun = 0;
+  // Smoother state
+  float _smooth = 0, _p = 1.0f;
+  bool _haveSmooth = false;
+  // Last conditioned value, repeated in place of rejected samples
+  float _held = 0;
+  bool _haveHeld = false;
+  // Decimation accumulator
+  float _decSum = 0;
+  uint8_t _decCount = 0;
+
+  uint32_t _rejectedRate = 0, _rejectedMad = 0;
+};
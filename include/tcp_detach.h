@@ -0,0 +1,18 @@
+#pragma once
+// Releasing memory that lwIP may still send from.
+//
+// client->add(data, len, 0) queues segments that point into the caller's
+// buffer instead of copying it. When AsyncTCP closes such a connection it
+// detaches from the pcb (callback arg cleared) and calls tcp_close(), which
+// keeps any unacknowledged data queued for retransmission; the response that
+// owned the buffer is deleted right after. Before it lets go of the buffer, a
+// response calls tcpDiscardDetached() with the pcb it sent on: if lwIP still
+// has that pcb open, detached, with segments queued, it is aborted so the
+// segments are freed. A pcb that is gone, or that a new connection has since
+// taken over, holds nothing of ours.
+//
+// Call from the AsyncTCP task (not the lwIP thread); blocks until the lwIP
+// thread has run the check, like AsyncTCP's own writes.
+struct tcp_pcb;
+
+void tcpDiscardDetached(struct tcp_pcb *pcb);
@@ -0,0 +1,43 @@
+#pragma once
+// Wake-ups for responses that are waiting on another task.
+//
+// AsyncTCP only calls a response back on network events: an ack, or the
+// connection poll lwIP runs every 500 ms. A response that has nothing to send
+// until the camera task publishes a frame registers its connection here, and
+// the camera task calls wake() after each publish. wake() queues one callback
+// on the lwIP thread, which invokes the poll callback of each registered
+// connection still open; AsyncTCP then delivers that poll to the response on
+// its own task, as it would for the timer-driven one. No waiting happens on
+// the AsyncTCP task and no AsyncTCP object is touched from another task.
+//
+// add()/remove() run on the AsyncTCP task; wake() on any task.
+#include <Arduino.h>
+#include <AsyncTCP.h>
+
+#define TCP_WAKE_SLOTS 16
+
+class TcpWakeList {
+public:
+  // Poll this connection at the next wake(); false when the list is full
+  // (the connection then only sees the regular 500 ms poll)
+  bool add(AsyncClient *client);
+  void remove(AsyncClient *client);
+  // Poll every registered connection now; repeated calls before the lwIP
+  // thread gets to it coalesce into one
+  void wake();
+
+private:
+  struct Entry {
+    AsyncClient *client;
+    struct tcp_pcb *pcb;
+  };
+  static void run(void *self);   // lwIP thread
+
+  Entry _entries[TCP_WAKE_SLOTS] = {};
+  int _used = 0;
+  volatile bool _queued = false;
+  portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+};
+
+// Stream viewers and deferred snapshots waiting for the next capture
+extern TcpWakeList cameraWaiters;
@@ -0,0 +1,115 @@
+#pragma once
+// Binary WebSocket telemetry (schema v2).
+//
+// Clients opt in by opening /ws with the subprotocol TELEMETRY_WS_PROTOCOL. They
+// still get one JSON document on connect (thresholds, system metadata, channel
+// ids), then receive TelemetryLiveFrame followed by `channelCount`
+// TelemetryChannelEntry records as binary messages at TELEMETRY_BIN_INTERVAL_MS.
+// Clients without the subprotocol keep the 1 Hz JSON stream.
+//
+// Layout is fixed, little-endian, no padding. Any change to field order or
+// size must bump TELEMETRY_SCHEMA_VERSION; the browser decoder checks it.
+// The subprotocol name carries the same version: firmware and the LittleFS UI
+// are updated separately, and a UI built for another schema then fails to
+// negotiate and falls back to JSON instead of discarding every frame.
+#include <stdint.h>
+#include <stddef.h>
+
+#define TELEMETRY_WS_PROTOCOL      "reptimon.bin.v2"
+#define TELEMETRY_MAGIC            0xA5
+#define TELEMETRY_SCHEMA_VERSION   2
+#define TELEMETRY_BIN_INTERVAL_MS  200    // 5 Hz for binary clients
+#define TELEMETRY_JSON_INTERVAL_MS 1000   // 1 Hz JSON fallback
+
+enum TelemetryFrameType : uint8_t {
+  TELEMETRY_FRAME_LIVE = 1,
+};
+
+enum TelemetryFlags : uint8_t {
+  TELEMETRY_FLAG_VALID    = 0x01,
+  TELEMETRY_FLAG_UNITS_F  = 0x02,
+  TELEMETRY_FLAG_STATS    = 0x04,
+  TELEMETRY_FLAG_STA      = 0x08,
+  TELEMETRY_FLAG_CAMERA   = 0x10,
+};
+
+// Matches the strings returned by getTemperatureStatus()/getHumidityStatus()
+enum TelemetryStatus : uint8_t {
+  TELEMETRY_STATUS_PERFECT  = 0,
+  TELEMETRY_STATUS_TOO_COLD = 1,
+  TELEMETRY_STATUS_TOO_HOT  = 2,
+  TELEMETRY_STATUS_TOO_DRY  = 3,
+  TELEMETRY_STATUS_TOO_WET  = 4,
+};
+
+struct __attribute__((packed)) TelemetryLiveFrame {
+  uint8_t  magic;          // TELEMETRY_MAGIC
+  uint8_t  version;        // TELEMETRY_SCHEMA_VERSION
+  uint8_t  type;           // TelemetryFrameType
+  uint8_t  flags;          // TelemetryFlags
+  uint32_t seq;            // sensor sample counter
+  uint32_t timestamp;      // ms since boot of the reading
+  uint32_t uptime;         // ms since boot when sent
+  // Readings (temperatures in display units)
+  float    temperature;
+  float    humidity;
+  float    dewPoint;
+  float    heatIndex;
+  float    vpd;
+  float    absoluteHumidity;
+  uint8_t  tempStatus;     // TelemetryStatus
+  uint8_t  humStatus;      // TelemetryStatus
+  int8_t   rssi;
+  uint8_t  channelCount;   // TelemetryChannelEntry records after this header
+  // Statistics (valid when TELEMETRY_FLAG_STATS is set; temperatures in °C as in JSON)
+  float    tempMin, tempMax, tempAvg;
+  float    humMin, humMax, humAvg;
+  float    dewMin, dewMax, dewAvg;
+  uint32_t readingCount;
+  // Volatile system fields
+  uint32_t freeHeap;
+  uint32_t freePsram;
+  float    sensorHz;
+};
+
+static_assert(sizeof(TelemetryLiveFrame) == 96, "TelemetryLiveFrame layout changed: bump TELEMETRY_SCHEMA_VERSION");
+
+enum TelemetryChannelFlags : uint8_t {
+  TELEMETRY_CH_VALID    = 0x01,
+  TELEMETRY_CH_HUMIDITY = 0x02,   // humidity/dewPoint/vpd are meaningful
+};
+
+// One sensor channel (index matches the JSON "channels" array)
+struct __attribute__((packed)) TelemetryChannelEntry {
+  uint8_t  index;
+  uint8_t  flags;          // TelemetryChannelFlags
+  uint8_t  tempStatus;     // TelemetryStatus
+  uint8_t  humStatus;      // TelemetryStatus
+  float    temperature;    // display units
+  float    humidity;
+  float    dewPoint;       // display units
+  float    vpd;
+};
+
+static_assert(sizeof(TelemetryChannelEntry) == 20, "TelemetryChannelEntry layout changed: bump TELEMETRY_SCHEMA_VERSION");
+
+// Device-side inputs to a live frame that are not part of the sensor snapshot.
+// The firmware fills them from WiFi/ESP/settings; the native simulator stubs them.
+struct SensorSnapshot;
+struct TelemetryContext {
+  uint32_t seq;            // snapshot publish count
+  uint32_t uptime;         // ms
+  bool fahrenheit;
+  bool sta;                // station mode connected
+  bool camera;
+  int8_t rssi;
+  uint32_t freeHeap, freePsram;
+  float sensorHz;
+  // Threshold classification as TelemetryStatus
+  uint8_t (*tempStatus)(float tempC);
+  uint8_t (*humStatus)(float rh);
+};
+
+// Header followed by one TelemetryChannelEntry per channel; returns the frame
+// length, or 0 if `cap` cannot hold the header
+size_t telemetryPackLive(const SensorSnapshot &snap, const TelemetryContext &ctx, uint8_t *buf, size_t cap);
@@ -0,0 +1,161 @@
+# PlatformIO pre-script: build the LittleFS image contents from data/
+#
+# Every asset except the HTML entry points is minified, gzipped and stored as
+# assets/<dir>/<name>.<hash>.<ext>.gz; the firmware serves the .gz with
+# Content-Encoding: gzip and an immutable Cache-Control. The entry points
+# (index.html, portal.html) keep their names, get their asset references
+# rewritten and the manifest inlined as window.ASSET_MANIFEST, and are the
+# only files browsers revalidate. The manifest is also written to
+# asset-manifest.json.
+#
+# index.html is additionally bundled so a cold load is three requests (document,
+# CSS, one script): partials and components are inlined as <template data-src>
+# elements that script.js instantiates on demand, and the scripts are joined
+# into assets/app.<hash>.js.
+#
+# JS is minified with esbuild when it is on PATH; otherwise JS is only gzipped.
+import gzip
+import hashlib
+import json
+import os
+import re
+import shutil
+import subprocess
+
+Import('env')
+
+ENTRY_POINTS = ('index.html', 'portal.html')
+HASH_LEN = 10
+BUNDLE_ENTRY = 'index.html'
+BUNDLE_TEMPLATE_DIRS = ('components/', 'partials/')
+BUNDLE_SCRIPTS = ('vendor/microplot.js', 'script.js')   # concatenated in this order
+
+src_dir = env.subst('$PROJECT_DATA_DIR')
+out_dir = os.path.join(env.subst('$PROJECT_BUILD_DIR'), env.subst('$PIOENV'), 'webui')
+esbuild = shutil.which('esbuild')
+
+
+def minify_css(text):
+    text = re.sub(r'/\*.*?\*/', '', text, flags=re.S)
+    text = re.sub(r'\s+', ' ', text)
+    # Not around ':' (descendant pseudo-classes) or '+'/'-' (calc())
+    text = re.sub(r'\s*([{};,>])\s*', r'\1', text)
+    return text.replace(';}', '}').strip() + '\n'
+
+
+def minify_html(text):
+    if re.search(r'<(pre|textarea)\b', text, flags=re.I):
+        # Leading whitespace is significant there; only drop comments
+        return re.sub(r'<!--(?!\[).*?-->', '', text, flags=re.S)
+    text = re.sub(r'<!--(?!\[).*?-->', '', text, flags=re.S)
+    lines = (line.strip() for line in text.splitlines())
+    return '\n'.join(line for line in lines if line) + '\n'
+
+
+def minify_js(text):
+    if not esbuild:
+        return text
+    try:
+        return subprocess.run([esbuild, '--minify', '--loader=js'], input=text.encode('utf-8'),
+                              stdout=subprocess.PIPE, stderr=subprocess.PIPE, check=True).stdout.decode('utf-8')
+    except Exception as e:
+        print('build_webui: esbuild failed (%s), keeping JS unminified' % e)
+        return text
+
+
+MINIFIERS = {'.css': minify_css, '.html': minify_html, '.js': minify_js}
+
+
+def minify(path, data):
+    fn = MINIFIERS.get(os.path.splitext(path)[1].lower())
+    return fn(data.decode('utf-8')).encode('utf-8') if fn else data
+
+
+def write_gz(path, data):
+    os.makedirs(os.path.dirname(path), exist_ok=True)
+    with open(path + '.gz', 'wb') as f:
+        # mtime=0 keeps the image byte-identical for identical sources
+        f.write(gzip.compress(data, compresslevel=9, mtime=0))
+
+
+def rewrite_refs(html, manifest):
+    def sub(m):
+        hashed = manifest.get(m.group(2))
+        return '%s="%s"' % (m.group(1), hashed) if hashed else m.group(0)
+    # Not data-src: template keys stay the logical paths script.js asks for
+    return re.sub(r'(?<![\w-])(src|href)="(/[^"?#]+)(?:\?[^"]*)?"', sub, html)
+
+
+def add_asset(rel, data, manifest):
+    stem, ext = os.path.splitext(rel)
+    digest = hashlib.sha256(data).hexdigest()[:HASH_LEN]
+    hashed = 'assets/%s.%s%s' % (stem, digest, ext)
+    write_gz(os.path.join(out_dir, hashed), data)
+    manifest['/' + rel] = '/' + hashed
+    return os.path.getsize(os.path.join(out_dir, hashed) + '.gz')
+
+
+def bundle(html, minified, manifest):
+    """Inline templates and swap the bundled script tags for one app script."""
+    scripts = [minified[rel].decode('utf-8') for rel in BUNDLE_SCRIPTS if rel in minified]
+    if scripts:
+        add_asset('app.js', ';\n'.join(scripts).encode('utf-8'), manifest)
+        bundled = set('/' + rel for rel in BUNDLE_SCRIPTS)
+        def sub(m):
+            if m.group(1) not in bundled:
+                return m.group(0)
+            # The app script goes where the last bundled script was
+            return '<script src="/app.js"></script>' if m.group(1) == '/' + BUNDLE_SCRIPTS[-1] else ''
+        html = re.sub(r'<script src="(/[^"?#]+)(?:\?[^"]*)?"></script>', sub, html)
+    templates = ''.join('<template data-src="/%s">%s</template>' % (rel, minified[rel].decode('utf-8'))
+                        for rel in sorted(minified) if rel.startswith(BUNDLE_TEMPLATE_DIRS))
+    return html.replace('</body>', templates + '</body>', 1)
+
+
+def build():
+    if os.path.isdir(out_dir):
+        shutil.rmtree(out_dir)
+    manifest = {}
+    minified = {}
+    raw = 0
+    packed = 0
+    for root, _, files in os.walk(src_dir):
+        for name in sorted(files):
+            rel = os.path.relpath(os.path.join(root, name), src_dir).replace(os.sep, '/')
+            if rel in ENTRY_POINTS:
+                continue
+            with open(os.path.join(root, name), 'rb') as f:
+                data = f.read()
+            if not data:
+                continue
+            data = minify(rel, data)
+            minified[rel] = data
+            raw += len(data)
+            packed += add_asset(rel, data, manifest)
+
+    entries = {}
+    for name in ENTRY_POINTS:
+        path = os.path.join(src_dir, name)
+        if os.path.isfile(path):
+            with open(path, encoding='utf-8') as f:
+                entries[name] = f.read()
+    if BUNDLE_ENTRY in entries:
+        entries[BUNDLE_ENTRY] = bundle(entries[BUNDLE_ENTRY], minified, manifest)
+
+    manifest_json = json.dumps(manifest, sort_keys=True, separators=(',', ':'))
+    with open(os.path.join(out_dir, 'asset-manifest.json'), 'w', encoding='utf-8') as f:
+        f.write(manifest_json + '\n')
+
+    for name, html in sorted(entries.items()):
+        html = rewrite_refs(html, manifest)
+        inline = '<script>window.ASSET_MANIFEST=%s</script>' % manifest_json
+        html = re.sub(r'(<script\b|</head>)', lambda m: inline + m.group(1), html, count=1)
+        data = minify_html(html).encode('utf-8')
+        write_gz(os.path.join(out_dir, name), data)
+
+    env.Replace(PROJECT_DATA_DIR=out_dir)
+    print('build_webui: %d assets, %d -> %d bytes gzipped%s' % (
+        len(manifest), raw, packed, '' if esbuild else ' (JS not minified: esbuild not found)'))
+
+
+build()
@@ -0,0 +1,46 @@
+#include "api_router.h"
+
+ApiRouter apiRouter;
+
+bool ApiRouter::on(const char *path, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest,
+                   ArUploadHandlerFunction onUpload, ArBodyHandlerFunction onBody) {
+  if (_routeCount >= API_ROUTER_MAX_ROUTES) return false;
+  int16_t node = _trie.insert(path);
+  if (node < 0) return false;
+  int16_t r = (int16_t)_routeCount++;
+  _routes[r] = { method, onRequest, onUpload, onBody, _trie.value(node) };
+  _trie.setValue(node, r);
+  return true;
+}
+
+const ApiRouter::Route *ApiRouter::match(AsyncWebServerRequest *request, bool *pathKnown) const {
+  int16_t node = _trie.find(request->url().c_str());
+  if (node < 0) return nullptr;
+  for (int16_t r = _trie.value(node); r >= 0; r = _routes[r].next) {
+    if (_routes[r].method & request->method()) return &_routes[r];
+  }
+  if (pathKnown) *pathKnown = _trie.value(node) >= 0;
+  return nullptr;
+}
+
+void ApiRouter::dispatch(AsyncWebServerRequest *request) {
+  bool pathKnown = false;
+  const Route *r = match(request, &pathKnown);
+  if (r && r->onRequest) { r->onRequest(request); return; }
+  if (r) return;   // body/upload-only route: the handler responds itself
+  if (pathKnown) request->send(405, "application/json", "{\"error\":\"method_not_allowed\"}");
+  else request->send(404, "application/json", "{\"error\":\"not_found\"}");
+}
+
+void ApiRouter::mount(AsyncWebServer &server, const char *prefix) {
+  server.on(prefix, HTTP_ANY,
+    [this](AsyncWebServerRequest *request) { dispatch(request); },
+    [this](AsyncWebServerRequest *request, const String &filename, size_t index, uint8_t *data, size_t len, bool final) {
+      const Route *r = match(request);
+      if (r && r->onUpload) r->onUpload(request, filename, index, data, len, final);
+    },
+    [this](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+      const Route *r = match(request);
+      if (r && r->onBody) r->onBody(request, data, len, index, total);
+    });
+}
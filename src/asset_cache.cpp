@@ -0,0 +1,136 @@
+#include "asset_cache.h"
+#include "request_arena.h"
+#if defined(ARDUINO) && defined(BOARD_HAS_PSRAM)
+#include <esp_heap_caps.h>
+#endif
+
+AssetCache assetCache;
+
+static const char *contentTypeFor(const char *path) {
+  static const struct { const char *ext, *type; } kTypes[] = {
+    { ".html", "text/html" }, { ".js", "application/javascript" }, { ".css", "text/css" },
+    { ".json", "application/json" }, { ".svg", "image/svg+xml" }, { ".png", "image/png" },
+    { ".ico", "image/x-icon" }, { ".jpg", "image/jpeg" }, { ".txt", "text/plain" },
+  };
+  const char *dot = strrchr(path, '.');
+  if (dot) {
+    for (const auto &t : kTypes) if (strcmp(dot, t.ext) == 0) return t.type;
+  }
+  return "application/octet-stream";
+}
+
+// FNV-1a over the stored bytes; the same file always gets the same ETag
+static uint32_t fnv1a(const uint8_t *p, size_t n) {
+  uint32_t h = 2166136261u;
+  while (n--) { h ^= *p++; h *= 16777619u; }
+  return h;
+}
+
+void AssetCache::begin(fs::FS &fs, size_t budget) {
+  _fs = &fs;
+  _budget = budget;
+}
+
+AssetCacheStats AssetCache::stats() const {
+  AssetCacheStats s = {};
+  for (const Entry &e : _entries) if (e.path[0]) s.entries++;
+  s.bytes = _bytes;
+  s.hits = _hits;
+  s.misses = _misses;
+  s.evictions = _evictions;
+  s.notModified = _notModified;
+  return s;
+}
+
+void AssetCache::clear() {
+  for (Entry &e : _entries) {
+    e.path[0] = '\0';
+    e.data.reset();
+  }
+  _bytes = 0;
+}
+
+AssetCache::Entry *AssetCache::find(const char *path) {
+  for (Entry &e : _entries) {
+    if (e.path[0] && strcmp(e.path, path) == 0) return &e;
+  }
+  return nullptr;
+}
+
+void AssetCache::evictFor(uint32_t len) {
+  for (;;) {
+    Entry *lru = nullptr;
+    bool slot = false;
+    for (Entry &e : _entries) {
+      if (!e.path[0]) { slot = true; continue; }
+      if (!lru || e.lastUsed < lru->lastUsed) lru = &e;
+    }
+    if ((slot && _bytes + len <= _budget) || !lru) return;
+    _bytes -= lru->len;
+    lru->path[0] = '\0';
+    lru->data.reset();
+    _evictions++;
+  }
+}
+
+AssetCache::Entry *AssetCache::load(const char *path) {
+#if defined(ARDUINO) && defined(BOARD_HAS_PSRAM)
+  if (!_fs || strlen(path) >= ASSET_CACHE_MAX_PATH) return nullptr;
+  char fsPath[ASSET_CACHE_MAX_PATH + 3];
+  snprintf(fsPath, sizeof(fsPath), "%s.gz", path);
+  bool gz = _fs->exists(fsPath);
+  if (!gz && !_fs->exists(path)) return nullptr;
+  File f = _fs->open(gz ? fsPath : path, "r");
+  if (!f || f.isDirectory()) return nullptr;
+  size_t len = f.size();
+  if (!len || len > _budget) return nullptr;
+  uint8_t *buf = (uint8_t*)heap_caps_malloc(len, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (!buf) return nullptr;
+  if (f.read(buf, len) != len) { heap_caps_free(buf); return nullptr; }
+  f.close();
+
+  evictFor(len);
+  Entry *e = nullptr;
+  for (Entry &c : _entries) if (!c.path[0]) { e = &c; break; }
+  if (!e) { heap_caps_free(buf); return nullptr; }
+  strlcpy(e->path, path, sizeof(e->path));
+  e->data = std::shared_ptr<const uint8_t>(buf, [](const uint8_t *p) { heap_caps_free((void*)p); });
+  e->len = len;
+  e->type = contentTypeFor(path);
+  snprintf(e->etag, sizeof(e->etag), "\"%08lx\"", (unsigned long)fnv1a(buf, len));
+  // Content-hashed names never change; everything else revalidates against the ETag
+  bool immutable = strncmp(path, "/assets/", 8) == 0;
+  snprintf(e->headers, sizeof(e->headers), "ETag: %s\r\nCache-Control: %s\r\n%s", e->etag,
+           immutable ? "public, max-age=31536000, immutable" : "no-cache",
+           gz ? "Content-Encoding: gzip\r\n" : "");
+  _bytes += len;
+  _misses++;
+  return e;
+#else
+  (void)path;
+  return nullptr;
+#endif
+}
+
+bool AssetCache::send(AsyncWebServerRequest *request, const char *path) {
+  if (_seen != _generation) {
+    _seen = _generation;
+    clear();
+  }
+  Entry *e = find(path);
+  if (e) _hits++;
+  else if (!(e = load(path))) return false;
+  e->lastUsed = ++_clock;
+
+  const AsyncWebHeader *inm = request->getHeader("If-None-Match");
+  ArenaResponse *response;
+  if (inm && strcmp(inm->value().c_str(), e->etag) == 0) {
+    response = ArenaResponse::empty(304);
+    _notModified++;
+  } else {
+    response = ArenaResponse::blob(200, e->type, e->data, e->len);
+  }
+  response->headers(e->headers);
+  request->send(response);
+  return true;
+}
@@ -0,0 +1,81 @@
+#include "camera_thumbs.h"
+#include "img_converters.h"
+#if defined(ARDUINO) && defined(BOARD_HAS_PSRAM)
+#include <esp_heap_caps.h>
+#endif
+
+CameraThumbs cameraThumbs;
+
+int CameraThumbs::indexFor(int scale) {
+  switch (scale) {
+    case 2: return 0;
+    case 4: return 1;
+    case 8: return 2;
+    default: return -1;
+  }
+}
+
+bool CameraThumbs::begin() {
+  for (FrameRing &r : _rings) if (!r.begin()) return false;
+  return true;
+}
+
+bool CameraThumbs::update(const CameraFramePtr &frame) {
+  if (!frame) return false;
+  bool any = false;
+  for (int i = 0; i < THUMB_SCALES; i++) {
+    if (!_rings[i].wanted()) continue;
+    uint32_t now = millis();
+    if (_lastMs[i] && now - _lastMs[i] < THUMB_INTERVAL_MS) continue;
+    _lastMs[i] = now;
+    uint32_t t0 = micros();
+    bool ok = encode(*frame, i);
+    uint32_t us = micros() - t0;
+    portENTER_CRITICAL(&_mux);
+    any |= ok;
+    if (ok) {
+      _stats[i].encoded++;
+      _stats[i].encodeUs.add(us);
+    } else {
+      _stats[i].failed++;
+    }
+    portEXIT_CRITICAL(&_mux);
+  }
+  return any;
+}
+
+bool CameraThumbs::encode(const CameraFrame &src, int index) {
+  const int shift = index + 1;
+  const uint16_t w = src.width >> shift;
+  const uint16_t h = src.height >> shift;
+  if (!w || !h) return false;
+  // One spare row and column: the decoder rounds partial MCUs up
+  size_t need = (size_t)(w + 1) * (h + 1) * 2;
+  if (need > _rgbCap) {
+    uint8_t *buf = nullptr;
+#if defined(ARDUINO) && defined(BOARD_HAS_PSRAM)
+    buf = (uint8_t*)heap_caps_malloc(need, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+#endif
+    if (!buf) buf = (uint8_t*)malloc(need);
+    if (!buf) return false;
+    free(_rgb);
+    _rgb = buf;
+    _rgbCap = need;
+  }
+  // JPG_SCALE_2X/4X/8X follow JPG_SCALE_NONE in order
+  if (!jpg2rgb565(src.buf, src.len, _rgb, (jpg_scale_t)(JPG_SCALE_NONE + shift))) return false;
+  uint8_t *jpg = nullptr;
+  size_t len = 0;
+  if (!fmt2jpg(_rgb, (size_t)w * h * 2, w, h, PIXFORMAT_RGB565, THUMB_JPEG_QUALITY, &jpg, &len)) return false;
+  bool ok = _rings[index].publish(jpg, len, w, h);
+  free(jpg);
+  return ok;
+}
+
+ThumbStats CameraThumbs::stats(int index) const {
+  ThumbStats s;
+  portENTER_CRITICAL(&_mux);
+  s = _stats[index];
+  portEXIT_CRITICAL(&_mux);
+  return s;
+}
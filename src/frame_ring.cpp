@@ -0,0 +1,95 @@
+#include "frame_ring.h"
+#if defined(ARDUINO) && defined(BOARD_HAS_PSRAM)
+#include <esp_heap_caps.h>
+#endif
+
+FrameRing frameRing;
+
+#define FRAME_RING_GRANULE 16384  // buffer growth step, so small size changes do not reallocate
+
+bool FrameRing::begin() {
+  for (auto &s : _slots) {
+    if (s) continue;
+    s = std::make_shared<CameraFrame>();
+    if (!s) return false;
+    *s = {};
+  }
+  return true;
+}
+
+bool FrameRing::reserve(CameraFrame &f, size_t len) {
+  if (f.capacity >= len) return true;
+  size_t cap = (len + FRAME_RING_GRANULE - 1) / FRAME_RING_GRANULE * FRAME_RING_GRANULE;
+  uint8_t *buf = nullptr;
+#if defined(ARDUINO) && defined(BOARD_HAS_PSRAM)
+  buf = (uint8_t*)heap_caps_malloc(cap, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (buf) _psram = true;
+#endif
+  if (!buf) buf = (uint8_t*)malloc(cap);
+  if (!buf) return false;
+  free(f.buf);
+  f.buf = buf;
+  f.capacity = cap;
+  return true;
+}
+
+bool FrameRing::publish(const uint8_t *data, size_t len, uint16_t width, uint16_t height) {
+  // Only the ring's own reference left and not the latest: no reader can reach it
+  int slot = -1;
+  portENTER_CRITICAL(&_mux);
+  for (int i = 1; i <= FRAME_RING_SLOTS; i++) {
+    int s = (_latest + i + FRAME_RING_SLOTS) % FRAME_RING_SLOTS;
+    if (s != _latest && _slots[s] && _slots[s].use_count() == 1) { slot = s; break; }
+  }
+  portEXIT_CRITICAL(&_mux);
+
+  CameraFrame *f = slot >= 0 ? _slots[slot].get() : nullptr;
+  if (!f || !reserve(*f, len)) {
+    _dropped++;
+    return false;
+  }
+  memcpy(f->buf, data, len);
+  f->len = len;
+  f->width = width;
+  f->height = height;
+  f->capturedMs = millis();
+  f->seq = _published + 1;
+
+  portENTER_CRITICAL(&_mux);
+  _latest = slot;
+  _published++;
+  portEXIT_CRITICAL(&_mux);
+  return true;
+}
+
+void FrameRing::waitForDemand(TickType_t timeout) {
+  _writer = xTaskGetCurrentTaskHandle();
+  ulTaskNotifyTake(pdTRUE, timeout);
+}
+
+void FrameRing::demand() {
+  _demandMs = millis();
+  _demanded = true;
+  // Stale notifications only cost the writer one extra wanted() check
+  if (_writer) xTaskNotifyGive(_writer);
+}
+
+CameraFramePtr FrameRing::latest() const {
+  CameraFramePtr f;
+  portENTER_CRITICAL(&_mux);
+  if (_latest >= 0) f = _slots[_latest];
+  portEXIT_CRITICAL(&_mux);
+  return f;
+}
+
+FrameRingStats FrameRing::stats() const {
+  FrameRingStats s = {};
+  portENTER_CRITICAL(&_mux);
+  s.published = _published;
+  s.dropped = _dropped;
+  for (const auto &slot : _slots) if (slot) s.slotBytes += slot->capacity;
+  portEXIT_CRITICAL(&_mux);
+  s.psram = _psram;
+  s.capturing = wanted();
+  return s;
+}
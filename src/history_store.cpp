@@ -0,0 +1,294 @@
+#include "history_store.h"
+#include <math.h>
+
+HistoryStore historyStore;
+
+// Anything before 2020-09-13 means SNTP has not synced yet; such samples are not stored.
+static const uint32_t kMinValidUnix = 1600000000UL;
+
+uint8_t HistoryStore::crc8(const uint8_t *data, size_t len) {
+  // CRC-8/ATM (poly 0x07), bitwise: records are tiny and this runs on flush/read only
+  uint8_t crc = 0;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    for (int b = 0; b < 8; b++) crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+  }
+  return crc;
+}
+
+String HistoryStore::segmentPath(uint32_t segStart) {
+  char path[32];
+  snprintf(path, sizeof(path), HISTORY_DIR "/%08lx.seg", (unsigned long)segStart);
+  return String(path);
+}
+
+bool HistoryStore::begin(fs::FS &fs) {
+  if (!_flushMutex) _flushMutex = xSemaphoreCreateMutex();
+  if (!_flushMutex) return false;
+  _fs = &fs;
+  if (!_fs->exists(HISTORY_DIR)) _fs->mkdir(HISTORY_DIR);
+  _lastFlushMs = millis();
+  enforceRetention();
+  uint32_t newest = newestStoredTs();
+  if (newest) _minSlot = newest + HISTORY_SAMPLE_INTERVAL_S;
+  return true;
+}
+
+// Timestamp of the last valid record on flash, 0 if there is none
+uint32_t HistoryStore::newestStoredTs() {
+  if (!_newest) return 0;
+  File f = _fs->open(segmentPath(_newest), "r");
+  if (!f) return 0;
+  uint32_t ts = 0;
+  // Walk back from the tail past a torn record or padding
+  for (size_t pos = f.size() - f.size() % sizeof(HistoryRecord); pos >= sizeof(HistoryRecord) && !ts;) {
+    pos -= sizeof(HistoryRecord);
+    HistoryRecord rec;
+    if (!f.seek(pos) || f.read((uint8_t*)&rec, sizeof(rec)) != sizeof(rec)) break;
+    if (rec.crc == crc8((const uint8_t*)&rec, sizeof(rec) - 1)) ts = rec.ts;
+  }
+  f.close();
+  return ts;
+}
+
+void HistoryStore::addSample(uint32_t unixTs, float tempC, float humidity) {
+  if (unixTs < kMinValidUnix || isnan(tempC) || isnan(humidity)) return;
+  uint32_t slot = unixTs - (unixTs % HISTORY_SAMPLE_INTERVAL_S);
+  // time() is not monotonic: SNTP can step it back. Segments are appended and
+  // read in order, so a sample older than the interval being averaged, the
+  // last queued record or the newest one on flash is dropped, not stored out
+  // of order; recording resumes once the clock passes that point again.
+  if (slot < _minSlot) {
+    _dropped++;
+    return;
+  }
+  if (_accN > 0 && slot != _accTs) {
+    HistoryRecord rec;
+    rec.ts = _accTs;
+    rec.tempC100 = (int16_t)lroundf((_accT / _accN) * 100.0f);
+    rec.humC100 = (uint16_t)lroundf(constrain(_accH / _accN, 0.0f, 100.0f) * 100.0f);
+    rec.flags = 0;
+    rec.crc = crc8((const uint8_t*)&rec, sizeof(rec) - 1);
+    pushRecord(rec);
+    _accN = 0; _accT = 0; _accH = 0;
+  }
+  if (_accN == 0) _accTs = _minSlot = slot;
+  _accT += tempC;
+  _accH += humidity;
+  _accN++;
+}
+
+void HistoryStore::pushRecord(const HistoryRecord &rec) {
+  portENTER_CRITICAL(&_mux);
+  size_t idx = (_pendHead + _pendCount) % HISTORY_PENDING_CAP;
+  if (_pendCount < HISTORY_PENDING_CAP) {
+    _pendCount++;
+  } else {
+    // Flash writer fell behind: drop the oldest record
+    _pendHead = (_pendHead + 1) % HISTORY_PENDING_CAP;
+  }
+  _pending[idx] = rec;
+  portEXIT_CRITICAL(&_mux);
+}
+
+size_t HistoryStore::pendingCount() const {
+  portENTER_CRITICAL(&_mux);
+  size_t n = _pendCount;
+  portEXIT_CRITICAL(&_mux);
+  return n;
+}
+
+size_t HistoryStore::snapshotPending(HistoryRecord *out, size_t cap) const {
+  portENTER_CRITICAL(&_mux);
+  size_t n = _pendCount < cap ? _pendCount : cap;
+  for (size_t i = 0; i < n; i++) out[i] = _pending[(_pendHead + i) % HISTORY_PENDING_CAP];
+  portEXIT_CRITICAL(&_mux);
+  return n;
+}
+
+bool HistoryStore::appendAligned(uint32_t segStart, const HistoryRecord *recs, size_t n) {
+  String path = segmentPath(segStart);
+  bool created = !_fs->exists(path);
+  File f = _fs->open(path, created ? "w" : "a");
+  if (!f) return false;
+  // A reset mid-write can leave a partial record at the tail. Pad it out so the
+  // next record starts on a record boundary; the padded one fails its CRC on read.
+  size_t rem = f.size() % sizeof(HistoryRecord);
+  if (rem) {
+    uint8_t pad[sizeof(HistoryRecord)];
+    memset(pad, 0xFF, sizeof(pad));
+    f.write(pad, sizeof(HistoryRecord) - rem);
+  }
+  size_t bytes = n * sizeof(HistoryRecord);
+  bool ok = f.write((const uint8_t*)recs, bytes) == bytes;
+  f.close();
+  if (created) enforceRetention();
+  return ok;
+}
+
+void HistoryStore::flush(bool force) {
+  if (!_fs) return;
+  // Overlapping flushes would append the same snapshot twice and then drop
+  // records queued in between, so the whole snapshot/write/drop runs under one lock
+  xSemaphoreTake(_flushMutex, portMAX_DELAY);
+  size_t count = pendingCount();
+  bool due = count > 0 && (force || count >= (HISTORY_PENDING_CAP * 3) / 4 ||
+             (millis() - _lastFlushMs) >= (uint32_t)HISTORY_FLUSH_INTERVAL_S * 1000UL);
+  if (!due) {
+    xSemaphoreGive(_flushMutex);
+    return;
+  }
+
+  HistoryRecord batch[HISTORY_PENDING_CAP];
+  size_t n = snapshotPending(batch, HISTORY_PENDING_CAP);
+  // One append per segment touched (normally exactly one)
+  size_t i = 0;
+  while (i < n) {
+    uint32_t seg = batch[i].ts - (batch[i].ts % HISTORY_SEGMENT_SPAN_S);
+    size_t j = i + 1;
+    while (j < n && batch[j].ts - (batch[j].ts % HISTORY_SEGMENT_SPAN_S) == seg) j++;
+    if (!appendAligned(seg, batch + i, j - i)) break;
+    _written += (uint32_t)(j - i);
+    i = j;
+  }
+  // Drop what made it to flash; anything pushed meanwhile stays queued
+  portENTER_CRITICAL(&_mux);
+  size_t drop = i < _pendCount ? i : _pendCount;
+  _pendHead = (_pendHead + drop) % HISTORY_PENDING_CAP;
+  _pendCount -= drop;
+  portEXIT_CRITICAL(&_mux);
+  _lastFlushMs = millis();
+  _flushes++;
+  xSemaphoreGive(_flushMutex);
+}
+
+void HistoryStore::enforceRetention() {
+  if (!_fs) return;
+  for (;;) {
+    File dir = _fs->open(HISTORY_DIR);
+    if (!dir || !dir.isDirectory()) return;
+    uint32_t oldest = 0xFFFFFFFFUL, newest = 0;
+    int count = 0;
+    File f = dir.openNextFile();
+    while (f) {
+      const char *name = f.name();
+      const char *base = strrchr(name, '/');
+      base = base ? base + 1 : name;
+      if (!f.isDirectory() && strstr(base, ".seg")) {
+        uint32_t start = strtoul(base, nullptr, 16);
+        if (start < oldest) oldest = start;
+        if (start > newest) newest = start;
+        count++;
+      }
+      f = dir.openNextFile();
+    }
+    dir.close();
+    _oldest = count ? oldest : 0;
+    _newest = newest;
+    if (count <= HISTORY_MAX_SEGMENTS) return;
+    _fs->remove(segmentPath(oldest));
+  }
+}
+
+// ---- Query cursor ----
+
+HistoryStore::Cursor::Cursor(HistoryStore &store, uint32_t from, uint32_t to, uint32_t step, bool fahrenheit)
+  : _store(store), _from(from), _to(to), _step(step), _fahrenheit(fahrenheit) {
+  if (_step < HISTORY_SAMPLE_INTERVAL_S) _step = HISTORY_SAMPLE_INTERVAL_S;
+  // Cap the response size: widen the step rather than stream an unbounded point list
+  if (_to > _from && (_to - _from) / _step > 5000) _step = (_to - _from) / 5000 + 1;
+  uint32_t first = _from;
+  if (_store._oldest > first) first = _store._oldest;
+  _segStart = first - (first % HISTORY_SEGMENT_SPAN_S);
+  // Records still in RAM are newer than anything on flash; take them now
+  _ramCount = _store.snapshotPending(_ram, HISTORY_PENDING_CAP);
+  if (!_store._fs) _segmentsDone = true;
+}
+
+HistoryStore::Cursor::~Cursor() {
+  if (_file) _file.close();
+}
+
+bool HistoryStore::Cursor::openNextSegment() {
+  while (_segStart <= _to) {
+    String path = segmentPath(_segStart);
+    if (_store._fs->exists(path)) {
+      _file = _store._fs->open(path, "r");
+      if (_file) return true;
+    }
+    if (_segStart > 0xFFFFFFFFUL - HISTORY_SEGMENT_SPAN_S) break;
+    _segStart += HISTORY_SEGMENT_SPAN_S;
+  }
+  return false;
+}
+
+bool HistoryStore::Cursor::nextRecord(HistoryRecord &rec) {
+  while (!_segmentsDone) {
+    if (!_file && !openNextSegment()) { _segmentsDone = true; break; }
+    if (_file.read((uint8_t*)&rec, sizeof(rec)) == sizeof(rec)) {
+      if (rec.crc != crc8((const uint8_t*)&rec, sizeof(rec) - 1)) continue;
+      if (rec.ts < _segStart || rec.ts >= _segStart + HISTORY_SEGMENT_SPAN_S) continue;
+      if (rec.ts > _lastTs) _lastTs = rec.ts;
+      return true;
+    }
+    _file.close();
+    if (_segStart > 0xFFFFFFFFUL - HISTORY_SEGMENT_SPAN_S) { _segmentsDone = true; break; }
+    _segStart += HISTORY_SEGMENT_SPAN_S;
+  }
+  // A flush may have moved RAM records to flash after we snapshotted them; skip duplicates
+  while (_pendingIdx < _ramCount) {
+    rec = _ram[_pendingIdx++];
+    if (rec.ts > _lastTs) return true;
+  }
+  return false;
+}
+
+void HistoryStore::Cursor::emitBucket() {
+  float t = _sumT / _bucketN;
+  float h = _sumH / _bucketN;
+  if (_fahrenheit) t = t * 9.0f / 5.0f + 32.0f;
+  int n = snprintf(_text, sizeof(_text), "%s[%lu,%.2f,%.2f]", _first ? "" : ",",
+                   (unsigned long)_bucket, t, h);
+  _textLen = (n > 0 && (size_t)n < sizeof(_text)) ? (size_t)n : 0;
+  _textOff = 0;
+  _first = false;
+  _bucketN = 0; _sumT = 0; _sumH = 0;
+}
+
+size_t HistoryStore::Cursor::read(uint8_t *buf, size_t maxLen) {
+  size_t len = 0;
+  while (len < maxLen) {
+    if (_textOff < _textLen) {
+      size_t toCopy = std::min(_textLen - _textOff, maxLen - len);
+      memcpy(buf + len, _text + _textOff, toCopy);
+      _textOff += toCopy;
+      len += toCopy;
+      continue;
+    }
+    _textLen = _textOff = 0;
+    if (!_headerDone) {
+      int n = snprintf(_text, sizeof(_text), "{\"from\":%lu,\"to\":%lu,\"step\":%lu,\"units\":\"%s\",\"points\":[",
+                       (unsigned long)_from, (unsigned long)_to, (unsigned long)_step, _fahrenheit ? "F" : "C");
+      _textLen = (n > 0 && (size_t)n < sizeof(_text)) ? (size_t)n : 0;
+      _headerDone = true;
+      continue;
+    }
+    if (_footerDone) break;
+    HistoryRecord rec;
+    if (nextRecord(rec)) {
+      if (rec.ts < _from || rec.ts > _to) continue;
+      uint32_t b = rec.ts - (rec.ts % _step);
+      if (_bucketN && b != _bucket) emitBucket();
+      if (!_bucketN) _bucket = b;
+      _sumT += rec.tempC100 * 0.01f;
+      _sumH += rec.humC100 * 0.01f;
+      _bucketN++;
+      continue;
+    }
+    if (_bucketN) { emitBucket(); continue; }
+    memcpy(_text, "]}", 2);
+    _textLen = 2;
+    _footerDone = true;
+  }
+  return len;
+}
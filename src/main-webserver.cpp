@@ -1,7 +1,6 @@
 #include <Arduino.h>
 #include <Wire.h>
 #include "version_auto.h"
-#include <SHT85.h>
 #include <WiFi.h>
 #include <ESPAsyncWebServer.h>
 #include <ArduinoJson.h>
@@ -13,12 +12,35 @@
 #include <WiFiClientSecure.h>
 #include <Update.h>
 #include <ctype.h>
+#include <time.h>
+#include <memory>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <freertos/queue.h>
 #include <freertos/semphr.h>
 // Camera support
 #include "esp_camera.h"
+#include "history_store.h"
+#include "rollup.h"
+#include "telemetry_frame.h"
+#include "request_arena.h"
+#include "seqlock.h"
+#include "sensor_channel.h"
+#include "sensor_drivers.h"
+#include "sensor_pipeline.h"
+#include "histogram.h"
+#include "signal_filter.h"
+#include "perf_monitor.h"
+#include "route_metrics.h"
+#include "metrics_writer.h"
+#include "asset_cache.h"
+#include "api_router.h"
+#include "frame_ring.h"
+#include "camera_thumbs.h"
+#include "tcp_wake.h"
+#include "tcp_detach.h"
 
 // WiFi Configuration - managed via Preferences and Web UI
 String selectedSSID = "";
@@ -34,8 +56,12 @@ bool captivePortalActive = false;  // whether DNS redirect is active
 DNSServer dnsServer;               // captive portal DNS server
 const byte DNS_PORT = 53;
 
-// Create SHT30 sensor object with default address 0x44
-SHT85 sht30(0x44);
+// Sensors: SHT30 at 0x44 (primary channel, required), an optional second SHT
+// at 0x45 and DS18B20 probes on ONEWIRE_PIN; all polled through sensorHub
+#define ONEWIRE_PIN 4   // D3
+Sht3xDriver sht30(0x44);
+Sht3xDriver sht30b(0x45);
+Ds18b20Bus probeBus(ONEWIRE_PIN);
 
 // Web server on port 80
 AsyncWebServer server(80);
@@ -46,7 +72,11 @@ AsyncWebSocket ws("/ws");
 #define LED_BUILTIN_BLUE  2   // Blue/Yellow LED
 
 // Performance optimization constants
-#define SENSOR_UPDATE_INTERVAL_MS     50    // Ultra-fast 20Hz updates (50ms)
+#define SENSOR_UPDATE_INTERVAL_MS     100   // 10Hz, the fastest SHT3x periodic mode
+#define SENSOR_RETRY_MS               10    // re-fetch once if the sensor's clock lags ours
+#ifndef SENSOR_PSYCHRO_MODE
+#define SENSOR_PSYCHRO_MODE           PSYCHRO_EXACT // libm; PSYCHRO_FAST only once `bench` shows a gain on the board
+#endif
 #define DISPLAY_UPDATE_INTERVAL_MS    100   // 10Hz display updates (100ms)
 #define SERIAL_BAUD_RATE             921600 // Maximum reliable baud rate
 #define I2C_CLOCK_SPEED              400000 // Fast I2C (400kHz)
@@ -56,8 +86,8 @@ TaskHandle_t sensorTaskHandle = NULL;
 TaskHandle_t displayTaskHandle = NULL;
 TaskHandle_t ledTaskHandle = NULL;
 TaskHandle_t webTaskHandle = NULL;
+TaskHandle_t cameraTaskHandle = NULL;
 QueueHandle_t sensorDataQueue = NULL;
-SemaphoreHandle_t dataMutex = NULL;
 
 // Application settings persisted in NVS
 struct AppSettings {
@@ -75,34 +105,24 @@ struct AppSettings {
   float comfortIdeal = 85.0f;
   int camFrameSize = 6;  // FRAMESIZE_QVGA by default
   int camQuality = 12;   // JPEG quality (lower is higher quality)
+  // Signal conditioning applied to temperature and humidity (include/signal_filter.h)
+  int filtDecimation = 1;             // publish one value per N sensor samples
+  int filtMedian = 3;                 // median window (odd), 1 = off
+  int filtSmoothing = FILTER_SMOOTH_NONE;  // 0 none, 1 EMA, 2 Kalman
+  float filtAlpha = 0.3f;             // EMA weight of the new sample
+  float filtRateTemp = 2.0f;          // max plausible change, °C per second (0 = off)
+  float filtRateHum = 10.0f;          // max plausible change, %RH per second (0 = off)
+  float filtMadK = 0.0f;              // MAD outlier multiplier (0 = off)
 };
 AppSettings appSettings;
 String mdnsHostname = "momo";
 bool mdnsActive = false;
 
-// Reptile enclosure monitoring variables
-struct EnvironmentData {
-  float temperature;
-  float humidity;
-  float dewPoint;
-  float heatIndex;
-  float vaporPressureDeficit;
-  float absoluteHumidity;
-  unsigned long timestamp;
-  bool valid;
-};
-
-// Statistics tracking with lock-free updates
-struct Statistics {
-  volatile float tempMin, tempMax, tempAvg;
-  volatile float humMin, humMax, humAvg;
-  volatile float dewMin, dewMax, dewAvg;
-  volatile int readingCount;
-  volatile bool initialized;
-} stats = {0};
-
-// Current data with atomic access
-volatile EnvironmentData currentData = {0};
+// Latest reading and statistics of every channel (sensor_pipeline.h). Readers
+// on either core take a consistent copy with sensorState.read(); the sensor
+// task never blocks on them. Channel 0 is the SHT30 at 0x44.
+SeqLock<SensorSnapshot> sensorState;
+SensorPipeline sensorPipeline;                        // owned by sensorTask
 EnvironmentData readings[32]; // Larger buffer for high-frequency data
 volatile int readingIndex = 0;
 
@@ -122,12 +142,28 @@ struct ReptileThresholds {
 
 // Performance monitoring
 unsigned long lastSensorRead = 0;
+
+// Sensor cadence diagnostics; written by sensorTask, copied out under sensorTimingMux
+struct SensorTiming {
+  LinearHistogram<17> periodUs;   // 1 ms bins, nominal period in the middle bin
+  Log2Histogram<20> jitterUs;     // |period - nominal|
+  Log2Histogram<16> fetchUs;      // time to poll every channel (including a retry)
+  uint32_t overruns;              // cycles that started more than one period late
+};
+static SensorTiming sensorTiming;
+static portMUX_TYPE sensorTimingMux = portMUX_INITIALIZER_UNLOCKED;
+// sensorDataQueue pressure (sensorTask -> displayTask)
+#define SENSOR_QUEUE_LENGTH 16
+volatile uint32_t sensorQueuePeak = 0;
+volatile uint32_t sensorQueueDrops = 0;
+
+// sensorTask reconfigures the channel filter chains when this changes
+volatile uint32_t filterConfigVersion = 0;
 unsigned long lastDisplayUpdate = 0;
 unsigned long sensorReadCount = 0;
 unsigned long displayUpdateCount = 0;
 
 // Web server variables
-String lastJsonData = "";
 unsigned long lastWebUpdate = 0;
 
 // Firmware version and OTA state
@@ -225,14 +261,45 @@ static void otaLogf(const char *fmt, ...) {
   otaLog(String(buf));
 }
 
+// End of an OTA task: leave its stack high-water mark in /api/perf first
+static void otaTaskEnd() {
+  perfMonitor.taskExiting();
+  vTaskDelete(NULL);
+}
+
 // Camera state
 bool cameraAvailable = false;
 // Camera stream statistics (global across clients)
 volatile unsigned long camStatFrames = 0;
 volatile unsigned long camStatBytes = 0;
+volatile unsigned long camStatSkipped = 0;   // ring frames a stream client jumped over
+volatile uint32_t camCongestedMs = 0;        // last time a stream viewer could not keep up
 unsigned long camStatStartMs = 0;
 // Protect camera operations (stream vs reconfigure)
 SemaphoreHandle_t cameraMutex = NULL;
+// cameraMutex wait times for /api/perf; copied out under cameraLockStatsMux
+struct CameraLockStats {
+  Log2Histogram<24> waitUs;
+  uint32_t contended;     // takes that found the mutex held
+};
+static CameraLockStats cameraLockStats;
+static portMUX_TYPE cameraLockStatsMux = portMUX_INITIALIZER_UNLOCKED;
+
+static void cameraLock() {
+  if (!cameraMutex) return;
+  uint32_t t0 = micros();
+  bool contended = (xSemaphoreTake(cameraMutex, 0) != pdTRUE);
+  if (contended) xSemaphoreTake(cameraMutex, portMAX_DELAY);
+  uint32_t waited = micros() - t0;
+  portENTER_CRITICAL(&cameraLockStatsMux);
+  cameraLockStats.waitUs.add(waited);
+  if (contended) cameraLockStats.contended++;
+  portEXIT_CRITICAL(&cameraLockStatsMux);
+}
+
+static void cameraUnlock() {
+  if (cameraMutex) xSemaphoreGive(cameraMutex);
+}
 
 // Forward declarations for camera/settings
 bool initCamera();
@@ -245,14 +312,14 @@ unsigned long wifiConnectStart = 0;
 String pendingSSID = "";
 String pendingPass = "";
 
+// Wall-clock time (needed for persistent history); synced via SNTP once STA is up
+static void startTimeSync() {
+  configTime(0, 0, "pool.ntp.org", "time.nist.gov");
+}
+
 // Forward declarations
-inline float calculateDewPoint(float temp, float humidity);
-inline float calculateHeatIndex(float temp, float humidity);
-inline float calculateVPD(float temp, float humidity);
-inline float calculateAbsoluteHumidity(float temp, float humidity);
 String getTemperatureStatus(float temp);
 String getHumidityStatus(float humidity);
-void updateStatisticsAtomic(float temp, float humidity, float dewPoint);
 void updateLEDStatusFast(float temp, float humidity);
 void printUltraFastReading(EnvironmentData &data);
 void sensorTask(void *parameter);
@@ -262,6 +329,10 @@ void webTask(void *parameter);
 void setupWiFi();
 void setupWebServer();
 String generateJsonData();
+void initStaticSystemInfo();
+bool refreshSystemInfo(bool force);
+void markSystemInfoDirty();
+String getSystemInfoJson();
 void onWsEvent(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventType type,
              void *arg, uint8_t *data, size_t len);
 
@@ -442,6 +513,7 @@ static bool applyFsOtaFromUrl(const String& url, String& outMsg) {
   if (!ok) { outMsg = String("FS Update failed: ") + (Update.getError()); setOtaError(outMsg); return false; }
   outMsg = "OK";
   otaLog("FS OTA: completed");
+  assetCache.invalidate();
   setOtaState("fs_done", 100);
   return true;
 }
@@ -565,129 +637,446 @@ bool initCamera() {
   return true;
 }
 
-// MJPEG streaming response for AsyncWebServer
-class AsyncJpegStreamResponse : public AsyncAbstractResponse {
+// Capture task: the only caller of esp_camera_fb_get() outside snapshot_full.
+// Frames go to frameRing; cameraMutex is held just for the grab, so
+// reconfiguration (ctrl/restart) still excludes it.
+#define CAMERA_CAPTURE_RETRY_MS    20
+
+// Snapshots and thumbnails are served from a ring. A frame younger than
+// ?maxAge= goes out at once. Otherwise the handler returns a deferred response
+// and never waits: it registers its connection in cameraWaiters and is
+// completed from the poll the camera task triggers after the next publish
+// (or when another request for the same ring arrives first), so a burst of
+// callers shares one capture and none is held to the 500 ms lwIP poll. After a
+// timed-out wait further requests fail fast for a while.
+#define CAMERA_SNAPSHOT_MAX_AGE_MS     200     // default ?maxAge=
+#define CAMERA_THUMB_MAX_AGE_MS        500     // default ?maxAge= for thumbnails
+#define CAMERA_SNAPSHOT_MAX_AGE_CAP_MS 60000
+#define CAMERA_SNAPSHOT_WAIT_MS        500
+#define CAMERA_SNAPSHOT_BACKOFF_MS     1000
+#define CAMERA_PENDING_FRAMES          8       // deferred responses resumed by newer requests
+struct SnapshotStats {
+  uint32_t cached;        // served an existing frame
+  uint32_t waited;        // deferred until a capture
+  uint32_t failed;
+  uint32_t failedMs;      // last timed-out wait, 0 = none pending
+  Log2Histogram<24> waitUs;
+};
+static SnapshotStats snapshotStats;                 // AsyncTCP task only
+static SnapshotStats thumbRequestStats[THUMB_SCALES];
+
+class AsyncRingFrameResponse;
+static AsyncRingFrameResponse *pendingFrames[CAMERA_PENDING_FRAMES];   // AsyncTCP task only
+
+// Response for a frame newer than afterSeq that is not in the ring yet. All
+// callbacks run on the AsyncTCP task; the JPEG is sent by reference and _frame
+// keeps its slot reserved until the response is deleted, and past that until
+// lwIP can no longer retransmit from it (tcp_detach.h).
+class AsyncRingFrameResponse : public AsyncWebServerResponse {
 public:
-  AsyncJpegStreamResponse() {
+  AsyncRingFrameResponse(const FrameRing &ring, uint32_t afterSeq, SnapshotStats &stats, const char *errorBody)
+      : _ring(ring), _afterSeq(afterSeq), _stats(stats), _error(errorBody) {
     _code = 200;
-    _contentType = String("multipart/x-mixed-replace; boundary=") + _boundary;
-    _sendContentLength = false;
-    _chunked = true;
-    _fb = nullptr;
-    _index = 0;
-    _state = State::HEADER;
-    _locked = false;
+    _startMs = millis();
+    _startUs = micros();
+    for (auto &p : pendingFrames) if (!p) { p = this; break; }
   }
-  ~AsyncJpegStreamResponse() override {
-    if (_fb) { esp_camera_fb_return(_fb); _fb = nullptr; }
-    if (_locked && cameraMutex) { xSemaphoreGive(cameraMutex); _locked = false; }
+  ~AsyncRingFrameResponse() override {
+    unregister();
+    if (_client) cameraWaiters.remove(_client);
+    if (_frame && _acked < _written) tcpDiscardDetached(_pcb);
   }
   bool _sourceValid() const override { return true; }
-  size_t _fillBuffer(uint8_t *buf, size_t maxLen) override {
-    size_t len = 0;
-    while (len < maxLen) {
-      if (_state == State::HEADER) {
-        if (_fb) { esp_camera_fb_return(_fb); _fb = nullptr; }
-        if (cameraMutex && !_locked) { xSemaphoreTake(cameraMutex, portMAX_DELAY); _locked = true; }
-        _fb = esp_camera_fb_get();
-        if (!_fb) { return len; }
-        _index = 0;
-        // Prepare part header
-        _header = String("--") + _boundary + "\r\n";
-        _header += "Content-Type: image/jpeg\r\n";
-        _header += "Content-Length: " + String(_fb->len) + "\r\n\r\n";
-        _headerSent = 0;
-        _state = State::SEND_HEADER;
-      }
-      if (_state == State::SEND_HEADER) {
-        size_t remaining = _header.length() - _headerSent;
-        if (remaining > 0) {
-          size_t toCopy = std::min(remaining, maxLen - len);
-          memcpy(buf + len, _header.c_str() + _headerSent, toCopy);
-          _headerSent += toCopy;
-          len += toCopy;
-          if (len >= maxLen) break;
-        }
-        if (_headerSent >= _header.length()) {
-          _state = State::SEND_FRAME;
-        } else {
-          break;
-        }
-      }
-      if (_state == State::SEND_FRAME) {
-        size_t remaining = _fb->len - _index;
-        if (remaining > 0) {
-          size_t toCopy = std::min(remaining, maxLen - len);
-          memcpy(buf + len, _fb->buf + _index, toCopy);
-          _index += toCopy;
-          len += toCopy;
-          if (len >= maxLen) break;
-        }
-        if (_index >= _fb->len) {
-          _state = State::SEND_TAIL;
-        } else {
-          break;
-        }
-      }
-      if (_state == State::SEND_TAIL) {
-        const char *tail = "\r\n";
-        size_t remaining = 2 - _tailSent;
-        if (remaining > 0) {
-          size_t toCopy = std::min(remaining, maxLen - len);
-          memcpy(buf + len, tail + _tailSent, toCopy);
-          _tailSent += toCopy;
-          len += toCopy;
-          if (len >= maxLen) break;
-        }
-        if (_tailSent >= 2) {
-          _tailSent = 0;
-          // Completed a frame; update global stream stats
-          if (_fb) { camStatFrames++; camStatBytes += _fb->len; }
-          if (_locked && cameraMutex) { xSemaphoreGive(cameraMutex); _locked = false; }
-          _state = State::HEADER; // next frame
-        } else {
-          break;
-        }
-      }
-    }
+
+  void _respond(AsyncWebServerRequest *request) override {
+    _request = request;
+    _client = request->client();
+    _pcb = _client->pcb();
+    _state = RESPONSE_CONTENT;
+    pump();
+  }
+
+  // Also called with len 0 from the connection poll
+  size_t _ack(AsyncWebServerRequest *request, size_t len, uint32_t time) override {
+    (void)request; (void)time;
+    _acked += len;
+    pump();
     return len;
   }
+
+  // Complete the deferred responses on `ring` that its newest frame satisfies
+  static void resume(const FrameRing &ring) {
+    for (auto p : pendingFrames) {
+      if (p && &p->_ring == &ring && p->_request) p->pump();
+    }
+  }
+
 private:
-  enum class State { HEADER, SEND_HEADER, SEND_FRAME, SEND_TAIL };
-  const char* _boundary = "frame";
-  camera_fb_t *_fb;
-  size_t _index;
-  State _state;
-  String _header;
-  size_t _headerSent = 0;
-  size_t _tailSent = 0;
-  bool _locked = false;
+  void unregister() {
+    for (auto &p : pendingFrames) if (p == this) p = nullptr;
+  }
+
+  // Format the head once a newer frame is published or the wait has timed out
+  bool resolve() {
+    CameraFramePtr f = _ring.latest();
+    bool ready = f && f->seq > _afterSeq;
+    if (!ready && millis() - _startMs < CAMERA_SNAPSHOT_WAIT_MS) return false;
+    unregister();
+    cameraWaiters.remove(_client);
+    _stats.waitUs.add(micros() - _startUs);
+    _stats.waited++;
+    int n;
+    if (ready) {
+      _frame = f;
+      _body = f->buf;
+      _bodyLen = f->len;
+      _stats.failedMs = 0;
+      n = snprintf(_head, sizeof(_head),
+                   "HTTP/1.%d 200 OK\r\nConnection: close\r\nContent-Type: image/jpeg\r\nContent-Length: %u\r\n"
+                   "Cache-Control: no-store\r\nX-Frame-Age-Ms: %lu\r\n\r\n",
+                   _request->version(), (unsigned)f->len, (unsigned long)(millis() - f->capturedMs));
+    } else {
+      _code = 500;
+      _body = (const uint8_t*)_error;
+      _bodyLen = strlen(_error);
+      _stats.failed++;
+      _stats.failedMs = millis() | 1;
+      n = snprintf(_head, sizeof(_head),
+                   "HTTP/1.%d 500 Internal Server Error\r\nConnection: close\r\nContent-Type: application/json\r\nContent-Length: %u\r\n\r\n",
+                   _request->version(), (unsigned)_bodyLen);
+    }
+    _headLen = (size_t)n;
+    return true;
+  }
+
+  void pump() {
+    if (!_headLen && !resolve()) {
+      cameraWaiters.add(_client);
+      return;
+    }
+    AsyncClient *client = _request->client();
+    const size_t total = _headLen + _bodyLen;
+    bool added = false;
+    while (_written < total) {
+      size_t space = client->space();
+      if (!space) break;
+      size_t w;
+      if (_written < _headLen) {
+        w = client->add(_head + _written, std::min(space, _headLen - _written));
+      } else {
+        // By reference (no ASYNC_WRITE_FLAG_COPY): the frame or literal outlives the send
+        w = client->add((const char*)_body + (_written - _headLen), std::min(space, total - _written), 0);
+      }
+      if (!w) break;
+      _written += w;
+      added = true;
+    }
+    _writtenLength = _written;
+    if (added) client->send();
+    if (_written >= total) _state = (_acked >= total) ? RESPONSE_END : RESPONSE_WAIT_ACK;
+  }
+
+  const FrameRing &_ring;
+  const uint32_t _afterSeq;
+  SnapshotStats &_stats;
+  const char *_error;
+  AsyncWebServerRequest *_request = nullptr;
+  AsyncClient *_client = nullptr;        // for cameraWaiters
+  struct tcp_pcb *_pcb = nullptr;        // for tcpDiscardDetached
+  CameraFramePtr _frame;
+  const uint8_t *_body = nullptr;
+  size_t _bodyLen = 0;
+  char _head[176];
+  size_t _headLen = 0;
+  size_t _written = 0;
+  size_t _acked = 0;
+  uint32_t _startMs, _startUs;
 };
 
-// Optimized calculation functions using fast math
-inline float calculateDewPoint(float temp, float humidity) {
-  const float a = 17.27f;
-  const float b = 237.7f;
-  float alpha = ((a * temp) / (b + temp)) + logf(humidity * 0.01f);
-  return (b * alpha) / (a - alpha);
+// Snapshot/thumbnail handler body: a recent frame at once, otherwise a
+// deferred response; the AsyncTCP task is never held up waiting for a capture
+static void sendRingFrame(AsyncWebServerRequest *request, FrameRing &ring, uint32_t defaultMaxAge,
+                          SnapshotStats &stats, const char *errorBody) {
+  uint32_t maxAge = defaultMaxAge;
+  if (request->hasParam("maxAge")) maxAge = constrain(request->getParam("maxAge")->value().toInt(), 0, CAMERA_SNAPSHOT_MAX_AGE_CAP_MS);
+  frameRing.demand();
+  ring.demand();
+  AsyncRingFrameResponse::resume(ring);
+  CameraFramePtr frame = ring.latest();
+  if (frame && millis() - frame->capturedMs <= maxAge) {
+    stats.cached++;
+    // Aliases the frame: its slot stays reserved until the response is sent
+    ArenaResponse *response = ArenaResponse::blob(200, "image/jpeg", std::shared_ptr<const uint8_t>(frame, frame->buf), frame->len);
+    char age[12];
+    snprintf(age, sizeof(age), "%lu", (unsigned long)(millis() - frame->capturedMs));
+    response->header("Cache-Control", "no-store");
+    response->header("X-Frame-Age-Ms", age);
+    request->send(response);
+  } else if (stats.failedMs && millis() - stats.failedMs < CAMERA_SNAPSHOT_BACKOFF_MS) {
+    stats.failed++;
+    request->send(500, "application/json", errorBody);
+  } else {
+    request->send(new AsyncRingFrameResponse(ring, frame ? frame->seq : 0, stats, errorBody));
+  }
 }
 
-inline float calculateHeatIndex(float temp, float humidity) {
-  if (temp < 27.0f) return temp;
-  return 0.5f * (temp + 61.0f + ((temp - 68.0f) * 1.2f) + (humidity * 0.094f));
+// Shared JPEG quality back-off: while any unthrottled viewer reports congestion
+// the capture quality is lowered in steps; it recovers once none has for a while
+#define STREAM_QUALITY_STEP        5      // jpeg_quality units per step (higher = smaller frames)
+#define STREAM_QUALITY_MAX_STEPS   4
+#define STREAM_QUALITY_HOLD_MS     2000   // minimum time between steps
+#define STREAM_QUALITY_CLEAR_MS    5000   // congestion-free time before stepping back up
+static uint8_t camQualityStep = 0;
+
+// Camera task, under cameraLock
+static void cameraAdaptQuality() {
+  static uint32_t lastStepMs = 0;
+  static int appliedQ = -1;
+  uint32_t now = millis();
+  if (now - lastStepMs >= STREAM_QUALITY_HOLD_MS) {
+    bool congested = camCongestedMs && now - camCongestedMs < STREAM_QUALITY_HOLD_MS;
+    if (congested && camQualityStep < STREAM_QUALITY_MAX_STEPS) {
+      camQualityStep++;
+      lastStepMs = now;
+    } else if (!congested && camQualityStep && now - camCongestedMs >= STREAM_QUALITY_CLEAR_MS) {
+      camQualityStep--;
+      lastStepMs = now;
+    }
+  }
+  int q = constrain(appSettings.camQuality + camQualityStep * STREAM_QUALITY_STEP, 10, 63);
+  if (q == appliedQ) return;
+  sensor_t *s = esp_camera_sensor_get();
+  if (s) s->set_quality(s, q);
+  appliedQ = q;
 }
 
-inline float calculateVPD(float temp, float humidity) {
-  float es = 0.6108f * expf((17.27f * temp) / (temp + 237.3f));
-  float ea = es * humidity * 0.01f;
-  return es - ea;
+void cameraTask(void *parameter) {
+  for (;;) {
+    if (!cameraAvailable || !frameRing.wanted()) {
+      frameRing.waitForDemand(pdMS_TO_TICKS(FRAME_RING_IDLE_MS));
+      continue;
+    }
+    cameraLock();
+    camera_fb_t *fb = cameraAvailable ? esp_camera_fb_get() : nullptr;
+    bool published = false;
+    if (fb) {
+      published = frameRing.publish(fb->buf, fb->len, fb->width, fb->height);
+      if (published) cameraWaiters.wake();
+      esp_camera_fb_return(fb);
+      cameraAdaptQuality();
+    }
+    cameraUnlock();
+    if (!fb) vTaskDelay(pdMS_TO_TICKS(CAMERA_CAPTURE_RETRY_MS));
+    // Outside the lock: decoding and re-encoding takes a while
+    if (published && cameraThumbs.update(frameRing.latest())) cameraWaiters.wake();
+  }
 }
 
-inline float calculateAbsoluteHumidity(float temp, float humidity) {
-  float es = 0.6108f * expf((17.27f * temp) / (temp + 237.3f));
-  float ea = es * humidity * 0.01f;
-  return (ea * 2.16679f) / (temp + 273.15f);
-}
+// MJPEG streaming response for AsyncWebServer: sends the newest ring frame each
+// time, so every viewer shares one capture and a slow one skips frames.
+//
+// Each viewer is paced to its own frame rate: the ?fps= / ?maxkbps= limits
+// from the request, further cut by AIMD on the TCP ack latency (halved when
+// acks lag, +1 fps per frame when they are prompt), so a weak link gets fewer
+// frames instead of a growing backlog that also delays the telemetry socket.
+// Pacing never sleeps in the AsyncTCP task: a viewer whose next frame is not
+// due yet waits for the camera task's wake-up after a later publish, so its
+// rate is quantised to the capture interval.
+//
+// Like ArenaResponse it writes to the TCP client itself, without chunked
+// encoding (the body ends when the connection closes). Headers and part
+// delimiters are formatted into a fixed buffer and copied; JPEG data is handed
+// to lwIP by reference, straight out of the ring slot. Every frame with bytes
+// not yet acknowledged stays referenced in _inflight, so its slot cannot be
+// reused under the TCP stack; a viewer that disconnects with frames in flight
+// has lwIP drop them before the references go (tcp_detach.h).
+#define STREAM_MAX_FPS         30
+#define STREAM_ACK_HIGH_MS     250   // ack latency that halves the viewer's rate
+#define STREAM_ACK_LOW_MS      80    // below this the rate recovers
+#define STREAM_CONGESTED_FPS   4     // an unthrottled viewer pushed below this asks for lower quality
+#define STREAM_MAX_VIEWERS     FRAME_RING_VIEWERS         // further viewers get 503
+#define STREAM_INFLIGHT_FRAMES FRAME_RING_VIEWER_FRAMES   // frames with unacked bytes (TCP send buffer < one frame)
+#define STREAM_BOUNDARY        "frame"
+
+class AsyncJpegStreamResponse;
+static AsyncJpegStreamResponse *streamViewers[STREAM_MAX_VIEWERS];   // AsyncTCP task only
+
+class AsyncJpegStreamResponse : public AsyncWebServerResponse {
+public:
+  // fpsLimit / maxKbps: 0 = unlimited
+  AsyncJpegStreamResponse(uint8_t fpsLimit, uint16_t maxKbps) {
+    _code = 200;
+    _limited = fpsLimit || maxKbps;
+    _limitFps = fpsLimit ? fpsLimit : STREAM_MAX_FPS;
+    _capFps = _limitFps;
+    _maxKbps = maxKbps;
+    _rateStartMs = millis();
+    for (auto &v : streamViewers) if (!v) { v = this; break; }
+  }
+  ~AsyncJpegStreamResponse() override {
+    for (auto &v : streamViewers) if (v == this) v = nullptr;
+    if (_client) cameraWaiters.remove(_client);
+    if (_inflightCount) tcpDiscardDetached(_pcb);
+  }
+  bool _sourceValid() const override { return true; }
+
+  void _respond(AsyncWebServerRequest *request) override {
+    int n = snprintf(_head, sizeof(_head),
+                     "HTTP/1.%d 200 OK\r\nConnection: close\r\n"
+                     "Content-Type: multipart/x-mixed-replace; boundary=" STREAM_BOUNDARY "\r\n"
+                     "Cache-Control: no-store, no-cache, must-revalidate, max-age=0\r\nPragma: no-cache\r\n\r\n"
+                     "--" STREAM_BOUNDARY "\r\n", request->version());
+    _headLen = (size_t)n;
+    _headSent = 0;
+    _client = request->client();
+    _pcb = _client->pcb();
+    _state = RESPONSE_CONTENT;
+    pump(request);
+  }
+
+  size_t _ack(AsyncWebServerRequest *request, size_t len, uint32_t time) override {
+    if (len) {
+      _ackMs = _ackMs ? (_ackMs * 7 + time) / 8 : time;
+      _ackedBytes += len;
+      _acked += len;
+      // Drop frames the peer has fully acknowledged
+      while (_inflightCount && (int32_t)(_acked - _inflight[_inflightHead].end) >= 0) {
+        _inflight[_inflightHead].frame.reset();
+        _inflightHead = (_inflightHead + 1) % STREAM_INFLIGHT_FRAMES;
+        _inflightCount--;
+      }
+    }
+    uint32_t now = millis();
+    if (now - _rateStartMs >= 1000) {
+      _kbps = _ackedBytes * 8 / (now - _rateStartMs);
+      _ackedBytes = 0;
+      _rateStartMs = now;
+    }
+    pump(request);
+    return len;
+  }
+
+  void fillJson(JsonObject o) const {
+    o["fps"] = _capFps;
+    o["limitFps"] = _limited ? _limitFps : 0;
+    o["maxKbps"] = _maxKbps;
+    o["kbps"] = _kbps;
+    o["ackMs"] = _ackMs;
+    o["frames"] = _frames;
+    o["skipped"] = _skipped;
+  }
+
+private:
+  void pump(AsyncWebServerRequest *request) {
+    AsyncClient *client = request->client();
+    bool added = false;
+    for (;;) {
+      size_t space = client->space();
+      if (!space) break;
+      size_t w;
+      if (_headSent < _headLen) {
+        // Small: copied into the send buffer
+        w = client->add(_head + _headSent, std::min(space, _headLen - _headSent));
+        _headSent += w;
+      } else if (_frame) {
+        // By reference (no ASYNC_WRITE_FLAG_COPY); _inflight keeps the bytes alive until acked
+        w = client->add((const char*)_frame->buf + _index, std::min(space, _frame->len - _index), 0);
+        _index += w;
+        if (_index >= _frame->len) finishFrame();
+      } else {
+        if (!startFrame()) break;
+        continue;
+      }
+      if (!w) break;
+      _written += w;
+      added = true;
+    }
+    _writtenLength = _written;
+    if (added) client->send();
+  }
+
+  // Pick the next frame and format its part header. Never waits: before the
+  // viewer's pacing interval is over, or with nothing newer than the last frame
+  // sent, it asks the camera task for a wake-up and resumes from the poll that
+  // follows the next publish
+  bool startFrame() {
+    if (_inflightCount >= STREAM_INFLIGHT_FRAMES) return false;
+    frameRing.demand();
+    CameraFramePtr next = frameRing.latest();
+    if ((int32_t)(_dueMs - millis()) > 0 || !next || next->seq <= _seq) {
+      cameraWaiters.add(_client);
+      return false;
+    }
+    cameraWaiters.remove(_client);
+    if (_seq && next->seq > _seq + 1) {
+      camStatSkipped += next->seq - _seq - 1;
+      _skipped += next->seq - _seq - 1;
+    }
+    _seq = next->seq;
+    _frameStartMs = millis();
+    int n = snprintf(_head, sizeof(_head), "Content-Type: image/jpeg\r\nContent-Length: %u\r\n\r\n", (unsigned)next->len);
+    _headLen = (size_t)n;
+    _headSent = 0;
+    _index = 0;
+    _frame = next.get();
+    uint8_t slot = (_inflightHead + _inflightCount) % STREAM_INFLIGHT_FRAMES;
+    _inflight[slot] = { std::move(next), _written + _headLen + (uint32_t)_frame->len };
+    _inflightCount++;
+    return true;
+  }
+
+  void finishFrame() {
+    camStatFrames++; camStatBytes += _frame->len;
+    _frames++;
+    pace(_frame->len);
+    _frame = nullptr;
+    // Close the part right away so the browser shows it without waiting for the next one
+    memcpy(_head, "\r\n--" STREAM_BOUNDARY "\r\n", sizeof("\r\n--" STREAM_BOUNDARY "\r\n"));
+    _headLen = sizeof("\r\n--" STREAM_BOUNDARY "\r\n") - 1;
+    _headSent = 0;
+  }
+
+  // After each frame: adapt the rate to ack latency and set when the next may start
+  void pace(size_t frameBytes) {
+    if (_ackMs > STREAM_ACK_HIGH_MS) _capFps = std::max<uint8_t>(1, _capFps / 2);
+    else if (_ackMs < STREAM_ACK_LOW_MS && _capFps < _limitFps) _capFps++;
+    if (!_limited && _capFps < STREAM_CONGESTED_FPS) camCongestedMs = millis() | 1;
+    uint32_t interval = 1000 / _capFps;
+    if (_maxKbps) interval = std::max<uint32_t>(interval, frameBytes * 8 / _maxKbps);
+    _dueMs = _frameStartMs + interval;
+  }
+
+  struct Inflight {
+    CameraFramePtr frame;
+    uint32_t end;           // stream offset just past the frame's last byte
+  };
+  Inflight _inflight[STREAM_INFLIGHT_FRAMES];
+  uint8_t _inflightHead = 0;
+  uint8_t _inflightCount = 0;
+  const CameraFrame *_frame = nullptr;   // being written; owned by _inflight
+  AsyncClient *_client = nullptr;        // for cameraWaiters
+  struct tcp_pcb *_pcb = nullptr;        // for tcpDiscardDetached
+  uint32_t _seq = 0;      // last frame sent
+  size_t _index = 0;
+  char _head[256];        // HTTP head, part header or part delimiter
+  size_t _headLen = 0;
+  size_t _headSent = 0;
+  uint32_t _written = 0;  // stream offsets
+  uint32_t _acked = 0;
+  // Pacing and link estimates
+  bool _limited;
+  uint8_t _limitFps;
+  uint8_t _capFps;        // current adapted rate
+  uint16_t _maxKbps;
+  uint32_t _frameStartMs = 0;
+  uint32_t _dueMs = 0;
+  uint32_t _ackMs = 0;    // EWMA of ack latency
+  uint32_t _ackedBytes = 0;
+  uint32_t _rateStartMs;
+  uint32_t _kbps = 0;     // acked throughput over the last second
+  uint32_t _frames = 0;
+  uint32_t _skipped = 0;
+};
 
 String getTemperatureStatus(float tempC) {
   // Sensor temperature is in °C; thresholds may be saved in user units (°F or °C).
@@ -728,6 +1117,13 @@ void loadAppSettings() {
   appSettings.comfortIdeal = appPrefs.getFloat("cideal", thresholds.comfortIdeal);
   appSettings.camFrameSize = appPrefs.getInt("camsize", appSettings.camFrameSize);
   appSettings.camQuality = appPrefs.getInt("camq", appSettings.camQuality);
+  appSettings.filtDecimation = appPrefs.getInt("fdec", appSettings.filtDecimation);
+  appSettings.filtMedian = appPrefs.getInt("fmed", appSettings.filtMedian);
+  appSettings.filtSmoothing = appPrefs.getInt("fsmooth", appSettings.filtSmoothing);
+  appSettings.filtAlpha = appPrefs.getFloat("falpha", appSettings.filtAlpha);
+  appSettings.filtRateTemp = appPrefs.getFloat("fratet", appSettings.filtRateTemp);
+  appSettings.filtRateHum = appPrefs.getFloat("frateh", appSettings.filtRateHum);
+  appSettings.filtMadK = appPrefs.getFloat("fmadk", appSettings.filtMadK);
   // Persisted installed firmware tag (if any)
   installedFwTag = appPrefs.getString("fw_tag", "");
   appPrefs.end();
@@ -743,6 +1139,7 @@ void loadAppSettings() {
   thresholds.comfortMax = appSettings.comfortMax;
   thresholds.comfortIdeal = appSettings.comfortIdeal;
   mdnsHostname = appSettings.hostname.length() ? appSettings.hostname : String("momo");
+  filterConfigVersion++;  // sensorTask picks up the new filter settings
 }
 
 void saveAppSettings(const AppSettings &s) {
@@ -760,37 +1157,17 @@ void saveAppSettings(const AppSettings &s) {
   appPrefs.putFloat("cideal", s.comfortIdeal);
   appPrefs.putInt("camsize", s.camFrameSize);
   appPrefs.putInt("camq", s.camQuality);
+  appPrefs.putInt("fdec", s.filtDecimation);
+  appPrefs.putInt("fmed", s.filtMedian);
+  appPrefs.putInt("fsmooth", s.filtSmoothing);
+  appPrefs.putFloat("falpha", s.filtAlpha);
+  appPrefs.putFloat("fratet", s.filtRateTemp);
+  appPrefs.putFloat("frateh", s.filtRateHum);
+  appPrefs.putFloat("fmadk", s.filtMadK);
   if (installedFwTag.length()) appPrefs.putString("fw_tag", installedFwTag);
   appPrefs.end();
 }
 
-void updateStatisticsAtomic(float temp, float humidity, float dewPoint) {
-  if (!stats.initialized) {
-    stats.tempMin = stats.tempMax = stats.tempAvg = temp;
-    stats.humMin = stats.humMax = stats.humAvg = humidity;
-    stats.dewMin = stats.dewMax = stats.dewAvg = dewPoint;
-    stats.readingCount = 1;
-    stats.initialized = true;
-    return;
-  }
-  
-  stats.readingCount++;
-  float n = stats.readingCount;
-  
-  // Update averages with exponential smoothing for better performance
-  stats.tempAvg = ((n-1) * stats.tempAvg + temp) / n;
-  stats.humAvg = ((n-1) * stats.humAvg + humidity) / n;
-  stats.dewAvg = ((n-1) * stats.dewAvg + dewPoint) / n;
-  
-  // Update min/max
-  if (temp < stats.tempMin) stats.tempMin = temp;
-  if (temp > stats.tempMax) stats.tempMax = temp;
-  if (humidity < stats.humMin) stats.humMin = humidity;
-  if (humidity > stats.humMax) stats.humMax = humidity;
-  if (dewPoint < stats.dewMin) stats.dewMin = dewPoint;
-  if (dewPoint > stats.dewMax) stats.dewMax = dewPoint;
-}
-
 void updateLEDStatusFast(float temp, float humidity) {
   bool tempOK = (temp >= thresholds.tempMin && temp <= thresholds.tempMax);
   bool humOK = (humidity >= thresholds.humMin && humidity <= thresholds.humMax);
@@ -888,6 +1265,7 @@ void setupWiFi() {
       WiFi.softAPdisconnect(true);
       useAccessPoint = false;
     }
+    startTimeSync();
     // Start mDNS for easy discovery when connected to WiFi
     mdnsActive = MDNS.begin(mdnsHostname.c_str());
     if (mdnsActive) {
@@ -914,74 +1292,74 @@ void setupWiFi() {
   }
 }
 
-String generateJsonData() {
-  DynamicJsonDocument doc(1024);
-  
-  // Current readings
-  float tempDisplay = currentData.temperature;
-  if (appSettings.units == "F") {
-    tempDisplay = currentData.temperature * 9.0f / 5.0f + 32.0f;
-  }
-  doc["temperature"] = tempDisplay;
-  doc["humidity"] = currentData.humidity;
-  float dewDisplay = currentData.dewPoint;
-  float heatIdxDisplay = currentData.heatIndex;
-  if (appSettings.units == "F") {
-    dewDisplay = currentData.dewPoint * 9.0f / 5.0f + 32.0f;
-    heatIdxDisplay = currentData.heatIndex * 9.0f / 5.0f + 32.0f;
-  }
-  doc["dewPoint"] = dewDisplay;
-  doc["heatIndex"] = heatIdxDisplay;
-  doc["vpd"] = currentData.vaporPressureDeficit;
-  doc["absoluteHumidity"] = currentData.absoluteHumidity;
-  doc["timestamp"] = currentData.timestamp;
-  doc["valid"] = currentData.valid;
-  
-  // Status indicators
-  doc["tempStatus"] = getTemperatureStatus(currentData.temperature);
-  doc["humStatus"] = getHumidityStatus(currentData.humidity);
-  doc["units"] = appSettings.units;
-  
-  // Thresholds
-  JsonObject thresh = doc.createNestedObject("thresholds");
-  thresh["tempMin"] = thresholds.tempMin;
-  thresh["tempMax"] = thresholds.tempMax;
-  thresh["tempIdeal"] = thresholds.tempIdeal;
-  thresh["humMin"] = thresholds.humMin;
-  thresh["humMax"] = thresholds.humMax;
-  thresh["humIdeal"] = thresholds.humIdeal;
-  thresh["comfortMin"] = thresholds.comfortMin;
-  thresh["comfortMax"] = thresholds.comfortMax;
-  thresh["comfortIdeal"] = thresholds.comfortIdeal;
-  
-  // Statistics
-  if (stats.initialized) {
-    JsonObject st = doc.createNestedObject("stats");
-    st["tempMin"] = stats.tempMin;
-    st["tempMax"] = stats.tempMax;
-    st["tempAvg"] = stats.tempAvg;
-    st["humMin"] = stats.humMin;
-    st["humMax"] = stats.humMax;
-    st["humAvg"] = stats.humAvg;
-    st["dewMin"] = stats.dewMin;
-    st["dewMax"] = stats.dewMax;
-    st["dewAvg"] = stats.dewAvg;
-    st["readingCount"] = stats.readingCount;
-  }
-  
-  // System info
-  JsonObject sys = doc.createNestedObject("system");
-  sys["uptime"] = millis();
-  sys["freeHeap"] = ESP.getFreeHeap();
-  // Total heap size (bytes)
+// ---- Cold telemetry (system frame) ----
+// Identity/flash/firmware fields never change after boot and are read once.
+// Network fields and LittleFS usage are refreshed on a slow cadence (or when
+// marked dirty) into a cached system frame; the per-tick live frame carries
+// only readings, status, stats and a handful of volatile counters.
+#define SYSTEM_INFO_REFRESH_MS   5000    // network/identity fields
+#define FS_USAGE_REFRESH_MS      60000   // LittleFS usage is a filesystem walk
+struct StaticSystemInfo {
+  uint32_t heapSize = 0;
+  uint32_t psramSize = 0;
+  uint32_t flashSize = 0;
+  uint32_t flashSpeed = 0;
+  uint32_t sketchSize = 0;
+  uint32_t freeSketch = 0;
+  uint32_t cpuFreq = 0;
+  int chipRev = 0;
+  String sdk, chipModel, macSta, macAp;
+};
+static StaticSystemInfo staticSysInfo;
+static size_t fsTotalCache = 0, fsUsedCache = 0;
+static unsigned long fsUsageAt = 0;
+static StaticJsonDocument<1024> systemInfoDoc;   // {"type":"system","system":{..},"thresholds":{..},"ssid":..}
+static String systemInfoJson;                    // systemInfoDoc serialized, sent to WS clients on change
+static uint32_t systemInfoVersion = 0;
+static volatile bool systemInfoDirty = true;
+static unsigned long systemInfoAt = 0;
+static SemaphoreHandle_t systemInfoMutex = NULL;
+
+void markSystemInfoDirty() { systemInfoDirty = true; }
+
+void initStaticSystemInfo() {
   #ifdef ESP_ARDUINO_VERSION
-  sys["heapSize"] = ESP.getHeapSize();
+  staticSysInfo.heapSize = ESP.getHeapSize();
   #endif
-  sys["cpuFreq"] = getCpuFrequencyMhz();
-  sys["sensorHz"] = sensorReadCount * 1000.0f / millis();
-  sys["displayHz"] = displayUpdateCount * 1000.0f / millis();
-  sys["camera"] = cameraAvailable;
-  sys["rssi"] = (WiFi.status() == WL_CONNECTED ? WiFi.RSSI() : 0);
+  staticSysInfo.psramSize = ESP.getPsramSize();
+  staticSysInfo.flashSize = ESP.getFlashChipSize();
+  staticSysInfo.flashSpeed = ESP.getFlashChipSpeed();
+  staticSysInfo.sketchSize = ESP.getSketchSize();
+  staticSysInfo.freeSketch = ESP.getFreeSketchSpace();
+  staticSysInfo.cpuFreq = getCpuFrequencyMhz();
+  staticSysInfo.sdk = String(ESP.getSdkVersion());
+  #ifdef ARDUINO_ARCH_ESP32
+  staticSysInfo.chipModel = String(ESP.getChipModel());
+  staticSysInfo.chipRev = ESP.getChipRevision();
+  #endif
+  staticSysInfo.macSta = WiFi.macAddress();
+  staticSysInfo.macAp = WiFi.softAPmacAddress();
+  if (!systemInfoMutex) systemInfoMutex = xSemaphoreCreateMutex();
+}
+
+// Rebuild the cached system frame when due. Returns true when its content changed.
+bool refreshSystemInfo(bool force) {
+  unsigned long now = millis();
+  if (!force && !systemInfoDirty && (now - systemInfoAt) < SYSTEM_INFO_REFRESH_MS) return false;
+  bool dirty = systemInfoDirty;
+  systemInfoDirty = false;
+  systemInfoAt = now;
+  if (force || dirty || fsUsageAt == 0 || (now - fsUsageAt) >= FS_USAGE_REFRESH_MS) {
+    fsTotalCache = LittleFS.totalBytes();
+    fsUsedCache = LittleFS.usedBytes();
+    fsUsageAt = now;
+  }
+
+  StaticJsonDocument<1024> doc;
+  doc["type"] = "system";
+  JsonObject sys = doc.createNestedObject("system");
+  sys["heapSize"] = staticSysInfo.heapSize;
+  sys["cpuFreq"] = staticSysInfo.cpuFreq;
   sys["ip"] = (WiFi.getMode() == WIFI_AP) ? WiFi.softAPIP().toString() : WiFi.localIP().toString();
   sys["hostname"] = mdnsHostname;
   sys["mdns"] = mdnsActive;
@@ -992,33 +1370,44 @@ String generateJsonData() {
   sys["sta"] = (WiFi.status() == WL_CONNECTED);
   sys["ap"] = (mode == WIFI_AP) || (mode == WIFI_AP_STA);
   // PSRAM (bytes)
-  sys["psramSize"] = ESP.getPsramSize();
-  sys["freePsram"] = ESP.getFreePsram();
+  sys["psramSize"] = staticSysInfo.psramSize;
   // Flash & sketch (bytes)
-  sys["flashSize"] = ESP.getFlashChipSize();
-  sys["flashSpeed"] = ESP.getFlashChipSpeed();
-  sys["sketchSize"] = ESP.getSketchSize();
-  sys["freeSketch"] = ESP.getFreeSketchSpace();
-  // LittleFS usage (bytes)
+  sys["flashSize"] = staticSysInfo.flashSize;
+  sys["flashSpeed"] = staticSysInfo.flashSpeed;
+  sys["sketchSize"] = staticSysInfo.sketchSize;
+  sys["freeSketch"] = staticSysInfo.freeSketch;
   // Report effective version: prefer installedFwTag when set
   sys["fwVersion"] = (installedFwTag.length() ? installedFwTag : fwVersion);
   sys["fwCommit"] = fwCommit;
   sys["fwBuilt"] = fwBuild;
-  sys["fsTotal"] = LittleFS.totalBytes();
-  sys["fsUsed"] = LittleFS.usedBytes();
+  // LittleFS usage (bytes)
+  sys["fsTotal"] = fsTotalCache;
+  sys["fsUsed"] = fsUsedCache;
   // Identity
-  sys["sdk"] = String(ESP.getSdkVersion());
+  sys["sdk"] = staticSysInfo.sdk;
   #ifdef ARDUINO_ARCH_ESP32
-  sys["chipModel"] = String(ESP.getChipModel());
-  sys["chipRev"] = ESP.getChipRevision();
+  sys["chipModel"] = staticSysInfo.chipModel;
+  sys["chipRev"] = staticSysInfo.chipRev;
   #endif
   // MAC addresses
-  sys["macSta"] = WiFi.macAddress();
-  sys["macAp"] = WiFi.softAPmacAddress();
+  sys["macSta"] = staticSysInfo.macSta;
+  sys["macAp"] = staticSysInfo.macAp;
+
+  // Thresholds
+  JsonObject thresh = doc.createNestedObject("thresholds");
+  thresh["tempMin"] = thresholds.tempMin;
+  thresh["tempMax"] = thresholds.tempMax;
+  thresh["tempIdeal"] = thresholds.tempIdeal;
+  thresh["humMin"] = thresholds.humMin;
+  thresh["humMax"] = thresholds.humMax;
+  thresh["humIdeal"] = thresholds.humIdeal;
+  thresh["comfortMin"] = thresholds.comfortMin;
+  thresh["comfortMax"] = thresholds.comfortMax;
+  thresh["comfortIdeal"] = thresholds.comfortIdeal;
+
   // Convenience fields: prefer STA SSID when connected; else show AP SSID if AP mode is active
   {
     wl_status_t st = WiFi.status();
-    wifi_mode_t mode = WiFi.getMode();
     bool apActive = (mode == WIFI_AP) || (mode == WIFI_AP_STA);
     if (st == WL_CONNECTED) {
       doc["ssid"] = selectedSSID;
@@ -1028,22 +1417,673 @@ String generateJsonData() {
       doc["ssid"] = "";
     }
   }
+
+  String json;
+  serializeJson(doc, json);
+  bool changed = false;
+  if (systemInfoMutex) xSemaphoreTake(systemInfoMutex, portMAX_DELAY);
+  if (json != systemInfoJson) {
+    systemInfoDoc = doc;
+    systemInfoJson = json;
+    systemInfoVersion++;
+    changed = true;
+  }
+  if (systemInfoMutex) xSemaphoreGive(systemInfoMutex);
+  return changed;
+}
+
+String getSystemInfoJson() {
+  if (systemInfoMutex) xSemaphoreTake(systemInfoMutex, portMAX_DELAY);
+  String out = systemInfoJson;
+  if (systemInfoMutex) xSemaphoreGive(systemInfoMutex);
+  return out;
+}
+
+// Timing histograms as JSON (bin i of a Log2Histogram holds values up to 2^i - 1)
+template <int N>
+static void fillLog2Json(JsonObject o, const Log2Histogram<N> &h) {
+  o["count"] = h.count;
+  o["mean"] = h.mean();
+  o["p50"] = h.percentile(50);
+  o["p99"] = h.percentile(99);
+  o["max"] = h.max;
+  JsonArray b = o.createNestedArray("bins");
+  for (uint32_t v : h.bins) b.add(v);
+}
+
+// Percentile summary only (bins omitted), for tables with many histograms
+template <int N>
+static void fillPercentilesJson(JsonObject o, const Log2Histogram<N> &h) {
+  o["count"] = h.count;
+  o["mean"] = h.mean();
+  o["p50"] = h.percentile(50);
+  o["p90"] = h.percentile(90);
+  o["p99"] = h.percentile(99);
+  o["max"] = h.max;
+}
+
+template <int N>
+static void fillLinearJson(JsonObject o, const LinearHistogram<N> &h) {
+  o["count"] = h.count;
+  o["min"] = h.min;
+  o["max"] = h.max;
+  o["origin"] = h.origin;
+  o["width"] = h.width;
+  JsonArray b = o.createNestedArray("bins");
+  for (uint32_t v : h.bins) b.add(v);
+}
+
+static void fillSnapshotStatsJson(JsonObject o, const SnapshotStats &st) {
+  o["cached"] = st.cached;
+  o["waited"] = st.waited;
+  o["failed"] = st.failed;
+  fillPercentilesJson(o.createNestedObject("waitUs"), st.waitUs);
+}
+
+// Flat fields are since boot (kept for existing clients); windows are nested by name
+static void fillStatsJson(JsonObject st, const Statistics &stats, bool hasHumidity) {
+  const StatSummary &b = stats.boot;
+  st["tempMin"] = b.min[STAT_TEMP];
+  st["tempMax"] = b.max[STAT_TEMP];
+  st["tempAvg"] = b.mean[STAT_TEMP];
+  if (hasHumidity) {
+    st["humMin"] = b.min[STAT_HUM];
+    st["humMax"] = b.max[STAT_HUM];
+    st["humAvg"] = b.mean[STAT_HUM];
+    st["dewMin"] = b.min[STAT_DEW];
+    st["dewMax"] = b.max[STAT_DEW];
+    st["dewAvg"] = b.mean[STAT_DEW];
+  }
+  st["readingCount"] = b.count;
+  static const char *const channelKeys[STAT_CHANNELS] = { "temp", "hum", "dew" };
+  const int nKeys = hasHumidity ? STAT_CHANNELS : 1;
+  for (int i = 0; i < STATS_WINDOWS; i++) {
+    const StatSummary &w = stats.windows[i];
+    JsonObject wo = st.createNestedObject(RollingStats::kWindows[i].name);
+    wo["count"] = w.count;
+    for (int c = 0; c < nKeys; c++) {
+      JsonObject co = wo.createNestedObject(channelKeys[c]);
+      co["min"] = w.min[c];
+      co["max"] = w.max[c];
+      co["avg"] = w.mean[c];
+      co["std"] = w.stddev[c];
+    }
+  }
+}
+
+// Hot fields: readings, status, stats and volatile counters
+static void fillLiveJson(JsonDocument &doc) {
+  SensorSnapshot snap;
+  uint32_t seq = sensorState.read(snap);
+  const EnvironmentData &currentData = snap.channels[0].data;
+  const Statistics &stats = snap.channels[0].stats;
+  const bool fahrenheit = (appSettings.units == "F");
+  auto disp = [fahrenheit](float c) { return fahrenheit ? c * 9.0f / 5.0f + 32.0f : c; };
+  doc["seq"] = seq;
+
+  // Current readings (primary channel)
+  doc["temperature"] = disp(currentData.temperature);
+  doc["humidity"] = currentData.humidity;
+  doc["dewPoint"] = disp(currentData.dewPoint);
+  doc["heatIndex"] = disp(currentData.heatIndex);
+  doc["vpd"] = currentData.vaporPressureDeficit;
+  doc["absoluteHumidity"] = currentData.absoluteHumidity;
+  doc["timestamp"] = currentData.timestamp;
+  doc["valid"] = currentData.valid;
+  
+  // Status indicators
+  doc["tempStatus"] = getTemperatureStatus(currentData.temperature);
+  doc["humStatus"] = getHumidityStatus(currentData.humidity);
+  doc["units"] = appSettings.units;
   
+  // Statistics
+  if (stats.initialized) fillStatsJson(doc.createNestedObject("stats"), stats, true);
+
+  // Every channel, primary included, in sensorHub order
+  JsonArray chs = doc.createNestedArray("channels");
+  for (int i = 0; i < snap.channelCount; i++) {
+    const ChannelState &cs = snap.channels[i];
+    const SensorChannel &hc = sensorHub.channel(i);
+    char addr[20];
+    hc.driver->address(addr, sizeof(addr));
+    JsonObject c = chs.createNestedObject();
+    c["id"] = (const char*)hc.id;
+    c["kind"] = hc.driver->kind();
+    c["address"] = addr;
+    c["valid"] = cs.data.valid;
+    c["timestamp"] = cs.data.timestamp;
+    c["temperature"] = disp(cs.data.temperature);
+    c["tempStatus"] = getTemperatureStatus(cs.data.temperature);
+    if (cs.hasHumidity) {
+      c["humidity"] = cs.data.humidity;
+      c["dewPoint"] = disp(cs.data.dewPoint);
+      c["heatIndex"] = disp(cs.data.heatIndex);
+      c["vpd"] = cs.data.vaporPressureDeficit;
+      c["absoluteHumidity"] = cs.data.absoluteHumidity;
+      c["humStatus"] = getHumidityStatus(cs.data.humidity);
+    }
+    if (cs.stats.initialized) fillStatsJson(c.createNestedObject("stats"), cs.stats, cs.hasHumidity);
+  }
+  
+  // Volatile system counters
+  JsonObject sys = doc.createNestedObject("system");
+  sys["uptime"] = millis();
+  sys["freeHeap"] = ESP.getFreeHeap();
+  sys["freePsram"] = ESP.getFreePsram();
+  sys["sensorHz"] = sensorReadCount * 1000.0f / millis();
+  sys["displayHz"] = displayUpdateCount * 1000.0f / millis();
+  sys["camera"] = cameraAvailable;
+  sys["rssi"] = (WiFi.status() == WL_CONNECTED ? WiFi.RSSI() : 0);
+}
+
+// Full document: live frame plus the cached system frame (/api/data, WS connect)
+static void fillFullJson(JsonDocument &doc) {
+  fillLiveJson(doc);
+  JsonObject sys = doc["system"];
+  if (systemInfoMutex) xSemaphoreTake(systemInfoMutex, portMAX_DELAY);
+  for (JsonPair kv : systemInfoDoc["system"].as<JsonObject>()) sys[kv.key()] = kv.value();
+  doc["thresholds"] = systemInfoDoc["thresholds"];
+  doc["ssid"] = systemInfoDoc["ssid"];
+  if (systemInfoMutex) xSemaphoreGive(systemInfoMutex);
+}
+
+// Full telemetry document: system frame plus roughly 1 KB per sensor channel
+#define TELEMETRY_JSON_CAPACITY (3072 + SENSOR_MAX_CHANNELS * 1024)
+
+String generateJsonData() {
+  DynamicJsonDocument doc(TELEMETRY_JSON_CAPACITY);
+  fillFullJson(doc);
   String jsonString;
   serializeJson(doc, jsonString);
   return jsonString;
 }
 
+// ---- Telemetry snapshot (serialize once, fan out by reference) ----
+// webTask publishes a new snapshot only when a new sensor sample or system frame
+// exists (an "epoch"). WebSocket clients and every /api/data response share the
+// same buffers; REST clients revalidate with ETag/If-None-Match.
+struct TelemetrySnapshot {
+  uint32_t epoch = 0;
+  AsyncWebSocketSharedBuffer full;   // /api/data and WS connect
+  AsyncWebSocketSharedBuffer live;   // WS JSON clients
+};
+static TelemetrySnapshot telemetrySnap;
+static SemaphoreHandle_t telemetrySnapMutex = NULL;
+
+static AsyncWebSocketSharedBuffer serializeShared(JsonDocument &doc) {
+  size_t n = measureJson(doc);
+  auto buf = std::make_shared<std::vector<uint8_t>>(n + 1);
+  serializeJson(doc, (char*)buf->data(), n + 1);
+  buf->resize(n);  // drop the terminator; frames/bodies are length-delimited
+  return buf;
+}
+
+// Returns true when a new epoch was published
+static bool publishTelemetrySnapshot() {
+  static uint32_t lastSeq = 0;
+  static uint32_t lastSysVersion = 0;
+  if (!telemetrySnapMutex) telemetrySnapMutex = xSemaphoreCreateMutex();
+  uint32_t seq = sensorState.sequence();
+  if (telemetrySnap.epoch != 0 && seq == lastSeq && systemInfoVersion == lastSysVersion) return false;
+  lastSeq = seq;
+  lastSysVersion = systemInfoVersion;
+
+  DynamicJsonDocument doc(TELEMETRY_JSON_CAPACITY);
+  fillFullJson(doc);
+  AsyncWebSocketSharedBuffer full = serializeShared(doc);
+  doc.clear();
+  fillLiveJson(doc);
+  AsyncWebSocketSharedBuffer live = serializeShared(doc);
+
+  xSemaphoreTake(telemetrySnapMutex, portMAX_DELAY);
+  telemetrySnap.full = full;
+  telemetrySnap.live = live;
+  telemetrySnap.epoch++;
+  xSemaphoreGive(telemetrySnapMutex);
+  return true;
+}
+
+static TelemetrySnapshot currentTelemetrySnapshot() {
+  TelemetrySnapshot snap;
+  if (!telemetrySnapMutex) return snap;
+  xSemaphoreTake(telemetrySnapMutex, portMAX_DELAY);
+  snap = telemetrySnap;
+  xSemaphoreGive(telemetrySnapMutex);
+  return snap;
+}
+
+// WebSocket clients and the telemetry format each one negotiated.
+// The handshake runs before the client object exists, so binary opt-ins are
+// parked by TCP connection and claimed on WS_EVT_CONNECT.
+#define WS_MAX_CLIENTS 16
+struct WsClientSlot {
+  uint32_t id;      // 0 = free
+  bool binary;
+  bool perf;        // subscribed to {"type":"perf"} frames
+};
+static WsClientSlot wsClients[WS_MAX_CLIENTS];
+static AsyncClient *wsBinaryHandshakes[WS_MAX_CLIENTS]; // ring: a handshake that never connects is overwritten
+static int wsBinaryHandshakeNext = 0;
+static portMUX_TYPE wsClientsMux = portMUX_INITIALIZER_UNLOCKED;
+
+static bool wsHandshake(AsyncWebServerRequest *request) {
+  if (request->hasHeader("Sec-WebSocket-Protocol") &&
+      request->getHeader("Sec-WebSocket-Protocol")->value().indexOf(TELEMETRY_WS_PROTOCOL) >= 0) {
+    portENTER_CRITICAL(&wsClientsMux);
+    wsBinaryHandshakes[wsBinaryHandshakeNext] = request->client();
+    wsBinaryHandshakeNext = (wsBinaryHandshakeNext + 1) % WS_MAX_CLIENTS;
+    portEXIT_CRITICAL(&wsClientsMux);
+  }
+  return true;
+}
+
+static bool wsClientAdd(AsyncWebSocketClient *client) {
+  bool binary = false;
+  portENTER_CRITICAL(&wsClientsMux);
+  for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+    if (wsBinaryHandshakes[i] == client->client()) { wsBinaryHandshakes[i] = nullptr; binary = true; break; }
+  }
+  for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+    if (wsClients[i].id == 0) { wsClients[i].id = client->id(); wsClients[i].binary = binary; wsClients[i].perf = false; break; }
+  }
+  portEXIT_CRITICAL(&wsClientsMux);
+  return binary;
+}
+
+static void wsClientRemove(uint32_t id) {
+  portENTER_CRITICAL(&wsClientsMux);
+  for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+    if (wsClients[i].id == id) { wsClients[i].id = 0; wsClients[i].binary = false; wsClients[i].perf = false; }
+  }
+  portEXIT_CRITICAL(&wsClientsMux);
+}
+
+// Copy out client ids of one format so sends happen outside the critical section
+static int wsClientIds(bool binary, uint32_t *out) {
+  int n = 0;
+  portENTER_CRITICAL(&wsClientsMux);
+  for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+    if (wsClients[i].id != 0 && wsClients[i].binary == binary) out[n++] = wsClients[i].id;
+  }
+  portEXIT_CRITICAL(&wsClientsMux);
+  return n;
+}
+
+static void wsClientSetPerf(uint32_t id, bool on) {
+  portENTER_CRITICAL(&wsClientsMux);
+  for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+    if (wsClients[i].id == id) wsClients[i].perf = on;
+  }
+  portEXIT_CRITICAL(&wsClientsMux);
+}
+
+static int wsPerfClientIds(uint32_t *out) {
+  int n = 0;
+  portENTER_CRITICAL(&wsClientsMux);
+  for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+    if (wsClients[i].id != 0 && wsClients[i].perf) out[n++] = wsClients[i].id;
+  }
+  portEXIT_CRITICAL(&wsClientsMux);
+  return n;
+}
+
+static uint8_t telemetryStatusCode(const String &status) {
+  if (status == "Too Cold") return TELEMETRY_STATUS_TOO_COLD;
+  if (status == "Too Hot") return TELEMETRY_STATUS_TOO_HOT;
+  if (status == "Too Dry") return TELEMETRY_STATUS_TOO_DRY;
+  if (status == "Too Wet") return TELEMETRY_STATUS_TOO_WET;
+  return TELEMETRY_STATUS_PERFECT;
+}
+
+static uint8_t telemetryTempStatus(float tempC) { return telemetryStatusCode(getTemperatureStatus(tempC)); }
+static uint8_t telemetryHumStatus(float rh) { return telemetryStatusCode(getHumidityStatus(rh)); }
+
+// Header followed by one entry per channel; returns the frame length
+size_t buildLiveFrame(uint8_t *buf, size_t cap) {
+  SensorSnapshot snap;
+  TelemetryContext ctx;
+  ctx.seq = sensorState.read(snap);
+  ctx.uptime = millis();
+  ctx.fahrenheit = (appSettings.units == "F");
+  ctx.sta = (WiFi.status() == WL_CONNECTED);
+  ctx.camera = cameraAvailable;
+  ctx.rssi = ctx.sta ? (int8_t)WiFi.RSSI() : 0;
+  ctx.freeHeap = ESP.getFreeHeap();
+  ctx.freePsram = ESP.getFreePsram();
+  ctx.sensorHz = sensorReadCount * 1000.0f / millis();
+  ctx.tempStatus = telemetryTempStatus;
+  ctx.humStatus = telemetryHumStatus;
+  return telemetryPackLive(snap, ctx, buf, cap);
+}
+
+#define ROUTES_JSON_CAPACITY 24576   // /api/routes, ~400 B per route at ROUTE_METRICS_MAX
+
+// Load profile: per-task CPU and stacks (perfMonitor), sensor cadence, camera
+// lock waits and queue pressure. Rates cover the last perf interval, unlike the
+// lifetime averages in /api/data.
+#define PERF_JSON_CAPACITY 8192
+static float perfSensorHz = 0, perfDisplayHz = 0;
+
+static void fillPerfJson(JsonDocument &d, const PerfSample &ps) {
+  d["uptime"] = millis();
+  d["intervalMs"] = ps.intervalMs;
+  d["runtimeStats"] = ps.runtimeStats;
+  JsonArray cores = d.createNestedArray("coreLoad");
+  for (float c : ps.coreLoad) {
+    if (c >= 0.0f) cores.add(c); else cores.add(nullptr);
+  }
+  JsonArray tasks = d.createNestedArray("tasks");
+  for (int i = 0; i < ps.taskCount; i++) {
+    const PerfTask &t = ps.tasks[i];
+    JsonObject o = tasks.createNestedObject();
+    o["name"] = (const char*)t.name;
+    if (t.core >= 0) o["core"] = t.core;
+    o["priority"] = t.priority;
+    o["stackFree"] = t.stackFree;
+    if (t.cpu >= 0.0f) o["cpu"] = t.cpu;
+    if (t.exited) o["exited"] = true;
+  }
+  JsonObject rates = d.createNestedObject("rates");
+  rates["sensorHz"] = perfSensorHz;
+  rates["displayHz"] = perfDisplayHz;
+
+  SensorTiming t;
+  portENTER_CRITICAL(&sensorTimingMux);
+  t = sensorTiming;
+  portEXIT_CRITICAL(&sensorTimingMux);
+  JsonObject sensor = d.createNestedObject("sensor");
+  fillLinearJson(sensor.createNestedObject("periodUs"), t.periodUs);
+  fillLog2Json(sensor.createNestedObject("jitterUs"), t.jitterUs);
+  fillLog2Json(sensor.createNestedObject("fetchUs"), t.fetchUs);
+  sensor["overruns"] = t.overruns;
+
+  CameraLockStats cl;
+  portENTER_CRITICAL(&cameraLockStatsMux);
+  cl = cameraLockStats;
+  portEXIT_CRITICAL(&cameraLockStatsMux);
+  JsonObject cam = d.createNestedObject("cameraMutex");
+  cam["contended"] = cl.contended;
+  fillLog2Json(cam.createNestedObject("waitUs"), cl.waitUs);
+
+  JsonObject q = d.createNestedObject("sensorQueue");
+  q["depth"] = sensorDataQueue ? (uint32_t)uxQueueMessagesWaiting(sensorDataQueue) : 0;
+  q["capacity"] = SENSOR_QUEUE_LENGTH;
+  q["peak"] = sensorQueuePeak;
+  q["drops"] = sensorQueueDrops;
+
+  AssetCacheStats ac = assetCache.stats();
+  JsonObject cache = d.createNestedObject("assetCache");
+  cache["entries"] = ac.entries;
+  cache["bytes"] = ac.bytes;
+  cache["budget"] = assetCache.budget();
+  cache["hits"] = ac.hits;
+  cache["misses"] = ac.misses;
+  cache["evictions"] = ac.evictions;
+  cache["notModified"] = ac.notModified;
+
+  JsonObject heap = d.createNestedObject("heap");
+  heap["free"] = ESP.getFreeHeap();
+  heap["minFree"] = ESP.getMinFreeHeap();
+  heap["freePsram"] = ESP.getFreePsram();
+}
+
+// ---- /metrics (OpenMetrics) ----
+// Values are captured once per scrape; driver/filter counters are plain words
+// read live (a torn read is off by one at worst).
+static const char *const kOtaPhases[] = { "idle", "starting", "fw", "fw_done", "fs", "fs_done", "rebooting", "error" };
+static const char *const kStatNames[] = { "min", "max", "mean", "stddev" };
+
+struct MetricsScrape {
+  MetricsScrape();
+  SensorSnapshot snap;
+  uint32_t uptimeMs;
+  unsigned long readings;
+  size_t heapFree[2], heapLargest[2];   // internal, PSRAM
+  uint32_t heapMinFree;
+  bool sta;
+  int rssi;
+  size_t wsClients;
+  unsigned long camFrames, camBytes;
+  char otaPhaseName[16];
+  int otaPercent;
+  bool otaActive;
+  MetricsCursor cursor;
+};
+
+static const MetricsScrape &scrapeOf(const void *ctx) { return *static_cast<const MetricsScrape*>(ctx); }
+
+static void channelLabels(MetricSample &out, int ch, const char *extra = "") {
+  const SensorChannel &hc = sensorHub.channel(ch);
+  snprintf(out.labels, sizeof(out.labels), "channel=\"%s\",kind=\"%s\"%s", hc.id, hc.driver->kind(), extra);
+}
+
+// One reading field per valid channel; humidity fields skip temperature-only channels
+template <float EnvironmentData::*Field, bool NeedsHumidity>
+static MetricStep readingSample(const void *ctx, int i, MetricSample &out) {
+  const MetricsScrape &m = scrapeOf(ctx);
+  if (i >= m.snap.channelCount) return METRIC_END;
+  const ChannelState &cs = m.snap.channels[i];
+  if (!cs.data.valid || (NeedsHumidity && !cs.hasHumidity)) return METRIC_SKIP;
+  channelLabels(out, i);
+  out.value = cs.data.*Field;
+  return METRIC_EMIT;
+}
+
+// Rolling window statistics: index = (channel, window, statistic)
+template <int Stat, bool NeedsHumidity>
+static MetricStep windowSample(const void *ctx, int i, MetricSample &out) {
+  const MetricsScrape &m = scrapeOf(ctx);
+  const int perChannel = STATS_WINDOWS * 4;
+  int ch = i / perChannel, w = (i % perChannel) / 4, st = i % 4;
+  if (ch >= m.snap.channelCount) return METRIC_END;
+  const ChannelState &cs = m.snap.channels[ch];
+  const StatSummary &s = cs.stats.windows[w];
+  if (!s.count || (NeedsHumidity && !cs.hasHumidity)) return METRIC_SKIP;
+  char extra[40];
+  snprintf(extra, sizeof(extra), ",window=\"%s\",stat=\"%s\"", RollingStats::kWindows[w].name, kStatNames[st]);
+  channelLabels(out, ch, extra);
+  const float *v[] = { s.min, s.max, s.mean, s.stddev };
+  out.value = v[st][Stat];
+  return METRIC_EMIT;
+}
+
+static MetricStep sensorReadsSample(const void *ctx, int i, MetricSample &out) {
+  (void)ctx;
+  static const char *const kResults[] = { "ok", "not_ready", "error" };
+  int ch = i / 3, r = i % 3;
+  if (ch >= sensorHub.count()) return METRIC_END;
+  SensorDriverCounters c = sensorHub.channel(ch).driver->counters();
+  char extra[24];
+  snprintf(extra, sizeof(extra), ",result=\"%s\"", kResults[r]);
+  channelLabels(out, ch, extra);
+  out.value = r == 0 ? c.ok : r == 1 ? c.notReady : c.errors;
+  return METRIC_EMIT;
+}
+
+static MetricStep sensorRestartsSample(const void *ctx, int i, MetricSample &out) {
+  (void)ctx;
+  if (i >= sensorHub.count()) return METRIC_END;
+  channelLabels(out, i);
+  out.value = sensorHub.channel(i).driver->counters().restarts;
+  return METRIC_EMIT;
+}
+
+static MetricStep filterRejectedSample(const void *ctx, int i, MetricSample &out) {
+  const MetricsScrape &m = scrapeOf(ctx);
+  int ch = i / 4, q = (i / 2) % 2, reason = i % 2;
+  if (ch >= sensorHub.count()) return METRIC_END;
+  if (q == 1 && !m.snap.channels[ch].hasHumidity) return METRIC_SKIP;
+  const SensorChannel &hc = sensorHub.channel(ch);
+  const SignalFilter &f = q ? hc.humFilter : hc.tempFilter;
+  char extra[48];
+  snprintf(extra, sizeof(extra), ",quantity=\"%s\",reason=\"%s\"", q ? "humidity" : "temperature", reason ? "mad" : "rate");
+  channelLabels(out, ch, extra);
+  out.value = reason ? f.rejectedMad() : f.rejectedRate();
+  return METRIC_EMIT;
+}
+
+static MetricStep readingsSample(const void *ctx, int i, MetricSample &out) {
+  if (i) return METRIC_END;
+  out.value = scrapeOf(ctx).readings;
+  return METRIC_EMIT;
+}
+
+static MetricStep uptimeSample(const void *ctx, int i, MetricSample &out) {
+  if (i) return METRIC_END;
+  out.value = scrapeOf(ctx).uptimeMs / 1000.0;
+  return METRIC_EMIT;
+}
+
+static const char *const kHeapPools[] = { "internal", "psram" };
+
+static MetricStep heapFreeSample(const void *ctx, int i, MetricSample &out) {
+  if (i >= 2) return METRIC_END;
+  snprintf(out.labels, sizeof(out.labels), "pool=\"%s\"", kHeapPools[i]);
+  out.value = scrapeOf(ctx).heapFree[i];
+  return METRIC_EMIT;
+}
+
+static MetricStep heapLargestSample(const void *ctx, int i, MetricSample &out) {
+  if (i >= 2) return METRIC_END;
+  snprintf(out.labels, sizeof(out.labels), "pool=\"%s\"", kHeapPools[i]);
+  out.value = scrapeOf(ctx).heapLargest[i];
+  return METRIC_EMIT;
+}
+
+static MetricStep heapMinFreeSample(const void *ctx, int i, MetricSample &out) {
+  if (i) return METRIC_END;
+  snprintf(out.labels, sizeof(out.labels), "pool=\"internal\"");
+  out.value = scrapeOf(ctx).heapMinFree;
+  return METRIC_EMIT;
+}
+
+static MetricStep rssiSample(const void *ctx, int i, MetricSample &out) {
+  const MetricsScrape &m = scrapeOf(ctx);
+  if (i || !m.sta) return METRIC_END;
+  out.value = m.rssi;
+  return METRIC_EMIT;
+}
+
+static MetricStep wsClientsSample(const void *ctx, int i, MetricSample &out) {
+  if (i) return METRIC_END;
+  out.value = scrapeOf(ctx).wsClients;
+  return METRIC_EMIT;
+}
+
+static MetricStep camFramesSample(const void *ctx, int i, MetricSample &out) {
+  if (i) return METRIC_END;
+  out.value = scrapeOf(ctx).camFrames;
+  return METRIC_EMIT;
+}
+
+static MetricStep camBytesSample(const void *ctx, int i, MetricSample &out) {
+  if (i) return METRIC_END;
+  out.value = scrapeOf(ctx).camBytes;
+  return METRIC_EMIT;
+}
+
+static MetricStep otaPhaseSample(const void *ctx, int i, MetricSample &out) {
+  if (i >= (int)(sizeof(kOtaPhases) / sizeof(kOtaPhases[0]))) return METRIC_END;
+  snprintf(out.labels, sizeof(out.labels), "reptimon_ota_phase=\"%s\"", kOtaPhases[i]);
+  out.value = strcmp(scrapeOf(ctx).otaPhaseName, kOtaPhases[i]) == 0;
+  return METRIC_EMIT;
+}
+
+static MetricStep otaProgressSample(const void *ctx, int i, MetricSample &out) {
+  if (i) return METRIC_END;
+  out.value = scrapeOf(ctx).otaPercent;
+  return METRIC_EMIT;
+}
+
+static MetricStep otaActiveSample(const void *ctx, int i, MetricSample &out) {
+  if (i) return METRIC_END;
+  out.value = scrapeOf(ctx).otaActive;
+  return METRIC_EMIT;
+}
+
+static const MetricFamily kMetricFamilies[] = {
+  { "reptimon_temperature_celsius", METRIC_GAUGE, "celsius", "Filtered temperature",
+    readingSample<&EnvironmentData::temperature, false> },
+  { "reptimon_humidity_percent", METRIC_GAUGE, "percent", "Filtered relative humidity",
+    readingSample<&EnvironmentData::humidity, true> },
+  { "reptimon_dew_point_celsius", METRIC_GAUGE, "celsius", "Dew point",
+    readingSample<&EnvironmentData::dewPoint, true> },
+  { "reptimon_vapor_pressure_deficit_kilopascals", METRIC_GAUGE, "kilopascals", "Vapour pressure deficit",
+    readingSample<&EnvironmentData::vaporPressureDeficit, true> },
+  { "reptimon_temperature_window_celsius", METRIC_GAUGE, "celsius", "Rolling-window temperature statistics",
+    windowSample<STAT_TEMP, false> },
+  { "reptimon_humidity_window_percent", METRIC_GAUGE, "percent", "Rolling-window humidity statistics",
+    windowSample<STAT_HUM, true> },
+  { "reptimon_sensor_readings", METRIC_COUNTER, nullptr, "Primary channel readings published",
+    readingsSample },
+  { "reptimon_sensor_reads", METRIC_COUNTER, nullptr, "Driver fetch attempts by result",
+    sensorReadsSample },
+  { "reptimon_sensor_restarts", METRIC_COUNTER, nullptr, "Sensor re-initialisations after errors",
+    sensorRestartsSample },
+  { "reptimon_filter_rejected", METRIC_COUNTER, nullptr, "Samples rejected by the filter chain",
+    filterRejectedSample },
+  { "reptimon_uptime_seconds", METRIC_GAUGE, "seconds", "Time since boot",
+    uptimeSample },
+  { "reptimon_heap_free_bytes", METRIC_GAUGE, "bytes", "Free heap",
+    heapFreeSample },
+  { "reptimon_heap_largest_free_block_bytes", METRIC_GAUGE, "bytes", "Largest allocatable heap block",
+    heapLargestSample },
+  { "reptimon_heap_min_free_bytes", METRIC_GAUGE, "bytes", "Lowest free heap since boot",
+    heapMinFreeSample },
+  { "reptimon_wifi_rssi_dbm", METRIC_GAUGE, "dbm", "Station RSSI (absent when not connected)",
+    rssiSample },
+  { "reptimon_websocket_clients", METRIC_GAUGE, nullptr, "Connected WebSocket clients",
+    wsClientsSample },
+  { "reptimon_camera_frames", METRIC_COUNTER, nullptr, "MJPEG frames streamed since the camera started",
+    camFramesSample },
+  { "reptimon_camera_bytes", METRIC_COUNTER, "bytes", "MJPEG bytes streamed since the camera started",
+    camBytesSample },
+  { "reptimon_ota_phase", METRIC_STATESET, nullptr, "OTA update phase",
+    otaPhaseSample },
+  { "reptimon_ota_progress_percent", METRIC_GAUGE, "percent", "OTA progress of the current phase",
+    otaProgressSample },
+  { "reptimon_ota_in_progress", METRIC_GAUGE, nullptr, "1 while an OTA task is running",
+    otaActiveSample },
+};
+
+MetricsScrape::MetricsScrape()
+  : cursor(kMetricFamilies, sizeof(kMetricFamilies) / sizeof(kMetricFamilies[0]), this) {
+  sensorState.read(snap);
+  uptimeMs = millis();
+  readings = sensorReadCount;
+  heapFree[0] = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+  heapLargest[0] = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL);
+  heapFree[1] = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+  heapLargest[1] = heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM);
+  heapMinFree = ESP.getMinFreeHeap();
+  sta = WiFi.status() == WL_CONNECTED;
+  rssi = sta ? WiFi.RSSI() : 0;
+  wsClients = ws.count();
+  camFrames = camStatFrames;
+  camBytes = camStatBytes;
+  if (otaStateMutex) xSemaphoreTake(otaStateMutex, portMAX_DELAY);
+  strlcpy(otaPhaseName, otaPhase.c_str(), sizeof(otaPhaseName));
+  otaPercent = otaPct;
+  otaActive = otaInProgress;
+  if (otaStateMutex) xSemaphoreGive(otaStateMutex);
+}
+
 void onWsEvent(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventType type,
              void *arg, uint8_t *data, size_t len) {
   switch (type) {
-    case WS_EVT_CONNECT:
-  Serial.printf("WebSocket client #%u connected from %s\n", client->id(), client->remoteIP().toString().c_str());
-      // Send current data immediately
-      client->text(generateJsonData());
+    case WS_EVT_CONNECT: {
+      bool binary = wsClientAdd(client);
+  Serial.printf("WebSocket client #%u connected from %s (%s)\n", client->id(), client->remoteIP().toString().c_str(), binary ? "binary" : "json");
+      // Send current data immediately; binary clients take metadata from this one JSON document
+      {
+        TelemetrySnapshot snap = currentTelemetrySnapshot();
+        if (snap.full) client->text(snap.full); else client->text(generateJsonData());
+      }
       break;
+    }
       
     case WS_EVT_DISCONNECT:
+      wsClientRemove(client->id());
   Serial.printf("WebSocket client #%u disconnected\n", client->id());
       break;
       
@@ -1055,7 +2095,12 @@ void onWsEvent(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventTyp
       // Handle incoming data if needed (e.g., threshold updates)
       AwsFrameInfo *info = (AwsFrameInfo*)arg;
       if (info->final && info->index == 0 && info->len == len && info->opcode == WS_TEXT) {
-        // Handle text messages here if needed
+        // {"subscribe":"perf"} / {"unsubscribe":"perf"} toggle perf frames for this client
+        StaticJsonDocument<128> msg;
+        if (!deserializeJson(msg, (const char*)data, len)) {
+          if (msg["subscribe"] == "perf") { wsClientSetPerf(client->id(), true); break; }
+          if (msg["unsubscribe"] == "perf") { wsClientSetPerf(client->id(), false); break; }
+        }
         String message = "";
         for (size_t i = 0; i < info->len; i++) {
           message += (char) data[i];
@@ -1067,6 +2112,20 @@ void onWsEvent(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventTyp
   }
 }
 
+// Web UI files: from the PSRAM cache when possible, otherwise straight from
+// LittleFS (which falls back to <path>.gz with Content-Encoding: gzip).
+// Content-hashed /assets/ never change; everything else revalidates.
+static void sendWebAsset(AsyncWebServerRequest *request, const String &path) {
+  if (assetCache.send(request, path.c_str())) return;
+  if (!LittleFS.exists(path) && !LittleFS.exists(path + ".gz")) {
+    request->send(404, "text/plain", "File not found");
+    return;
+  }
+  AsyncWebServerResponse *response = request->beginResponse(LittleFS, path, String(), false);
+  response->addHeader("Cache-Control", path.startsWith("/assets/") ? "public, max-age=31536000, immutable" : "no-cache");
+  request->send(response);
+}
+
 void setupWebServer() {
   // Initialize LittleFS for serving static files
   if (!LittleFS.begin(true)) {
@@ -1074,10 +2133,18 @@ void setupWebServer() {
     return;
   }
   Serial.println("LittleFS initialized successfully");
+  historyStore.begin(LittleFS);
+  assetCache.begin(LittleFS);
+  if (!routeMetrics.begin()) Serial.println("Route metrics allocation failed; routes served unmeasured");
   
-  // WebSocket handler
+  // WebSocket handler (binary telemetry negotiated via subprotocol)
+  ws.handleHandshake(wsHandshake);
   ws.onEvent(onWsEvent);
   server.addHandler(&ws);
+
+  // API and metrics routes resolve in the router, ahead of the LittleFS handlers below
+  apiRouter.mount(server, "/api/*");
+  apiRouter.mount(server, "/metrics");
   
   // Serve static files from data folder
   // Route: if captive portal is active, default to portal.html at root; otherwise index.html
@@ -1085,16 +2152,19 @@ void setupWebServer() {
     if (captivePortalActive) return String("/portal.html");
     return String("/index.html");
   };
-  server.on("/", HTTP_GET, [defaultFileSelector](AsyncWebServerRequest *request){
-    String path = defaultFileSelector(request);
-    request->send(LittleFS, path, String(), false);
+  routeMetrics.on(server, "/", HTTP_GET, [defaultFileSelector](AsyncWebServerRequest *request){
+    sendWebAsset(request, defaultFileSelector(request));
   });
   // Also expose explicit /portal and /index
-  server.on("/portal", HTTP_GET, [](AsyncWebServerRequest *request){ request->send(LittleFS, "/portal.html", String(), false); });
-  server.on("/index", HTTP_GET, [](AsyncWebServerRequest *request){ request->send(LittleFS, "/index.html", String(), false); });
-  // Static assets under root
+  routeMetrics.on(server, "/portal", HTTP_GET, [](AsyncWebServerRequest *request){ sendWebAsset(request, "/portal.html"); });
+  routeMetrics.on(server, "/index", HTTP_GET, [](AsyncWebServerRequest *request){ sendWebAsset(request, "/index.html"); });
+  // Content-hashed build output (scripts/build_webui.py): stored as .gz, served with
+  // Content-Encoding: gzip, and never revalidated since a change means a new name
+  routeMetrics.on(server, "/assets/*", HTTP_GET, [](AsyncWebServerRequest *request){ sendWebAsset(request, request->url()); });
+  routeMetrics.on(server, "/index.html", HTTP_GET, [](AsyncWebServerRequest *request){ sendWebAsset(request, "/index.html"); });
+  server.serveStatic("/asset-manifest.json", LittleFS, "/asset-manifest.json").setCacheControl("no-cache");
+  // Unhashed names, for an image built straight from data/ without the pipeline
   // IMPORTANT: Disable cache for core SPA assets to avoid client-side mismatches after updates
-  server.serveStatic("/index.html", LittleFS, "/index.html").setCacheControl("no-cache, no-store, must-revalidate");
   server.serveStatic("/script.js", LittleFS, "/script.js").setCacheControl("no-cache, no-store, must-revalidate");
   server.serveStatic("/style.css", LittleFS, "/style.css").setCacheControl("no-cache, no-store, must-revalidate");
   server.serveStatic("/components", LittleFS, "/components/").setCacheControl("no-cache, no-store, must-revalidate");
@@ -1103,38 +2173,99 @@ void setupWebServer() {
   server.serveStatic("/vendor", LittleFS, "/vendor/").setCacheControl("public, max-age=86400");
   server.serveStatic("/", LittleFS, "/").setCacheControl("public, max-age=86400");
 
-  // API endpoint for JSON data
-  server.on("/api/data", HTTP_GET, [](AsyncWebServerRequest *request) {
-    request->send(200, "application/json", generateJsonData());
+  // API endpoint for JSON data: served from the shared snapshot, 304 when the epoch is unchanged
+  routeMetrics.on(apiRouter, "/api/data", HTTP_GET, [](AsyncWebServerRequest *request) {
+    static AllocRouteStats *route = allocTraceRoute("/api/data");
+    AllocScope scope(route);
+    TelemetrySnapshot snap = currentTelemetrySnapshot();
+    if (!snap.full) { request->send(200, "application/json", generateJsonData()); return; }
+    // Epochs restart at every boot: the per-boot nonce keeps a client's old
+    // ETag from matching a different document after a reset
+    static const uint32_t bootNonce = esp_random();
+    char etag[32];
+    snprintf(etag, sizeof(etag), "\"t%08lx-%lu\"", (unsigned long)bootNonce, (unsigned long)snap.epoch);
+    const AsyncWebHeader *inm = request->getHeader("If-None-Match");
+    bool notModified = inm && strcmp(inm->value().c_str(), etag) == 0;
+    ArenaResponse *response = notModified ? ArenaResponse::empty(304)
+                                          : ArenaResponse::shared(200, "application/json", snap.full);
+    response->header("ETag", etag);
+    response->header("Cache-Control", "no-cache");
+    request->send(response);
+  });
+
+  // Persistent history: GET /api/history?from=<unix>&to=<unix>&step=<seconds>
+  // Streamed from the LittleFS segment log; only segments overlapping the range are opened.
+  routeMetrics.on(apiRouter, "/api/history", HTTP_GET, [](AsyncWebServerRequest *request) {
+    uint32_t now = (uint32_t)time(nullptr);
+    uint32_t to = request->hasParam("to") ? strtoul(request->getParam("to")->value().c_str(), nullptr, 10) : now;
+    uint32_t from = request->hasParam("from") ? strtoul(request->getParam("from")->value().c_str(), nullptr, 10)
+                                              : (to > 12UL * 3600UL ? to - 12UL * 3600UL : 0);
+    uint32_t step = request->hasParam("step") ? strtoul(request->getParam("step")->value().c_str(), nullptr, 10) : 60;
+    if (from > to) { request->send(400, "application/json", "{\"error\":\"invalid_range\"}"); return; }
+    auto cursor = std::make_shared<HistoryStore::Cursor>(historyStore, from, to, step, appSettings.units == "F");
+    AsyncWebServerResponse *response = request->beginChunkedResponse("application/json",
+      [cursor](uint8_t *buf, size_t maxLen, size_t index) -> size_t { return cursor->read(buf, maxLen); });
+    response->addHeader("Cache-Control", "no-store");
+    request->send(response);
+  });
+
+  // Multi-resolution rollups: GET /api/rollup?from=&to=|span=&points=
+  // Served from the coarsest PSRAM tier that still yields `points` buckets (default 200).
+  // from/to are unix seconds once SNTP has synced, otherwise uptime seconds.
+  routeMetrics.on(apiRouter, "/api/rollup", HTTP_GET, [](AsyncWebServerRequest *request) {
+    auto arg = [request](const char *name, int64_t def) -> int64_t {
+      return request->hasParam(name) ? strtoll(request->getParam(name)->value().c_str(), nullptr, 10) : def;
+    };
+    // Same clock as SensorSnapshot::uptimeSec: millis() is its low 32 bits
+    uint32_t upNow = (uint32_t)(esp_timer_get_time() / 1000000);
+    time_t wall = time(nullptr);
+    int64_t offset = (wall > 1600000000) ? (int64_t)wall - upNow : 0;
+    int64_t to = arg("to", upNow + offset) - offset;
+    int64_t from = request->hasParam("span") ? to - arg("span", 3600) : arg("from", to + offset - 3600) - offset;
+    to = constrain(to, (int64_t)0, (int64_t)upNow);
+    from = constrain(from, (int64_t)0, to);
+    uint32_t points = (uint32_t)constrain(arg("points", 200), (int64_t)1, (int64_t)2000);
+    int tier = rollups.selectTier((uint32_t)from, (uint32_t)to, upNow, points);
+    auto cursor = std::make_shared<RollupEngine::Cursor>(rollups, tier, (uint32_t)from, (uint32_t)to, offset, appSettings.units == "F");
+    AsyncWebServerResponse *response = request->beginChunkedResponse("application/json",
+      [cursor](uint8_t *buf, size_t maxLen, size_t index) -> size_t { return cursor->read(buf, maxLen); });
+    response->addHeader("Cache-Control", "no-store");
+    response->addHeader("X-Rollup-Clock", offset ? "unix" : "uptime");
+    request->send(response);
   });
 
   // WiFi status endpoint
-  server.on("/api/wifi/status", HTTP_GET, [](AsyncWebServerRequest *request) {
-    DynamicJsonDocument doc(512);
+  routeMetrics.on(apiRouter, "/api/wifi/status", HTTP_GET, [](AsyncWebServerRequest *request) {
+    static AllocRouteStats *route = allocTraceRoute("/api/wifi/status");
+    AllocScope scope(route);
+    StaticJsonDocument<384> doc;
     bool ap = (WiFi.getMode() == WIFI_AP);
     wl_status_t st = WiFi.status();
     const char* state = ap ? "ap" : (st == WL_CONNECTED ? "connected" : (wifiConnectPending ? "connecting" : "disconnected"));
+    IPAddress ip = ap ? WiFi.softAPIP() : WiFi.localIP();
+    char ipStr[16];
+    snprintf(ipStr, sizeof(ipStr), "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+    // Strings are stored by pointer: they are only read by serialization below
     doc["state"] = state;
-    doc["ssid"] = (st == WL_CONNECTED) ? selectedSSID : "";
-    doc["ip"] = ap ? WiFi.softAPIP().toString() : WiFi.localIP().toString();
+    doc["ssid"] = (st == WL_CONNECTED) ? selectedSSID.c_str() : "";
+    doc["ip"] = (const char*)ipStr;
     doc["rssi"] = (st == WL_CONNECTED) ? WiFi.RSSI() : 0;
-    doc["hostname"] = mdnsHostname;
+    doc["hostname"] = mdnsHostname.c_str();
     doc["ap"] = ap;
     doc["connecting"] = wifiConnectPending;
     doc["sta_status"] = (int)st;
     if (ap) {
-      doc["ap_ssid"] = ap_ssid_dyn;
+      doc["ap_ssid"] = ap_ssid_dyn.c_str();
       doc["captive"] = captivePortalActive;
     }
     // Scan status
     int sc = WiFi.scanComplete();
     if (sc == -1) doc["scan"] = "scanning"; else if (sc >= 0) doc["scan"] = "done"; else doc["scan"] = "idle";
-    String out; serializeJson(doc, out);
-    request->send(200, "application/json", out);
+    sendJson(request, doc);
   });
 
   // Detailed WiFi info (STA/AP details, MACs, DNS, gateway, subnet, BSSID, channel, tx power, sleep)
-  server.on("/api/wifi/info", HTTP_GET, [](AsyncWebServerRequest *request) {
+  routeMetrics.on(apiRouter, "/api/wifi/info", HTTP_GET, [](AsyncWebServerRequest *request) {
     DynamicJsonDocument doc(1024);
     bool ap = (WiFi.getMode() == WIFI_AP) || (WiFi.getMode() == WIFI_AP_STA);
     bool staEnabled = (WiFi.getMode() == WIFI_STA) || (WiFi.getMode() == WIFI_AP_STA);
@@ -1189,7 +2320,7 @@ void setupWebServer() {
   });
 
   // WiFi scan start (non-blocking)
-  server.on("/api/wifi/scan/start", HTTP_GET, [](AsyncWebServerRequest *request) {
+  routeMetrics.on(apiRouter, "/api/wifi/scan/start", HTTP_GET, [](AsyncWebServerRequest *request) {
     // If AP is active, keep it and add STA; otherwise just STA
     if (useAccessPoint) {
       WiFi.mode(WIFI_AP_STA);
@@ -1205,7 +2336,7 @@ void setupWebServer() {
   });
 
   // WiFi scan results
-  server.on("/api/wifi/scan/results", HTTP_GET, [](AsyncWebServerRequest *request) {
+  routeMetrics.on(apiRouter, "/api/wifi/scan/results", HTTP_GET, [](AsyncWebServerRequest *request) {
     DynamicJsonDocument doc(4096);
     int sc = WiFi.scanComplete();
     if (sc == -1) {
@@ -1229,7 +2360,7 @@ void setupWebServer() {
   });
 
   // WiFi connect endpoint (non-blocking start)
-  server.on("/api/wifi/connect", HTTP_POST, [](AsyncWebServerRequest *request){}, NULL, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+  routeMetrics.on(apiRouter, "/api/wifi/connect", HTTP_POST, [](AsyncWebServerRequest *request){}, NULL, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
     DynamicJsonDocument body(512);
     DeserializationError err = deserializeJson(body, data, len);
     if (err) { request->send(400, "application/json", "{\"error\":\"invalid_json\"}"); return; }
@@ -1256,19 +2387,19 @@ void setupWebServer() {
   });
 
   // WiFi reconnect
-  server.on("/api/wifi/reconnect", HTTP_POST, [](AsyncWebServerRequest *request){
+  routeMetrics.on(apiRouter, "/api/wifi/reconnect", HTTP_POST, [](AsyncWebServerRequest *request){
     bool ok = WiFi.reconnect();
     request->send(200, "application/json", String("{\"status\":\"") + (ok ? "ok" : "failed") + "\"}");
   });
 
   // WiFi disconnect
-  server.on("/api/wifi/disconnect", HTTP_POST, [](AsyncWebServerRequest *request){
+  routeMetrics.on(apiRouter, "/api/wifi/disconnect", HTTP_POST, [](AsyncWebServerRequest *request){
     WiFi.disconnect(true, true);
     request->send(200, "application/json", "{\"status\":\"ok\"}");
   });
 
   // Toggle AP mode (enable/disable AP alongside STA)
-  server.on("/api/wifi/toggle_ap", HTTP_POST, [](AsyncWebServerRequest *request){}, NULL, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total){
+  routeMetrics.on(apiRouter, "/api/wifi/toggle_ap", HTTP_POST, [](AsyncWebServerRequest *request){}, NULL, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total){
     DynamicJsonDocument body(512);
     if (deserializeJson(body, data, len)) { request->send(400, "application/json", "{\"error\":\"invalid_json\"}"); return; }
     bool enable = body["enable"].as<bool>();
@@ -1287,11 +2418,12 @@ void setupWebServer() {
       WiFi.softAPdisconnect(true);
       useAccessPoint = false;
     }
+    markSystemInfoDirty();
     DynamicJsonDocument resp(256); resp["status"] = "ok"; String out; serializeJson(resp, out); request->send(200, "application/json", out);
   });
 
   // TX power get
-  server.on("/api/wifi/txpower/get", HTTP_GET, [](AsyncWebServerRequest *request){
+  routeMetrics.on(apiRouter, "/api/wifi/txpower/get", HTTP_GET, [](AsyncWebServerRequest *request){
     auto txEnum = WiFi.getTxPower();
     auto enumToDbm = [](wifi_power_t p)->int{
       switch(p){
@@ -1309,11 +2441,11 @@ void setupWebServer() {
         default: return 0;
       }
     };
-    DynamicJsonDocument doc(128); doc["tx_power_dbm"] = enumToDbm(txEnum); String out; serializeJson(doc, out); request->send(200, "application/json", out);
+    StaticJsonDocument<64> doc; doc["tx_power_dbm"] = enumToDbm(txEnum); sendJson(request, doc);
   });
 
   // TX power set (expects integer enum value)
-  server.on("/api/wifi/txpower/set", HTTP_POST, [](AsyncWebServerRequest *request){}, NULL, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total){
+  routeMetrics.on(apiRouter, "/api/wifi/txpower/set", HTTP_POST, [](AsyncWebServerRequest *request){}, NULL, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total){
     DynamicJsonDocument body(128); if (deserializeJson(body, data, len)) { request->send(400, "application/json", "{\"error\":\"invalid_json\"}"); return; }
     int dbm = body["value"].as<int>();
     auto dbmToEnum = [](int d)->wifi_power_t{
@@ -1335,31 +2467,33 @@ void setupWebServer() {
   });
 
   // Sleep get/set
-  server.on("/api/wifi/sleep/get", HTTP_GET, [](AsyncWebServerRequest *request){ DynamicJsonDocument d(64); d["sleep"] = WiFi.getSleep(); String o; serializeJson(d,o); request->send(200, "application/json", o); });
-  server.on("/api/wifi/sleep/set", HTTP_POST, [](AsyncWebServerRequest *request){}, NULL, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total){
+  routeMetrics.on(apiRouter, "/api/wifi/sleep/get", HTTP_GET, [](AsyncWebServerRequest *request){ StaticJsonDocument<64> d; d["sleep"] = WiFi.getSleep(); sendJson(request, d); });
+  routeMetrics.on(apiRouter, "/api/wifi/sleep/set", HTTP_POST, [](AsyncWebServerRequest *request){}, NULL, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total){
     DynamicJsonDocument b(64); if (deserializeJson(b,data,len)) { request->send(400, "application/json", "{\"error\":\"invalid_json\"}"); return; }
     bool en = b["enable"].as<bool>(); WiFi.setSleep(en); request->send(200, "application/json", "{\"status\":\"ok\"}");
   });
 
   // Hostname set (also restarts mDNS)
-  server.on("/api/wifi/hostname/set", HTTP_POST, [](AsyncWebServerRequest *request){}, NULL, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total){
+  routeMetrics.on(apiRouter, "/api/wifi/hostname/set", HTTP_POST, [](AsyncWebServerRequest *request){}, NULL, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total){
     DynamicJsonDocument b(256); if (deserializeJson(b,data,len)) { request->send(400, "application/json", "{\"error\":\"invalid_json\"}"); return; }
     String hn = b["hostname"] | ""; if (hn.length()==0) { request->send(400, "application/json", "{\"error\":\"missing_hostname\"}"); return; }
     AppSettings ns = appSettings; ns.hostname = hn; saveAppSettings(ns); appSettings = ns; loadAppSettings();
   if (mdnsActive) { MDNS.end(); mdnsActive = false; }
   mdnsActive = MDNS.begin(mdnsHostname.c_str()); if (mdnsActive) { MDNS.addService("http","tcp",80); }
+    markSystemInfoDirty();
     request->send(200, "application/json", "{\"status\":\"ok\"}");
   });
 
   // mDNS restart
-  server.on("/api/wifi/mdns/restart", HTTP_POST, [](AsyncWebServerRequest *request){
+  routeMetrics.on(apiRouter, "/api/wifi/mdns/restart", HTTP_POST, [](AsyncWebServerRequest *request){
   if (mdnsActive) { MDNS.end(); mdnsActive = false; }
   bool ok = MDNS.begin(mdnsHostname.c_str()); if (ok) { MDNS.addService("http","tcp",80); mdnsActive = true; }
+    markSystemInfoDirty();
     request->send(200, "application/json", String("{\"status\":\"") + (ok?"ok":"failed") + "\"}");
   });
 
   // WiFi forget endpoint (clears saved credentials and restarts)
-  server.on("/api/wifi/forget", HTTP_POST, [](AsyncWebServerRequest *request){
+  routeMetrics.on(apiRouter, "/api/wifi/forget", HTTP_POST, [](AsyncWebServerRequest *request){
     preferences.begin("wifi", false);
     preferences.remove("ssid");
     preferences.remove("pass");
@@ -1376,12 +2510,12 @@ void setupWebServer() {
     // Always direct OS captive checks to root; root decides portal vs index
     request->send(200, "text/html", "<html><head><meta http-equiv='refresh' content='0; url=/'/></head><body>Redirecting...</body></html>");
   };
-  server.on("/generate_204", HTTP_GET, sendPortal);   // Android
-  server.on("/gen_204", HTTP_GET, sendPortal);         // Android alt
-  server.on("/hotspot-detect.html", HTTP_GET, sendPortal); // iOS/macOS
-  server.on("/ncsi.txt", HTTP_GET, sendPortal);        // Windows
-  server.on("/connecttest.txt", HTTP_GET, sendPortal); // Windows alt
-  server.on("/check_network_status.txt", HTTP_GET, sendPortal);
+  routeMetrics.on(server, "/generate_204", HTTP_GET, sendPortal);   // Android
+  routeMetrics.on(server, "/gen_204", HTTP_GET, sendPortal);         // Android alt
+  routeMetrics.on(server, "/hotspot-detect.html", HTTP_GET, sendPortal); // iOS/macOS
+  routeMetrics.on(server, "/ncsi.txt", HTTP_GET, sendPortal);        // Windows
+  routeMetrics.on(server, "/connecttest.txt", HTTP_GET, sendPortal); // Windows alt
+  routeMetrics.on(server, "/check_network_status.txt", HTTP_GET, sendPortal);
   
   // Handle 404: during captive portal, redirect everything to root (portal)
   server.onNotFound([](AsyncWebServerRequest *request) {
@@ -1391,13 +2525,9 @@ void setupWebServer() {
       request->send(404, "text/plain", "File not found");
     }
   });
-  
-  server.begin();
-  Serial.println("Web server started.");
-  Serial.println("Serving static files from LittleFS.");
 
   // Settings endpoints
-  server.on("/api/settings/get", HTTP_GET, [](AsyncWebServerRequest *request) {
+  routeMetrics.on(apiRouter, "/api/settings/get", HTTP_GET, [](AsyncWebServerRequest *request) {
     DynamicJsonDocument doc(1024);
     doc["hostname"] = appSettings.hostname;
     doc["units"] = appSettings.units;
@@ -1415,11 +2545,19 @@ void setupWebServer() {
     cam["available"] = cameraAvailable;
     cam["frameSize"] = appSettings.camFrameSize;
     cam["quality"] = appSettings.camQuality;
+    JsonObject flt = doc.createNestedObject("filter");
+    flt["decimation"] = appSettings.filtDecimation;
+    flt["median"] = appSettings.filtMedian;
+    flt["smoothing"] = appSettings.filtSmoothing;
+    flt["alpha"] = appSettings.filtAlpha;
+    flt["rateTemp"] = appSettings.filtRateTemp;
+    flt["rateHum"] = appSettings.filtRateHum;
+    flt["madK"] = appSettings.filtMadK;
     String out; serializeJson(doc, out);
     request->send(200, "application/json", out);
   });
 
-  server.on("/api/settings/save", HTTP_POST, [](AsyncWebServerRequest *request){}, NULL, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total){
+  routeMetrics.on(apiRouter, "/api/settings/save", HTTP_POST, [](AsyncWebServerRequest *request){}, NULL, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total){
     DynamicJsonDocument body(1024);
     DeserializationError err = deserializeJson(body, data, len);
     if (err) { request->send(400, "application/json", "{\"error\":\"invalid_json\"}"); return; }
@@ -1443,10 +2581,21 @@ void setupWebServer() {
       if (cam.containsKey("frameSize")) ns.camFrameSize = cam["frameSize"].as<int>();
       if (cam.containsKey("quality")) ns.camQuality = cam["quality"].as<int>();
     }
+    if (body.containsKey("filter")) {
+      JsonObject flt = body["filter"].as<JsonObject>();
+      if (flt.containsKey("decimation")) ns.filtDecimation = constrain(flt["decimation"].as<int>(), 1, 50);
+      if (flt.containsKey("median")) ns.filtMedian = constrain(flt["median"].as<int>(), 1, FILTER_MAX_WINDOW);
+      if (flt.containsKey("smoothing")) ns.filtSmoothing = constrain(flt["smoothing"].as<int>(), (int)FILTER_SMOOTH_NONE, (int)FILTER_SMOOTH_KALMAN);
+      if (flt.containsKey("alpha")) ns.filtAlpha = constrain(flt["alpha"].as<float>(), 0.01f, 1.0f);
+      if (flt.containsKey("rateTemp")) ns.filtRateTemp = max(0.0f, flt["rateTemp"].as<float>());
+      if (flt.containsKey("rateHum")) ns.filtRateHum = max(0.0f, flt["rateHum"].as<float>());
+      if (flt.containsKey("madK")) ns.filtMadK = max(0.0f, flt["madK"].as<float>());
+    }
     // Persist and apply
     saveAppSettings(ns);
     appSettings = ns;
     loadAppSettings();
+    markSystemInfoDirty();
     // If camera already up and settings changed, try to apply
     if (cameraAvailable) {
       sensor_t *s = esp_camera_sensor_get();
@@ -1462,71 +2611,97 @@ void setupWebServer() {
   });
 
   // System operations
-  server.on("/api/system/reboot", HTTP_POST, [](AsyncWebServerRequest *request){
+  routeMetrics.on(apiRouter, "/api/system/reboot", HTTP_POST, [](AsyncWebServerRequest *request){
     request->send(200, "application/json", "{\"status\":\"rebooting\"}");
     Serial.println("Reboot requested via API");
+    historyStore.flush(true);
     delay(200);
     ESP.restart();
   });
 
   // Camera endpoints
-  server.on("/api/camera/status", HTTP_GET, [](AsyncWebServerRequest *request){
-    DynamicJsonDocument doc(256);
+  routeMetrics.on(apiRouter, "/api/camera/status", HTTP_GET, [](AsyncWebServerRequest *request){
+    StaticJsonDocument<64> doc;
     doc["available"] = cameraAvailable;
-    String out; serializeJson(doc, out);
-    request->send(200, "application/json", out);
+    sendJson(request, doc);
   });
 
-  server.on("/api/camera/snapshot", HTTP_GET, [](AsyncWebServerRequest *request){
+  routeMetrics.on(apiRouter, "/api/camera/snapshot", HTTP_GET, [](AsyncWebServerRequest *request){
     if (!cameraAvailable) { request->send(503, "application/json", "{\"error\":\"camera_unavailable\"}"); return; }
-    if (cameraMutex) xSemaphoreTake(cameraMutex, portMAX_DELAY);
-    camera_fb_t *fb = esp_camera_fb_get();
-    if (!fb) { request->send(500, "application/json", "{\"error\":\"capture_failed\"}"); return; }
-  // Use non-deprecated response API
-  AsyncWebServerResponse *response = request->beginResponse(200, String("image/jpeg"), fb->buf, fb->len);
-    response->addHeader("Cache-Control", "no-store");
-    request->send(response);
-    esp_camera_fb_return(fb);
-    if (cameraMutex) xSemaphoreGive(cameraMutex);
+    sendRingFrame(request, frameRing, CAMERA_SNAPSHOT_MAX_AGE_MS, snapshotStats, "{\"error\":\"capture_failed\"}");
   });
 
-  server.on("/api/camera/stream", HTTP_GET, [](AsyncWebServerRequest *request){
+  // Downscaled frame (1/2, 1/4, 1/8), made once per capture by the camera task
+  routeMetrics.on(apiRouter, "/api/camera/thumb", HTTP_GET, [](AsyncWebServerRequest *request){
     if (!cameraAvailable) { request->send(503, "application/json", "{\"error\":\"camera_unavailable\"}"); return; }
-    AsyncJpegStreamResponse *response = new AsyncJpegStreamResponse();
-    response->addHeader("Cache-Control", "no-store, no-cache, must-revalidate, max-age=0");
-    response->addHeader("Pragma", "no-cache");
-    request->send(response);
+    int idx = CameraThumbs::indexFor(request->hasParam("scale") ? request->getParam("scale")->value().toInt() : 4);
+    if (idx < 0) { request->send(400, "application/json", "{\"error\":\"scale_must_be_2_4_or_8\"}"); return; }
+    sendRingFrame(request, cameraThumbs.ring(idx), CAMERA_THUMB_MAX_AGE_MS, thumbRequestStats[idx], "{\"error\":\"thumb_failed\"}");
+  });
+
+  routeMetrics.on(apiRouter, "/api/camera/stream", HTTP_GET, [](AsyncWebServerRequest *request){
+    if (!cameraAvailable) { request->send(503, "application/json", "{\"error\":\"camera_unavailable\"}"); return; }
+    // Each viewer pins up to STREAM_INFLIGHT_FRAMES ring slots; more viewers could starve the capture
+    bool full = true;
+    for (const auto *v : streamViewers) if (!v) full = false;
+    if (full) { request->send(503, "application/json", "{\"error\":\"too_many_viewers\"}"); return; }
+    uint8_t fps = request->hasParam("fps") ? constrain(request->getParam("fps")->value().toInt(), 1, STREAM_MAX_FPS) : 0;
+    uint16_t maxKbps = request->hasParam("maxkbps") ? constrain(request->getParam("maxkbps")->value().toInt(), 16, 60000) : 0;
+    request->send(new AsyncJpegStreamResponse(fps, maxKbps));
   });
 
-  server.on("/api/camera/restart", HTTP_POST, [](AsyncWebServerRequest *request){
+  routeMetrics.on(apiRouter, "/api/camera/restart", HTTP_POST, [](AsyncWebServerRequest *request){
     bool ok = true;
     if (cameraAvailable) {
-      if (cameraMutex) xSemaphoreTake(cameraMutex, portMAX_DELAY);
+      cameraLock();
       esp_camera_deinit();
       cameraAvailable = false;
       delay(100);
     }
     ok = initCamera();
-    if (cameraMutex) xSemaphoreGive(cameraMutex);
+    cameraUnlock();
     request->send(200, "application/json", String("{\"status\":\"") + (ok?"ok":"failed") + "\"}");
   });
 
   // Camera stream stats (global)
-  server.on("/api/camera/stream_stats", HTTP_GET, [](AsyncWebServerRequest *request){
-    DynamicJsonDocument doc(256);
+  routeMetrics.on(apiRouter, "/api/camera/stream_stats", HTTP_GET, [](AsyncWebServerRequest *request){
+    DynamicJsonDocument doc(4096);
     doc["frames"] = camStatFrames;
     doc["bytes"] = camStatBytes;
+    doc["skipped"] = camStatSkipped;
     doc["since"] = camStatStartMs;
     doc["now"] = millis();
-    String out; serializeJson(doc, out); request->send(200, "application/json", out);
+    FrameRingStats rs = frameRing.stats();
+    JsonObject cap = doc.createNestedObject("capture");
+    cap["active"] = rs.capturing;
+    cap["published"] = rs.published;
+    cap["dropped"] = rs.dropped;
+    cap["slots"] = FRAME_RING_SLOTS;
+    cap["slotBytes"] = rs.slotBytes;
+    cap["psram"] = rs.psram;
+    cap["qualityStep"] = camQualityStep;
+    fillSnapshotStatsJson(doc.createNestedObject("snapshot"), snapshotStats);
+    JsonArray thumbs = doc.createNestedArray("thumbs");
+    for (int i = 0; i < THUMB_SCALES; i++) {
+      JsonObject t = thumbs.createNestedObject();
+      ThumbStats ts = cameraThumbs.stats(i);
+      t["scale"] = 2 << i;
+      t["encoded"] = ts.encoded;
+      t["failed"] = ts.failed;
+      fillPercentilesJson(t.createNestedObject("encodeUs"), ts.encodeUs);
+      fillSnapshotStatsJson(t.createNestedObject("requests"), thumbRequestStats[i]);
+    }
+    JsonArray viewers = doc.createNestedArray("viewers");
+    for (const auto *v : streamViewers) if (v) v->fillJson(viewers.createNestedObject());
+    sendJson(request, doc);
   });
 
   // Camera controls: adjust common OV2640 parameters at runtime
-  server.on("/api/camera/ctrl", HTTP_POST, [](AsyncWebServerRequest *request){}, NULL, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total){
+  routeMetrics.on(apiRouter, "/api/camera/ctrl", HTTP_POST, [](AsyncWebServerRequest *request){}, NULL, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total){
     if (!cameraAvailable) { request->send(503, "application/json", "{\"error\":\"camera_unavailable\"}"); return; }
     DynamicJsonDocument body(512);
     if (deserializeJson(body, data, len)) { request->send(400, "application/json", "{\"error\":\"invalid_json\"}"); return; }
-    if (cameraMutex) xSemaphoreTake(cameraMutex, portMAX_DELAY);
+    cameraLock();
     sensor_t *s = esp_camera_sensor_get();
     bool ok = (s != nullptr);
     if (ok) {
@@ -1560,12 +2735,12 @@ void setupWebServer() {
       if (body.containsKey("special")) { s->set_special_effect(s, body["special"].as<int>()); }
       if (body.containsKey("colorbar")) { s->set_colorbar(s, body["colorbar"].as<bool>()); }
     }
-    if (cameraMutex) xSemaphoreGive(cameraMutex);
+    cameraUnlock();
     request->send(200, "application/json", ok ? "{\"status\":\"ok\"}" : "{\"status\":\"failed\"}");
   });
 
   // OTA: check latest release on GitHub (supports prereleases, returns FS availability)
-  server.on("/api/ota/check", HTTP_GET, [](AsyncWebServerRequest *request){
+  routeMetrics.on(apiRouter, "/api/ota/check", HTTP_GET, [](AsyncWebServerRequest *request){
     String tag, fwUrl, fsUrl, relPage, publishedAt;
     bool ok = getGithubLatest(tag, fwUrl, fsUrl, relPage, publishedAt);
     DynamicJsonDocument d(512);
@@ -1583,7 +2758,7 @@ void setupWebServer() {
     request->send(200, "application/json", o);
   });
   // OTA: apply update from latest release asset (firmware.bin)
-  server.on("/api/ota/update", HTTP_POST, [](AsyncWebServerRequest *request){
+  routeMetrics.on(apiRouter, "/api/ota/update", HTTP_POST, [](AsyncWebServerRequest *request){
     request->send(202, "application/json", "{\"status\":\"starting\"}");
     // Run OTA in a separate task to avoid blocking; start even for empty POST bodies
     xTaskCreate([](void*){
@@ -1591,10 +2766,10 @@ void setupWebServer() {
       if (otaLogMutex) { xSemaphoreTake(otaLogMutex, portMAX_DELAY); otaLogStart=0; otaLogCount=0; xSemaphoreGive(otaLogMutex); }
   otaLog("Firmware OTA: starting");
   setOtaState("starting", 0);
-      if (otaInProgress) { otaLog("Firmware OTA: already in progress"); vTaskDelete(NULL); return; }
+      if (otaInProgress) { otaLog("Firmware OTA: already in progress"); otaTaskEnd(); return; }
       String tag, fwUrl, fsUrl, relPage, publishedAt, msg;
       bool ok = getGithubLatest(tag, fwUrl, fsUrl, relPage, publishedAt);
-      if (!ok) { otaLog("Firmware OTA: failed to query GitHub"); vTaskDelete(NULL); return; }
+      if (!ok) { otaLog("Firmware OTA: failed to query GitHub"); otaTaskEnd(); return; }
       if (semverCompare(fwVersion, tag) < 0 && fwUrl.length()) {
         if (applyOtaFromUrl(fwUrl, msg)) {
           // Persist effective installed version (normalize to drop leading 'v')
@@ -1610,22 +2785,22 @@ void setupWebServer() {
       } else {
         otaLog("Firmware OTA: already up to date");
       }
-      vTaskDelete(NULL);
+      otaTaskEnd();
     }, "ota_task", 8192, nullptr, 1, nullptr);
   });
 
   // OTA: update filesystem (LittleFS) from latest release asset when available
-  server.on("/api/ota/updatefs", HTTP_POST, [](AsyncWebServerRequest *request){
+  routeMetrics.on(apiRouter, "/api/ota/updatefs", HTTP_POST, [](AsyncWebServerRequest *request){
     request->send(202, "application/json", "{\"status\":\"starting\"}");
     xTaskCreate([](void*){
       if (!otaLogMutex) otaLogMutex = xSemaphoreCreateMutex();
       if (otaLogMutex) { xSemaphoreTake(otaLogMutex, portMAX_DELAY); otaLogStart=0; otaLogCount=0; xSemaphoreGive(otaLogMutex); }
   otaLog("FS OTA: starting");
   setOtaState("starting", 0);
-      if (otaInProgress) { otaLog("FS OTA: already in progress"); vTaskDelete(NULL); return; }
+      if (otaInProgress) { otaLog("FS OTA: already in progress"); otaTaskEnd(); return; }
       String tag, fwUrl, fsUrl, relPage, publishedAt, msg;
       bool ok = getGithubLatest(tag, fwUrl, fsUrl, relPage, publishedAt);
-      if (!ok) { otaLog("FS OTA: failed to query GitHub"); vTaskDelete(NULL); return; }
+      if (!ok) { otaLog("FS OTA: failed to query GitHub"); otaTaskEnd(); return; }
       if (fsUrl.length()) {
         if (applyFsOtaFromUrl(fsUrl, msg)) {
           otaLog("FS OTA: rebooting");
@@ -1638,22 +2813,22 @@ void setupWebServer() {
       } else {
         otaLog("FS OTA: no filesystem asset in latest release");
       }
-      vTaskDelete(NULL);
+      otaTaskEnd();
     }, "ota_fs_task", 8192, nullptr, 1, nullptr);
   });
 
   // OTA: apply firmware first, then filesystem if available, then restart once
-  server.on("/api/ota/update_all", HTTP_POST, [](AsyncWebServerRequest *request){
+  routeMetrics.on(apiRouter, "/api/ota/update_all", HTTP_POST, [](AsyncWebServerRequest *request){
     request->send(202, "application/json", "{\"status\":\"starting\"}");
     xTaskCreate([](void*){
       if (!otaLogMutex) otaLogMutex = xSemaphoreCreateMutex();
       if (otaLogMutex) { xSemaphoreTake(otaLogMutex, portMAX_DELAY); otaLogStart=0; otaLogCount=0; xSemaphoreGive(otaLogMutex); }
   otaLog("UpdateAll: starting");
   setOtaState("starting", 0);
-      if (otaInProgress) { otaLog("UpdateAll: already in progress"); vTaskDelete(NULL); return; }
+      if (otaInProgress) { otaLog("UpdateAll: already in progress"); otaTaskEnd(); return; }
       String tag, fwUrl, fsUrl, relPage, publishedAt, msg;
       bool ok = getGithubLatest(tag, fwUrl, fsUrl, relPage, publishedAt);
-      if (!ok) { otaLog("UpdateAll: failed to query GitHub"); vTaskDelete(NULL); return; }
+      if (!ok) { otaLog("UpdateAll: failed to query GitHub"); otaTaskEnd(); return; }
       bool didSomething = false;
       // 1) Firmware update if newer
       if (semverCompare(fwVersion, tag) < 0 && fwUrl.length()) {
@@ -1688,12 +2863,12 @@ void setupWebServer() {
       } else {
         otaLog("UpdateAll: nothing to do");
       }
-      vTaskDelete(NULL);
+      otaTaskEnd();
     }, "ota_all_task", 12288, nullptr, 1, nullptr);
   });
 
   // OTA logs endpoint: returns recent log lines
-  server.on("/api/ota/log", HTTP_GET, [](AsyncWebServerRequest *request){
+  routeMetrics.on(apiRouter, "/api/ota/log", HTTP_GET, [](AsyncWebServerRequest *request){
     DynamicJsonDocument d(4096);
     JsonArray a = d.createNestedArray("lines");
     if (otaLogMutex) xSemaphoreTake(otaLogMutex, portMAX_DELAY);
@@ -1707,21 +2882,136 @@ void setupWebServer() {
   });
 
   // OTA state endpoint for driving UI progress/messaging
-  server.on("/api/ota/state", HTTP_GET, [](AsyncWebServerRequest *request){
-    DynamicJsonDocument d(256);
+  routeMetrics.on(apiRouter, "/api/ota/state", HTTP_GET, [](AsyncWebServerRequest *request){
+    static AllocRouteStats *route = allocTraceRoute("/api/ota/state");
+    AllocScope scope(route);
+    StaticJsonDocument<192> d;
+    // Copy the strings out under the lock; the OTA task may reassign them afterwards
+    char phase[16], err[96];
     if (otaStateMutex) xSemaphoreTake(otaStateMutex, portMAX_DELAY);
-    d["phase"] = otaPhase;
+    strlcpy(phase, otaPhase.c_str(), sizeof(phase));
+    strlcpy(err, (otaPhase == "error") ? otaErrorMsg.c_str() : "", sizeof(err));
     d["percent"] = otaPct;
     d["since"] = otaStartMs;
     d["inProgress"] = otaInProgress;
-    if (otaPhase == "error" && otaErrorMsg.length()) d["error"] = otaErrorMsg;
     if (otaStateMutex) xSemaphoreGive(otaStateMutex);
-    String out; serializeJson(d, out);
-    request->send(200, "application/json", out);
+    d["phase"] = (const char*)phase;
+    if (err[0]) d["error"] = (const char*)err;
+    sendJson(request, d);
+  });
+
+  // Heap calls per request on the traced routes (counting needs REPTIMON_ALLOC_TRACE)
+  routeMetrics.on(apiRouter, "/api/alloc", HTTP_GET, [](AsyncWebServerRequest *request){
+    AllocRouteStats routes[ALLOC_TRACE_ROUTES];
+    size_t n = allocTraceRoutes(routes, ALLOC_TRACE_ROUTES);
+    StaticJsonDocument<1536> d;
+    d["tracing"] = allocTraceEnabled();
+    d["poolHits"] = ArenaResponse::poolHits();
+    d["poolMisses"] = ArenaResponse::poolMisses();
+    JsonArray arr = d.createNestedArray("routes");
+    for (size_t i = 0; i < n; i++) {
+      JsonObject r = arr.createNestedObject();
+      r["path"] = routes[i].path;
+      r["requests"] = routes[i].requests;
+      r["allocs"] = routes[i].allocs;
+      r["last"] = routes[i].last;
+      r["max"] = routes[i].max;
+    }
+    sendJson(request, d);
+  });
+
+  // Sensor cadence: period/jitter/poll histograms and per-channel driver counters
+  routeMetrics.on(apiRouter, "/api/sensor/timing", HTTP_GET, [](AsyncWebServerRequest *request){
+    SensorTiming t;
+    portENTER_CRITICAL(&sensorTimingMux);
+    t = sensorTiming;
+    portEXIT_CRITICAL(&sensorTimingMux);
+    StaticJsonDocument<4096> d;
+    d["nominalMs"] = SENSOR_UPDATE_INTERVAL_MS;
+    d["state"] = (int)sht30.device().state();
+    fillLinearJson(d.createNestedObject("periodUs"), t.periodUs);
+    fillLog2Json(d.createNestedObject("jitterUs"), t.jitterUs);
+    fillLog2Json(d.createNestedObject("fetchUs"), t.fetchUs);
+    d["overruns"] = t.overruns;
+    // Counters are plain words written by sensorTask; a torn read is off by one at worst
+    JsonArray chs = d.createNestedArray("channels");
+    for (int i = 0; i < sensorHub.count(); i++) {
+      const SensorChannel &hc = sensorHub.channel(i);
+      SensorDriverCounters c = hc.driver->counters();
+      char addr[20];
+      hc.driver->address(addr, sizeof(addr));
+      JsonObject o = chs.createNestedObject();
+      o["id"] = (const char*)hc.id;
+      o["kind"] = hc.driver->kind();
+      o["address"] = addr;
+      o["ok"] = c.ok;
+      o["notReady"] = c.notReady;
+      o["errors"] = c.errors;
+      o["restarts"] = c.restarts;
+      o["tempRejectedRate"] = hc.tempFilter.rejectedRate();
+      o["tempRejectedMad"] = hc.tempFilter.rejectedMad();
+      if (hc.driver->hasHumidity()) {
+        o["humRejectedRate"] = hc.humFilter.rejectedRate();
+        o["humRejectedMad"] = hc.humFilter.rejectedMad();
+      }
+    }
+    sendJson(request, d);
+  });
+
+  // Task profile: CPU share per task/core over the last sample interval, stack
+  // headroom, sensor cadence, camera lock waits and sensor queue pressure
+  routeMetrics.on(apiRouter, "/api/perf", HTTP_GET, [](AsyncWebServerRequest *request){
+    static PerfSample ps;   // only the async_tcp task runs handlers
+    perfMonitor.read(ps);
+    DynamicJsonDocument d(PERF_JSON_CAPACITY);
+    fillPerfJson(d, ps);
+    sendJson(request, d);
+  });
+
+  // Prometheus/OpenMetrics scrape target, written line by line into the chunked response
+  routeMetrics.on(apiRouter, "/metrics", HTTP_GET, [](AsyncWebServerRequest *request){
+    auto scrape = std::make_shared<MetricsScrape>();
+    AsyncWebServerResponse *response = request->beginChunkedResponse(
+      "application/openmetrics-text; version=1.0.0; charset=utf-8",
+      [scrape](uint8_t *buf, size_t maxLen, size_t index) -> size_t { return scrape->cursor.read(buf, maxLen); });
+    response->addHeader("Cache-Control", "no-store");
+    request->send(response);
+  });
+
+  // Per-route handler/close latency, status classes, bytes out and concurrency,
+  // slowest handler p99 first
+  routeMetrics.on(apiRouter, "/api/routes", HTTP_GET, [](AsyncWebServerRequest *request){
+    uint8_t order[ROUTE_METRICS_MAX];
+    int n = routeMetrics.count();
+    for (int i = 0; i < n; i++) {
+      int j = i;
+      uint32_t p = routeMetrics.route(i).handlerUs.percentile(99);
+      for (; j > 0 && routeMetrics.route(order[j - 1]).handlerUs.percentile(99) < p; j--) order[j] = order[j - 1];
+      order[j] = (uint8_t)i;
+    }
+    DynamicJsonDocument d(ROUTES_JSON_CAPACITY);
+    d["memoryBytes"] = routeMetrics.memoryBytes();
+    d["psram"] = routeMetrics.inPsram();
+    JsonArray arr = d.createNestedArray("routes");
+    for (int k = 0; k < n; k++) {
+      const RouteStats &r = routeMetrics.route(order[k]);
+      JsonObject o = arr.createNestedObject();
+      o["path"] = r.path;
+      o["method"] = r.method;
+      o["requests"] = r.requests;
+      o["inFlight"] = r.inFlight;
+      o["peakInFlight"] = r.peakInFlight;
+      o["bytesOut"] = r.bytesOut;
+      JsonArray st = o.createNestedArray("status");
+      for (uint32_t c : r.status) st.add(c);
+      fillPercentilesJson(o.createNestedObject("handlerUs"), r.handlerUs);
+      fillPercentilesJson(o.createNestedObject("totalUs"), r.totalUs);
+    }
+    sendJson(request, d);
   });
 
   // Full-resolution snapshot with graceful fallback and restoration
-  server.on("/api/camera/snapshot_full", HTTP_GET, [](AsyncWebServerRequest *request){
+  routeMetrics.on(apiRouter, "/api/camera/snapshot_full", HTTP_GET, [](AsyncWebServerRequest *request){
     if (!cameraAvailable) { request->send(503, "application/json", "{\"error\":\"camera_unavailable\"}"); return; }
     int q = 12; // high quality (lower is better)
     if (request->hasParam("q")) {
@@ -1731,7 +3021,7 @@ void setupWebServer() {
     int target = -1;
     if (request->hasParam("size")) { target = request->getParam("size")->value().toInt(); }
 
-    if (cameraMutex) xSemaphoreTake(cameraMutex, portMAX_DELAY);
+    cameraLock();
     sensor_t *s = esp_camera_sensor_get();
     framesize_t prevFS = (framesize_t)appSettings.camFrameSize;
     int prevQ = appSettings.camQuality;
@@ -1771,67 +3061,183 @@ void setupWebServer() {
     } else {
       request->send(500, "application/json", "{\"error\":\"no_sensor\"}");
     }
-    if (cameraMutex) xSemaphoreGive(cameraMutex);
+    cameraUnlock();
   });
+
+  Serial.printf("API router: %d routes, %d trie nodes\n", apiRouter.routeCount(), apiRouter.nodeCount());
+  server.begin();
+  Serial.println("Web server started.");
+  Serial.println("Serving static files from LittleFS.");
 }
 
 // Web task for sending periodic updates
 void webTask(void *parameter) {
-  const TickType_t xDelay = pdMS_TO_TICKS(1000); // 1 second updates
+  const TickType_t xDelay = pdMS_TO_TICKS(TELEMETRY_BIN_INTERVAL_MS);
+  unsigned long lastJsonPush = 0;
+  uint32_t lastBinarySeq = 0;
+  uint32_t lastJsonEpoch = 0;
+  uint32_t ids[WS_MAX_CLIENTS];
+  unsigned long lastPerf = 0;
+  unsigned long perfSensorBase = 0, perfDisplayBase = 0;
+  static PerfSample perfSample;   // too large for this stack alongside the JSON documents
   
   for(;;) {
+    // Persist batched history records (no-op until a batch is due)
+    historyStore.flush();
+
+    // Task profile: sampled here so /api/perf always reads a complete interval
+    if (millis() - lastPerf >= PERF_SAMPLE_INTERVAL_MS) {
+      unsigned long now = millis();
+      if (lastPerf) {
+        perfSensorHz = (sensorReadCount - perfSensorBase) * 1000.0f / (now - lastPerf);
+        perfDisplayHz = (displayUpdateCount - perfDisplayBase) * 1000.0f / (now - lastPerf);
+      }
+      perfSensorBase = sensorReadCount;
+      perfDisplayBase = displayUpdateCount;
+      lastPerf = now;
+      perfMonitor.sample();
+
+      int nPerf = wsPerfClientIds(ids);
+      if (nPerf > 0) {
+        perfMonitor.read(perfSample);
+        DynamicJsonDocument doc(PERF_JSON_CAPACITY);
+        doc["type"] = "perf";
+        fillPerfJson(doc, perfSample);
+        AsyncWebSocketSharedBuffer buf = serializeShared(doc);
+        for (int i = 0; i < nPerf; i++) {
+          AsyncWebSocketClient *c = ws.client(ids[i]);
+          if (c) c->text(buf);
+        }
+      }
+    }
+
+    // Cold system frame: rebuilt on a slow cadence, pushed to every client only when it changed
+    if (refreshSystemInfo(false) && ws.count() > 0) {
+      ws.textAll(getSystemInfoJson());
+    }
+
+    // One serialization per epoch, shared by /api/data and WebSocket JSON clients
+    bool jsonDue = (millis() - lastJsonPush >= TELEMETRY_JSON_INTERVAL_MS);
+    if (jsonDue) {
+      lastJsonPush = millis();
+      publishTelemetrySnapshot();
+    }
+
     if (WiFi.status() == WL_CONNECTED) {
-      // Send data to all connected WebSocket clients
-      String jsonData = generateJsonData();
-      if (jsonData != lastJsonData && ws.count() > 0) {
-        ws.textAll(jsonData);
-        lastJsonData = jsonData;
+      // Binary clients: compact live frame at TELEMETRY_BIN_INTERVAL_MS, only when a new sample exists
+      int nBin = wsClientIds(true, ids);
+      if (nBin > 0 && sensorState.sequence() != lastBinarySeq) {
+        uint8_t frame[sizeof(TelemetryLiveFrame) + SENSOR_MAX_CHANNELS * sizeof(TelemetryChannelEntry)];
+        size_t frameLen = buildLiveFrame(frame, sizeof(frame));
+        AsyncWebSocketSharedBuffer bin = std::make_shared<std::vector<uint8_t>>(frame, frame + frameLen);
+        for (int i = 0; i < nBin; i++) {
+          AsyncWebSocketClient *c = ws.client(ids[i]);
+          if (c) c->binary(bin);
+        }
+        lastBinarySeq = ((const TelemetryLiveFrame*)frame)->seq;
         lastWebUpdate = millis();
       }
+      // JSON clients: live frame at 1 Hz, same buffer for every client
+      if (jsonDue) {
+        TelemetrySnapshot snap = currentTelemetrySnapshot();
+        int nJson = wsClientIds(false, ids);
+        if (nJson > 0 && snap.live && snap.epoch != lastJsonEpoch) {
+          for (int i = 0; i < nJson; i++) {
+            AsyncWebSocketClient *c = ws.client(ids[i]);
+            if (c) c->text(snap.live);
+          }
+          lastJsonEpoch = snap.epoch;
+          lastWebUpdate = millis();
+        }
+      }
     }
     
     vTaskDelay(xDelay);
   }
 }
 
-// Sensor reading task - Ultra-high frequency with optimized I2C
+static void configureSensorFilters() {
+  FilterConfig temp;
+  temp.decimation = (uint8_t)appSettings.filtDecimation;
+  temp.median = (uint8_t)appSettings.filtMedian;
+  temp.smoothing = (uint8_t)appSettings.filtSmoothing;
+  temp.emaAlpha = appSettings.filtAlpha;
+  temp.madK = appSettings.filtMadK;
+  temp.maxRate = appSettings.filtRateTemp;
+  FilterConfig hum = temp;
+  hum.maxRate = appSettings.filtRateHum;
+  hum.kalmanR = 0.25f;  // SHT3x RH noise is roughly 5x the temperature noise
+  sensorHub.configureFilters(temp, hum);
+}
+
+// Sensor reading task: fixed cadence via vTaskDelayUntil. All channels are
+// polled in one batch per cycle; sensors convert on their own (SHT3x periodic
+// mode, DS18B20 broadcast conversion), so a cycle is only short bus transfers.
 void sensorTask(void *parameter) {
-  const TickType_t xDelay = pdMS_TO_TICKS(SENSOR_UPDATE_INTERVAL_MS);
+  const TickType_t period = pdMS_TO_TICKS(SENSOR_UPDATE_INTERVAL_MS);
+  const int32_t nominalUs = SENSOR_UPDATE_INTERVAL_MS * 1000;
+  portENTER_CRITICAL(&sensorTimingMux);
+  sensorTiming.periodUs.resetCentered(nominalUs, 1000);
+  portEXIT_CRITICAL(&sensorTimingMux);
+  TickType_t lastWake = xTaskGetTickCount();
+  uint32_t prevWakeUs = 0;
+  uint32_t filterConfigSeen = 0;
   
   for(;;) {
-    unsigned long startTime = micros();
+    vTaskDelayUntil(&lastWake, period);
+    uint32_t wakeUs = micros();
+    // Filters and buses work in millis(): micros()/1000 wraps every ~71.6 min
+    uint32_t wakeMs = millis();
     
-    if (sht30.read()) {
-      EnvironmentData newData;
-      newData.temperature = sht30.getTemperature();
-      newData.humidity = sht30.getHumidity();
-      newData.dewPoint = calculateDewPoint(newData.temperature, newData.humidity);
-      newData.heatIndex = calculateHeatIndex(newData.temperature, newData.humidity);
-      newData.vaporPressureDeficit = calculateVPD(newData.temperature, newData.humidity);
-      newData.absoluteHumidity = calculateAbsoluteHumidity(newData.temperature, newData.humidity);
-      newData.timestamp = millis();
-      newData.valid = true;
-      
-      // Lock-free atomic update
-      memcpy((void*)&currentData, &newData, sizeof(EnvironmentData));
+    if (filterConfigSeen != filterConfigVersion) {
+      filterConfigSeen = filterConfigVersion;
+      configureSensorFilters();
+    }
+    float temp[SENSOR_MAX_CHANNELS], hum[SENSOR_MAX_CHANNELS];
+    uint32_t ready = sensorHub.poll(wakeMs, SENSOR_RETRY_MS, temp, hum);
+    uint32_t fetchUs = micros() - wakeUs;
+    
+    portENTER_CRITICAL(&sensorTimingMux);
+    if (prevWakeUs) {
+      int32_t periodUs = (int32_t)(wakeUs - prevWakeUs);
+      int32_t dev = periodUs - nominalUs;
+      sensorTiming.periodUs.add(periodUs);
+      sensorTiming.jitterUs.add(dev < 0 ? -dev : dev);
+      if (dev > nominalUs) sensorTiming.overruns++;
+    }
+    sensorTiming.fetchUs.add(fetchUs);
+    portEXIT_CRITICAL(&sensorTimingMux);
+    prevWakeUs = wakeUs;
+    
+    if (!ready) continue;
+    
+    // Derive metrics and update statistics for every channel with a new sample,
+    // then publish all channels as one snapshot
+    const SensorSnapshot &snap = sensorPipeline.process(ready, temp, hum, millis());
+    sensorState.publish(snap);
+    
+    if (ready & 1u) {
+      const EnvironmentData &newData = snap.channels[0].data;
       
       // Store in ring buffer for history
       readings[readingIndex] = newData;
       readingIndex = (readingIndex + 1) % 32;
       
-      // Update statistics atomically
-      updateStatisticsAtomic(newData.temperature, newData.humidity, newData.dewPoint);
+      // Long-term history (averaged in RAM, written to flash in batches by webTask)
+      historyStore.addSample((uint32_t)time(nullptr), newData.temperature, newData.humidity);
+      // Rollup pyramid for zoomed-out chart queries (O(1) per sample)
+      rollups.add(snap.uptimeSec, newData.temperature, newData.humidity);
       
       sensorReadCount++;
       lastSensorRead = millis();
       
       // Send to queue for display task
       if (sensorDataQueue != NULL) {
-        xQueueSend(sensorDataQueue, &newData, 0);
+        if (xQueueSend(sensorDataQueue, &newData, 0) != pdTRUE) sensorQueueDrops++;
+        uint32_t depth = uxQueueMessagesWaiting(sensorDataQueue);
+        if (depth > sensorQueuePeak) sensorQueuePeak = depth;
       }
     }
-    
-    vTaskDelay(xDelay);
   }
 }
 
@@ -1857,9 +3263,12 @@ void displayTask(void *parameter) {
 void ledTask(void *parameter) {
   const TickType_t xDelay = pdMS_TO_TICKS(100); // 10Hz LED updates
   
+  static SensorSnapshot snap;  // ~1 KB: keep it off this task's small stack
   for(;;) {
-    if (currentData.valid) {
-      updateLEDStatusFast(currentData.temperature, currentData.humidity);
+    sensorState.read(snap);
+    const EnvironmentData &primary = snap.channels[0].data;
+    if (primary.valid) {
+      updateLEDStatusFast(primary.temperature, primary.humidity);
     }
     
     vTaskDelay(xDelay);
@@ -1891,8 +3300,9 @@ void setup() {
   Wire.begin(5, 6);
   Wire.setClock(I2C_CLOCK_SPEED);
   
-  // Initialize SHT30 sensor
-  if (sht30.begin()) {
+  // Initialize SHT30 sensor in periodic mode (10 measurements/s)
+  if (sht30.begin(Wire, SHT3X_PERIODIC_10MPS_HIGH)) {
+    sensorHub.add("sht1", &sht30);
   Serial.println("SHT30 sensor initialized successfully");
   } else {
   Serial.println("SHT30 sensor initialization failed!");
@@ -1903,6 +3313,21 @@ void setup() {
       delay(500);
     }
   }
+  // Optional extra channels: second SHT3x (ADDR pin high) and DS18B20 probes on D3
+  if (sht30b.begin(Wire, SHT3X_PERIODIC_10MPS_HIGH)) {
+    sensorHub.add("sht2", &sht30b);
+    Serial.println("Second SHT30 at 0x45 initialized");
+  }
+  uint8_t probes = probeBus.begin(11);
+  for (uint8_t i = 0; i < probes; i++) {
+    char id[12];
+    snprintf(id, sizeof(id), "ds%u", (unsigned)(i + 1));
+    if (sensorHub.add(id, new Ds18b20Probe(probeBus, i)) < 0) break;
+  }
+  if (probes) {
+    sensorHub.setBus(&probeBus);
+    Serial.printf("DS18B20: %u probe(s) on GPIO%d\n", (unsigned)probes, ONEWIRE_PIN);
+  }
   
   // Setup WiFi
   // Improve WiFi stability for AP and STA
@@ -1912,18 +3337,33 @@ void setup() {
 
   // Initialize camera (best-effort)
   initCamera();
-  camStatFrames = 0; camStatBytes = 0; camStatStartMs = millis();
+  camStatFrames = 0; camStatBytes = 0; camStatSkipped = 0; camStatStartMs = millis();
+  if (!frameRing.begin() || !cameraThumbs.begin()) Serial.println("Frame ring allocation failed");
   // Create camera mutex
   cameraMutex = xSemaphoreCreateMutex();
   
   // Setup web server
   setupWebServer();
+  // Cold telemetry: read once now, then refreshed on a slow cadence by webTask
+  initStaticSystemInfo();
+  refreshSystemInfo(true);
   
+  // Rollup tiers (PSRAM); must exist before sensorTask starts feeding them
+  if (rollups.begin()) {
+    Serial.printf("Rollups: %u bytes in %s\n", (unsigned)rollups.memoryBytes(), rollups.inPsram() ? "PSRAM" : "heap");
+  } else {
+    Serial.println("Rollups: allocation failed");
+  }
+  if (!sensorPipeline.begin(sensorHub, SENSOR_PSYCHRO_MODE)) {
+    Serial.println("Rolling stats: allocation failed");
+  }
+  Serial.printf("Rolling stats: %d channels, %u bytes in %s\n", sensorHub.count(),
+                (unsigned)sensorPipeline.statsBytes(), sensorPipeline.statsInPsram() ? "PSRAM" : "heap");
+
   // Create FreeRTOS synchronization objects
-  sensorDataQueue = xQueueCreate(16, sizeof(EnvironmentData));
-  dataMutex = xSemaphoreCreateMutex();
+  sensorDataQueue = xQueueCreate(SENSOR_QUEUE_LENGTH, sizeof(EnvironmentData));
   
-  if (sensorDataQueue == NULL || dataMutex == NULL) {
+  if (sensorDataQueue == NULL) {
   Serial.println("Failed to create FreeRTOS objects!");
     while(1);
   }
@@ -1968,6 +3408,20 @@ void setup() {
     &webTaskHandle,       // Task handle
     0                     // Core 0
   );
+  xTaskCreatePinnedToCore(
+    cameraTask,           // Task function
+    "CameraTask",         // Task name
+    8192,                 // Stack size (JPEG decode/encode for thumbnails)
+    NULL,                 // Parameters
+    2,                    // Priority (medium)
+    &cameraTaskHandle,    // Task handle
+    1                     // Core 1
+  );
+  perfMonitor.track(sensorTaskHandle);
+  perfMonitor.track(displayTaskHandle);
+  perfMonitor.track(ledTaskHandle);
+  perfMonitor.track(webTaskHandle);
+  perfMonitor.track(cameraTaskHandle);
   
   Serial.printf("CPU Frequency: %d MHz\n", getCpuFrequencyMhz());
   Serial.printf("Free heap: %d bytes\n", ESP.getFreeHeap());
@@ -1994,6 +3448,8 @@ void loop() {
                     sensorReadCount * 1000.0f / millis());
       Serial.printf("Display updates: %lu (%.1fHz)\n", displayUpdateCount,
                     displayUpdateCount * 1000.0f / millis());
+      Serial.printf("Snapshot seq: %lu (read retries: %lu)\n", (unsigned long)sensorState.sequence(),
+                    (unsigned long)sensorState.retries());
       Serial.printf("Free heap: %d bytes\n", ESP.getFreeHeap());
       Serial.printf("Min free heap: %d bytes\n", ESP.getMinFreeHeap());
       Serial.printf("CPU frequency: %d MHz\n", getCpuFrequencyMhz());
@@ -2002,7 +3458,15 @@ void loop() {
       Serial.printf("WebSocket clients: %d\n", ws.count());
       Serial.println("===================================================================\n");
     }
+    else if (command == "bench") {
+      PsychroBenchResult b = psychroBench();
+      Serial.printf("Psychrometrics (%lu samples): exact %.0f ns, fast %.0f ns per sample\n",
+                    (unsigned long)b.samples, b.exactNs, b.fastNs);
+      Serial.printf("Fast path max error: %.2e relative (es/ea/vpd/ah), %.2e C dew point\n",
+                    b.maxRelErr, b.maxDewErr);
+    }
     else if (command == "reset") {
+      historyStore.flush(true);
       ESP.restart();
     }
     else if (command == "wifi") {
@@ -2017,6 +3481,7 @@ void loop() {
     else if (command == "help") {
   Serial.println("\nAVAILABLE COMMANDS:");
       Serial.println("stats  - Show performance statistics");
+      Serial.println("bench  - Benchmark psychrometrics kernel (exact vs fast)");
       Serial.println("wifi   - Show WiFi information");
       Serial.println("scan   - Scan for WiFi networks");
       Serial.println("reset  - Restart the system");
@@ -2058,6 +3523,7 @@ void loop() {
         WiFi.softAPdisconnect(true);
         useAccessPoint = false;
       }
+      startTimeSync();
       // Start mDNS for LAN discovery
       mdnsActive = MDNS.begin(mdnsHostname.c_str());
       if (!mdnsActive) {
@@ -2066,6 +3532,7 @@ void loop() {
         MDNS.addService("http", "tcp", 80);
         Serial.printf("mDNS active: http://%s.local\n", mdnsHostname.c_str());
       }
+      markSystemInfoDirty();
       Serial.println("WiFi connected (non-blocking flow)");
   } else if (millis() - wifiConnectStart > 25000) { // timeout
       wifiConnectPending = false;
@@ -2084,6 +3551,7 @@ void loop() {
       doc["ap_ip"] = WiFi.softAPIP().toString();
       String msg; serializeJson(doc, msg);
       ws.textAll(msg);
+      markSystemInfoDirty();
   Serial.println("WiFi connect timeout; reverted to AP");
     }
   }
@@ -0,0 +1,78 @@
+#include "metrics_writer.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+static const char *typeName(MetricType t) {
+  switch (t) {
+    case METRIC_COUNTER:  return "counter";
+    case METRIC_STATESET: return "stateset";
+    case METRIC_INFO:     return "info";
+    default:              return "gauge";
+  }
+}
+
+static const char *sampleSuffix(MetricType t) {
+  return t == METRIC_COUNTER ? "_total" : t == METRIC_INFO ? "_info" : "";
+}
+
+int MetricsCursor::nextLine() {
+  while (_family < _count) {
+    const MetricFamily &f = _families[_family];
+    int n = 0;
+    switch (_phase) {
+      case 0:
+        _phase = 1;
+        n = snprintf(_text, sizeof(_text), "# TYPE %s %s\n", f.name, typeName(f.type));
+        break;
+      case 1:
+        _phase = 2;
+        if (!f.unit) continue;
+        n = snprintf(_text, sizeof(_text), "# UNIT %s %s\n", f.name, f.unit);
+        break;
+      case 2:
+        _phase = 3;
+        if (!f.help) continue;
+        n = snprintf(_text, sizeof(_text), "# HELP %s %s\n", f.name, f.help);
+        break;
+      default: {
+        MetricSample s;
+        s.labels[0] = '\0';
+        s.value = 0;
+        MetricStep step = f.sample(_ctx, _index++, s);
+        if (step == METRIC_END) { _family++; _phase = 0; _index = 0; continue; }
+        if (step == METRIC_SKIP) continue;
+        char value[24];
+        if (isnan(s.value)) strcpy(value, "NaN");
+        else if (isinf(s.value)) strcpy(value, s.value > 0 ? "+Inf" : "-Inf");
+        else snprintf(value, sizeof(value), "%.9g", s.value);
+        n = snprintf(_text, sizeof(_text), s.labels[0] ? "%s%s{%s} %s\n" : "%s%s%s %s\n",
+                     f.name, sampleSuffix(f.type), s.labels, value);
+        break;
+      }
+    }
+    // A line that does not fit is dropped rather than emitted truncated
+    if (n > 0 && (size_t)n < sizeof(_text)) return n;
+  }
+  if (_eofDone) return 0;
+  _eofDone = true;
+  return snprintf(_text, sizeof(_text), "# EOF\n");
+}
+
+size_t MetricsCursor::read(uint8_t *buf, size_t maxLen) {
+  size_t len = 0;
+  while (len < maxLen) {
+    if (_textOff < _textLen) {
+      size_t toCopy = std::min(_textLen - _textOff, maxLen - len);
+      memcpy(buf + len, _text + _textOff, toCopy);
+      _textOff += toCopy;
+      len += toCopy;
+      continue;
+    }
+    _textOff = 0;
+    _textLen = (size_t)nextLine();
+    if (!_textLen) break;
+  }
+  return len;
+}
@@ -0,0 +1,109 @@
+#include "perf_monitor.h"
+
+PerfMonitor perfMonitor;
+
+#define PERF_STATUS_SLOTS 40    // uxTaskGetSystemState() fails if the array is too small
+
+void PerfMonitor::track(TaskHandle_t task) {
+  if (task && _trackedCount < sizeof(_tracked) / sizeof(_tracked[0])) _tracked[_trackedCount++] = task;
+}
+
+static void copyName(char *dst, const char *src) {
+  strncpy(dst, src ? src : "?", sizeof(PerfTask::name) - 1);
+  dst[sizeof(PerfTask::name) - 1] = '\0';
+}
+
+void PerfMonitor::taskExiting() {
+  PerfTask t = {};
+  copyName(t.name, pcTaskGetTaskName(NULL));
+  t.core = -1;
+  t.priority = (uint8_t)uxTaskPriorityGet(NULL);
+  t.stackFree = uxTaskGetStackHighWaterMark(NULL);
+  t.cpu = -1.0f;
+  t.exited = true;
+  portENTER_CRITICAL(&_exitedMux);
+  // Same name replaces the previous run; otherwise the oldest entry goes
+  uint8_t i = 0;
+  while (i < _exitedCount && strcmp(_exited[i].name, t.name) != 0) i++;
+  if (i == PERF_EXITED_TASKS) {
+    memmove(&_exited[0], &_exited[1], sizeof(_exited[0]) * (PERF_EXITED_TASKS - 1));
+    i = PERF_EXITED_TASKS - 1;
+  } else if (i == _exitedCount) {
+    _exitedCount++;
+  }
+  _exited[i] = t;
+  portEXIT_CRITICAL(&_exitedMux);
+}
+
+void PerfMonitor::sample() {
+  PerfSample &s = _work;
+  uint32_t now = millis();
+  s.timeMs = now;
+  s.intervalMs = _prevMs ? now - _prevMs : 0;
+  s.coreLoad[0] = s.coreLoad[1] = -1.0f;
+  s.taskCount = 0;
+  s.runtimeStats = false;
+
+#if configUSE_TRACE_FACILITY && configGENERATE_RUN_TIME_STATS
+  static TaskStatus_t status[PERF_STATUS_SLOTS];
+  uint32_t total = 0;
+  UBaseType_t n = 0;
+  if (uxTaskGetNumberOfTasks() <= PERF_STATUS_SLOTS) n = uxTaskGetSystemState(status, PERF_STATUS_SLOTS, &total);
+  if (n) {
+    s.runtimeStats = true;
+    uint32_t dTotal = total - _prevTotal;
+    uint32_t number[PERF_MAX_TASKS], run[PERF_MAX_TASKS];
+    uint8_t kept = 0;
+    for (UBaseType_t i = 0; i < n && kept < PERF_MAX_TASKS; i++) {
+      const TaskStatus_t &t = status[i];
+      PerfTask &p = s.tasks[kept];
+      copyName(p.name, t.pcTaskName);
+#if configTASKLIST_INCLUDE_COREID
+      p.core = (t.xCoreID == 0 || t.xCoreID == 1) ? (int8_t)t.xCoreID : -1;
+#else
+      p.core = -1;
+#endif
+      p.priority = (uint8_t)t.uxCurrentPriority;
+      p.stackFree = t.usStackHighWaterMark;   // bytes on ESP-IDF
+      p.cpu = -1.0f;
+      p.exited = false;
+      // Share since the previous sample; tasks created since then have no baseline yet
+      for (uint8_t j = 0; j < _prevCount && _prevMs && dTotal; j++) {
+        if (_prevNumber[j] == t.xTaskNumber) { p.cpu = (t.ulRunTimeCounter - _prevRun[j]) * 100.0f / dTotal; break; }
+      }
+      for (int c = 0; c < 2; c++) {
+        if (t.xHandle == xTaskGetIdleTaskHandleForCPU(c) && p.cpu >= 0.0f) s.coreLoad[c] = 100.0f - p.cpu;
+      }
+      number[kept] = t.xTaskNumber;
+      run[kept] = t.ulRunTimeCounter;
+      kept++;
+    }
+    memcpy(_prevNumber, number, sizeof(number[0]) * kept);
+    memcpy(_prevRun, run, sizeof(run[0]) * kept);
+    _prevCount = kept;
+    _prevTotal = total;
+    s.taskCount = kept;
+  }
+#endif
+  if (!s.runtimeStats) {
+    for (uint8_t i = 0; i < _trackedCount; i++) {
+      PerfTask &p = s.tasks[s.taskCount++];
+      copyName(p.name, pcTaskGetTaskName(_tracked[i]));
+      p.core = -1;
+      p.priority = (uint8_t)uxTaskPriorityGet(_tracked[i]);
+      p.stackFree = uxTaskGetStackHighWaterMark(_tracked[i]);
+      p.cpu = -1.0f;
+      p.exited = false;
+    }
+  }
+  // Finished tasks, unless one of the same name is running again
+  portENTER_CRITICAL(&_exitedMux);
+  for (uint8_t i = 0; i < _exitedCount && s.taskCount < PERF_MAX_TASKS; i++) {
+    bool running = false;
+    for (uint8_t j = 0; j < s.taskCount && !running; j++) running = strcmp(s.tasks[j].name, _exited[i].name) == 0;
+    if (!running) s.tasks[s.taskCount++] = _exited[i];
+  }
+  portEXIT_CRITICAL(&_exitedMux);
+  _prevMs = now;
+  _state.publish(s);
+}
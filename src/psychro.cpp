@@ -0,0 +1,101 @@
+#include "psychro.h"
+#include <Arduino.h>
+#include <math.h>
+#include <float.h>
+#include <string.h>
+
+// exp(x) for |x| < ~80: x = k ln2 + r with |r| <= ln2/2, exp(r) by a degree-6
+// Taylor polynomial (truncation < 1.3e-7 relative), 2^k spliced into the exponent
+static inline float fastExp(float x) {
+  const float ln2 = 0.69314718f;
+  float kf = floorf(x * 1.44269504f + 0.5f);
+  float r = x - kf * ln2;
+  float p = 1.0f + r * (1.0f + r * (0.5f + r * (1.0f / 6 + r * (1.0f / 24 + r * (1.0f / 120 + r * (1.0f / 720))))));
+  int32_t bits;
+  memcpy(&bits, &p, sizeof(bits));
+  bits += (int32_t)kf << 23;
+  memcpy(&p, &bits, sizeof(p));
+  return p;
+}
+
+// ln(x) for normal x > 0: x = m 2^e with m in [sqrt(1/2), sqrt(2)), then
+// ln(m) = 2 atanh(s), s = (m-1)/(m+1), |s| < 0.172, series to s^9 (< 2e-9).
+// Anything else (0 %RH, subnormal, negative, NaN) goes to logf, so the dew point
+// is NaN exactly where the exact path's is rather than a finite ~-199 °C.
+static inline float fastLog(float x) {
+  if (!(x >= FLT_MIN && x <= FLT_MAX)) return logf(x);
+  int32_t bits;
+  memcpy(&bits, &x, sizeof(bits));
+  int32_t e = ((bits >> 23) & 0xFF) - 127;
+  bits = (bits & 0x007FFFFF) | 0x3F800000;
+  float m;
+  memcpy(&m, &bits, sizeof(m));
+  if (m > 1.41421356f) { m *= 0.5f; e++; }
+  float s = (m - 1.0f) / (m + 1.0f);
+  float s2 = s * s;
+  float lnm = 2.0f * s * (1.0f + s2 * (1.0f / 3 + s2 * (1.0f / 5 + s2 * (1.0f / 7 + s2 * (1.0f / 9)))));
+  return e * 0.69314718f + lnm;
+}
+
+void psychroCompute(float tempC, float rh, Psychro &out, PsychroMode mode) {
+  const float frac = rh * 0.01f;
+  const float x = (17.27f * tempC) / (tempC + 237.3f);
+  const float g = (17.27f * tempC) / (237.7f + tempC);
+  float ex, lnRh;
+  if (mode == PSYCHRO_FAST) {
+    ex = fastExp(x);
+    lnRh = fastLog(frac);
+  } else {
+    ex = expf(x);
+    lnRh = logf(frac);
+  }
+  out.es = 0.6108f * ex;
+  out.ea = out.es * frac;
+  out.vpd = out.es - out.ea;
+  out.absoluteHumidity = (out.ea * 2.16679f) / (tempC + 273.15f);
+  const float alpha = g + lnRh;
+  out.dewPoint = (237.7f * alpha) / (17.27f - alpha);
+  out.heatIndex = tempC < 27.0f ? tempC
+                : 0.5f * (tempC + 61.0f + ((tempC - 68.0f) * 1.2f) + (rh * 0.094f));
+}
+
+void psychroBatch(const float *tempC, const float *rh, Psychro *out, size_t n, PsychroMode mode) {
+  for (size_t i = 0; i < n; i++) psychroCompute(tempC[i], rh[i], out[i], mode);
+}
+
+PsychroBenchResult psychroBench() {
+  // 81 temperatures x 100 humidities, processed in rows through the batch form
+  const int nT = 81, nH = 100;
+  static float t[nH], h[nH];
+  static Psychro exact[nH], fast[nH];
+  PsychroBenchResult r = {};
+  uint32_t exactUs = 0, fastUs = 0;
+  for (int ti = 0; ti < nT; ti++) {
+    for (int hi = 0; hi < nH; hi++) {
+      t[hi] = -20.0f + ti;
+      h[hi] = 1.0f + hi;
+    }
+    uint32_t t0 = micros();
+    psychroBatch(t, h, exact, nH, PSYCHRO_EXACT);
+    uint32_t t1 = micros();
+    psychroBatch(t, h, fast, nH, PSYCHRO_FAST);
+    uint32_t t2 = micros();
+    exactUs += t1 - t0;
+    fastUs += t2 - t1;
+    for (int i = 0; i < nH; i++) {
+      const float pe[4] = { exact[i].es, exact[i].ea, exact[i].vpd, exact[i].absoluteHumidity };
+      const float pf[4] = { fast[i].es, fast[i].ea, fast[i].vpd, fast[i].absoluteHumidity };
+      for (int k = 0; k < 4; k++) {
+        if (pe[k] == 0.0f) continue;   // vpd at 100 %RH
+        float rel = fabsf(pf[k] - pe[k]) / fabsf(pe[k]);
+        if (rel > r.maxRelErr) r.maxRelErr = rel;
+      }
+      float de = fabsf(fast[i].dewPoint - exact[i].dewPoint);
+      if (de > r.maxDewErr) r.maxDewErr = de;
+    }
+  }
+  r.samples = nT * nH;
+  r.exactNs = exactUs * 1000.0f / r.samples;
+  r.fastNs = fastUs * 1000.0f / r.samples;
+  return r;
+}
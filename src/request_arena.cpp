@@ -0,0 +1,237 @@
+#include "request_arena.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// ---- Allocation tracing ----
+static volatile uint32_t allocTraceCount = 0;
+static TaskHandle_t allocTraceTask = NULL;
+
+#ifdef REPTIMON_ALLOC_TRACE
+// Link with -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc (see platformio.ini)
+extern "C" {
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t n, size_t size);
+void *__real_realloc(void *p, size_t size);
+
+static inline void allocTraceHit() {
+  if (allocTraceTask && xTaskGetCurrentTaskHandle() == allocTraceTask) allocTraceCount++;
+}
+void *__wrap_malloc(size_t size) { allocTraceHit(); return __real_malloc(size); }
+void *__wrap_calloc(size_t n, size_t size) { allocTraceHit(); return __real_calloc(n, size); }
+void *__wrap_realloc(void *p, size_t size) { allocTraceHit(); return __real_realloc(p, size); }
+}
+#endif
+
+bool allocTraceEnabled() {
+#ifdef REPTIMON_ALLOC_TRACE
+  return true;
+#else
+  return false;
+#endif
+}
+
+static AllocRouteStats allocRoutes[ALLOC_TRACE_ROUTES];
+static size_t allocRouteCount = 0;
+static portMUX_TYPE allocRouteMux = portMUX_INITIALIZER_UNLOCKED;
+
+AllocRouteStats *allocTraceRoute(const char *path) {
+  AllocRouteStats *r = nullptr;
+  portENTER_CRITICAL(&allocRouteMux);
+  for (size_t i = 0; i < allocRouteCount && !r; i++) {
+    if (strcmp(allocRoutes[i].path, path) == 0) r = &allocRoutes[i];
+  }
+  if (!r && allocRouteCount < ALLOC_TRACE_ROUTES) {
+    r = &allocRoutes[allocRouteCount++];
+    memset(r, 0, sizeof(*r));
+    r->path = path;
+  }
+  portEXIT_CRITICAL(&allocRouteMux);
+  return r;
+}
+
+size_t allocTraceRoutes(AllocRouteStats *out, size_t cap) {
+  portENTER_CRITICAL(&allocRouteMux);
+  size_t n = allocRouteCount < cap ? allocRouteCount : cap;
+  memcpy(out, allocRoutes, n * sizeof(AllocRouteStats));
+  portEXIT_CRITICAL(&allocRouteMux);
+  return n;
+}
+
+AllocScope::AllocScope(AllocRouteStats *route) : _route(route) {
+  allocTraceTask = xTaskGetCurrentTaskHandle();
+  _start = allocTraceCount;
+}
+
+AllocScope::~AllocScope() {
+  if (!_route) return;
+  uint32_t n = allocTraceCount - _start;
+  portENTER_CRITICAL(&allocRouteMux);
+  _route->requests++;
+  _route->allocs += n;
+  _route->last = n;
+  if (n > _route->max) _route->max = n;
+  portEXIT_CRITICAL(&allocRouteMux);
+}
+
+// ---- Response pool ----
+struct ArenaSlot {
+  alignas(ArenaResponse) uint8_t storage[sizeof(ArenaResponse)];
+  bool used;
+};
+static ArenaSlot arenaSlots[ARENA_SLOTS];
+static portMUX_TYPE arenaMux = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t arenaHits = 0, arenaMisses = 0;
+
+void *ArenaResponse::operator new(size_t size) {
+  if (size <= sizeof(ArenaSlot::storage)) {
+    portENTER_CRITICAL(&arenaMux);
+    for (int i = 0; i < ARENA_SLOTS; i++) {
+      if (!arenaSlots[i].used) {
+        arenaSlots[i].used = true;
+        arenaHits++;
+        portEXIT_CRITICAL(&arenaMux);
+        return arenaSlots[i].storage;
+      }
+    }
+    arenaMisses++;
+    portEXIT_CRITICAL(&arenaMux);
+  }
+  return ::operator new(size);
+}
+
+void ArenaResponse::operator delete(void *p) {
+  for (int i = 0; i < ARENA_SLOTS; i++) {
+    if (p == arenaSlots[i].storage) {
+      portENTER_CRITICAL(&arenaMux);
+      arenaSlots[i].used = false;
+      portEXIT_CRITICAL(&arenaMux);
+      return;
+    }
+  }
+  ::operator delete(p);
+}
+
+uint32_t ArenaResponse::poolHits() { return arenaHits; }
+uint32_t ArenaResponse::poolMisses() { return arenaMisses; }
+
+ArenaResponse::ArenaResponse(int code, const char *contentType) : _type(contentType) {
+  _code = code;
+  _extra[0] = '\0';
+}
+
+ArenaResponse *ArenaResponse::json(int code, const JsonDocument &doc) {
+  if (measureJson(doc) >= ARENA_BODY_CAP) return nullptr;
+  ArenaResponse *r = new ArenaResponse(code, "application/json");
+  r->_bodyLen = serializeJson(doc, r->_body, ARENA_BODY_CAP);
+  return r;
+}
+
+ArenaResponse *ArenaResponse::shared(int code, const char *contentType, AsyncWebSocketSharedBuffer body) {
+  ArenaResponse *r = new ArenaResponse(code, contentType);
+  r->_shared = body;
+  return r;
+}
+
+ArenaResponse *ArenaResponse::blob(int code, const char *contentType, std::shared_ptr<const uint8_t> body, size_t len) {
+  ArenaResponse *r = new ArenaResponse(code, contentType);
+  r->_blob = body;
+  r->_bodyLen = len;
+  return r;
+}
+
+ArenaResponse *ArenaResponse::text(int code, const char *contentType, const char *body) {
+  size_t n = strlen(body);
+  if (n >= ARENA_BODY_CAP) return nullptr;
+  ArenaResponse *r = new ArenaResponse(code, contentType);
+  memcpy(r->_body, body, n);
+  r->_bodyLen = n;
+  return r;
+}
+
+ArenaResponse *ArenaResponse::empty(int code) {
+  return new ArenaResponse(code, nullptr);
+}
+
+bool ArenaResponse::header(const char *name, const char *value) {
+  int n = snprintf(_extra + _extraLen, sizeof(_extra) - _extraLen, "%s: %s\r\n", name, value);
+  if (n < 0 || (size_t)n >= sizeof(_extra) - _extraLen) { _extra[_extraLen] = '\0'; return false; }
+  _extraLen += n;
+  return true;
+}
+
+bool ArenaResponse::headers(const char *lines) {
+  size_t n = strlen(lines);
+  if (n >= sizeof(_extra) - _extraLen) return false;
+  memcpy(_extra + _extraLen, lines, n + 1);
+  _extraLen += n;
+  return true;
+}
+
+static const char *arenaStatusText(int code) {
+  switch (code) {
+    case 200: return "OK";
+    case 202: return "Accepted";
+    case 204: return "No Content";
+    case 304: return "Not Modified";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 500: return "Internal Server Error";
+    case 503: return "Service Unavailable";
+    default:  return "";
+  }
+}
+
+void ArenaResponse::_respond(AsyncWebServerRequest *request) {
+  int n;
+  if (_type) {
+    n = snprintf(_head, sizeof(_head), "HTTP/1.%d %d %s\r\nConnection: close\r\nContent-Type: %s\r\nContent-Length: %u\r\n%s\r\n",
+                 request->version(), _code, arenaStatusText(_code), _type, (unsigned)bodyLength(), _extra);
+  } else {
+    n = snprintf(_head, sizeof(_head), "HTTP/1.%d %d %s\r\nConnection: close\r\nContent-Length: 0\r\n%s\r\n",
+                 request->version(), _code, arenaStatusText(_code), _extra);
+  }
+  if (n < 0 || (size_t)n >= sizeof(_head)) { _state = RESPONSE_FAILED; request->client()->close(true); return; }
+  _headLen = (size_t)n;
+  _state = RESPONSE_CONTENT;
+  pump(request);
+}
+
+size_t ArenaResponse::_ack(AsyncWebServerRequest *request, size_t len, uint32_t time) {
+  (void)time;
+  _acked += len;
+  pump(request);
+  return len;
+}
+
+void ArenaResponse::pump(AsyncWebServerRequest *request) {
+  const size_t total = _headLen + bodyLength();
+  AsyncClient *client = request->client();
+  bool added = false;
+  while (_written < total) {
+    size_t space = client->space();
+    if (!space) break;
+    const uint8_t *src;
+    size_t avail;
+    if (_written < _headLen) {
+      src = (const uint8_t*)_head + _written;
+      avail = _headLen - _written;
+    } else {
+      src = bodyData() + (_written - _headLen);
+      avail = total - _written;
+    }
+    size_t w = client->add((const char*)src, std::min(space, avail));
+    if (!w) break;
+    _written += w;
+    _writtenLength = _written;   // read by RouteMetrics like any other response
+    added = true;
+  }
+  if (added) client->send();
+  if (_written >= total) _state = (_acked >= total) ? RESPONSE_END : RESPONSE_WAIT_ACK;
+}
+
+void sendJson(AsyncWebServerRequest *request, const JsonDocument &doc, int code) {
+  ArenaResponse *r = ArenaResponse::json(code, doc);
+  if (r) { request->send(r); return; }
+  String out; serializeJson(doc, out);
+  request->send(code, "application/json", out);
+}
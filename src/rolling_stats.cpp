@@ -0,0 +1,169 @@
+#include "rolling_stats.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#ifdef ARDUINO
+#include <esp_heap_caps.h>
+#endif
+
+constexpr StatWindowConfig RollingStats::kWindows[STATS_WINDOWS];
+
+static void *statsAlloc(size_t bytes, bool &psram) {
+#if defined(ARDUINO) && defined(BOARD_HAS_PSRAM)
+  void *p = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (p) { psram = true; return p; }
+#endif
+  psram = false;
+  return malloc(bytes);
+}
+
+void RollingStats::MonoDeque::push(uint32_t idx, float v, bool isMax) {
+  // Drop entries from the back that can never be the extreme again
+  while (size > 0) {
+    const MonoEntry &back = buf[(head + size - 1) % cap];
+    if (isMax ? (back.v <= v) : (back.v >= v)) size--; else break;
+  }
+  buf[(head + size) % cap] = { idx, v };
+  size++;
+}
+
+void RollingStats::MonoDeque::expire(uint32_t oldestIdx) {
+  while (size > 0 && (int32_t)(buf[head].idx - oldestIdx) < 0) {
+    head = (head + 1) % cap;
+    size--;
+  }
+}
+
+bool RollingStats::begin() {
+  bool allPsram = true;
+  for (int i = 0; i < STATS_WINDOWS; i++) {
+    Window &w = _w[i];
+    if (w.fifo) continue;
+    uint32_t blocks = kWindows[i].seconds / kWindows[i].blockSec;
+    size_t bytes = blocks * sizeof(Block) + 2 * STAT_CHANNELS * blocks * sizeof(MonoEntry);
+    bool ps = false;
+    uint8_t *mem = (uint8_t*)statsAlloc(bytes, ps);
+    if (!mem) return false;
+    w.fifo = (Block*)mem;
+    w.cap = blocks;
+    MonoEntry *q = (MonoEntry*)(mem + blocks * sizeof(Block));
+    for (int c = 0; c < STAT_CHANNELS; c++) {
+      w.minQ[c].buf = q; q += blocks; w.minQ[c].cap = blocks;
+      w.maxQ[c].buf = q; q += blocks; w.maxQ[c].cap = blocks;
+    }
+    _bytes += bytes;
+    allPsram = allPsram && ps;
+  }
+  _psram = allPsram;
+  return true;
+}
+
+void RollingStats::closeBlock(Window &w) {
+  const Block &b = w.cur;
+  w.fifo[(w.head + w.size) % w.cap] = b;
+  w.size++;
+  w.count += b.count;
+  for (int c = 0; c < STAT_CHANNELS; c++) {
+    w.sum[c].add(b.sum[c]);
+    w.sumSq[c].add(b.sumSq[c]);
+    w.minQ[c].push(b.idx, w.curMin[c], false);
+    w.maxQ[c].push(b.idx, w.curMax[c], true);
+  }
+  w.open = false;
+}
+
+void RollingStats::evict(Window &w, uint32_t oldestIdx) {
+  while (w.size > 0 && (int32_t)(w.fifo[w.head].idx - oldestIdx) < 0) {
+    const Block &b = w.fifo[w.head];
+    w.count -= b.count;
+    for (int c = 0; c < STAT_CHANNELS; c++) {
+      w.sum[c].add(-b.sum[c]);
+      w.sumSq[c].add(-b.sumSq[c]);
+    }
+    w.head = (w.head + 1) % w.cap;
+    w.size--;
+  }
+  for (int c = 0; c < STAT_CHANNELS; c++) {
+    w.minQ[c].expire(oldestIdx);
+    w.maxQ[c].expire(oldestIdx);
+  }
+}
+
+void RollingStats::add(uint32_t t, const float x[STAT_CHANNELS]) {
+  for (int c = 0; c < STAT_CHANNELS; c++) if (isnan(x[c])) return;
+
+  if (_n == 0) {
+    for (int c = 0; c < STAT_CHANNELS; c++) { _ref[c] = x[c]; _min[c] = _max[c] = x[c]; }
+  }
+  _n++;
+  for (int c = 0; c < STAT_CHANNELS; c++) {
+    double d = x[c] - _mean[c];
+    _mean[c] += d / (double)_n;
+    _m2[c] += d * (x[c] - _mean[c]);
+    if (x[c] < _min[c]) _min[c] = x[c];
+    if (x[c] > _max[c]) _max[c] = x[c];
+  }
+
+  for (int i = 0; i < STATS_WINDOWS; i++) {
+    Window &w = _w[i];
+    if (!w.fifo) continue;
+    const uint32_t blocks = w.cap;
+    uint32_t idx = t / kWindows[i].blockSec;
+    // Block indices are compared by signed difference; a sample older than the
+    // open block joins it rather than reopening a past block (which would
+    // overfill the FIFO)
+    if (w.open && (int32_t)(idx - w.cur.idx) < 0) idx = w.cur.idx;
+    if (w.open && w.cur.idx != idx) {
+      closeBlock(w);
+      // Window = the current block plus the blocks-1 before it
+      evict(w, idx + 1 - blocks);
+    }
+    if (!w.open) {
+      memset(&w.cur, 0, sizeof(w.cur));
+      w.cur.idx = idx;
+      for (int c = 0; c < STAT_CHANNELS; c++) w.curMin[c] = w.curMax[c] = x[c];
+      w.open = true;
+    }
+    w.cur.count++;
+    for (int c = 0; c < STAT_CHANNELS; c++) {
+      double d = (double)x[c] - _ref[c];
+      w.cur.sum[c] += d;
+      w.cur.sumSq[c] += d * d;
+      if (x[c] < w.curMin[c]) w.curMin[c] = x[c];
+      if (x[c] > w.curMax[c]) w.curMax[c] = x[c];
+    }
+  }
+}
+
+void RollingStats::window(int i, StatSummary &out) const {
+  memset(&out, 0, sizeof(out));
+  if (i < 0 || i >= STATS_WINDOWS) return;
+  const Window &w = _w[i];
+  if (!w.open) return;
+  out.count = w.count + w.cur.count;
+  for (int c = 0; c < STAT_CHANNELS; c++) {
+    float mn = w.curMin[c], mx = w.curMax[c];
+    if (w.minQ[c].size && w.minQ[c].front().v < mn) mn = w.minQ[c].front().v;
+    if (w.maxQ[c].size && w.maxQ[c].front().v > mx) mx = w.maxQ[c].front().v;
+    double s = w.sum[c].sum + w.cur.sum[c];
+    double sq = w.sumSq[c].sum + w.cur.sumSq[c];
+    double m = s / out.count;
+    double var = sq / out.count - m * m;
+    out.min[c] = mn;
+    out.max[c] = mx;
+    out.mean[c] = (float)(_ref[c] + m);
+    out.stddev[c] = var > 0 ? (float)sqrt(var) : 0.0f;
+  }
+}
+
+void RollingStats::sinceBoot(StatSummary &out) const {
+  memset(&out, 0, sizeof(out));
+  if (_n == 0) return;
+  out.count = (uint32_t)(_n > 0xFFFFFFFFull ? 0xFFFFFFFFull : _n);
+  for (int c = 0; c < STAT_CHANNELS; c++) {
+    out.min[c] = _min[c];
+    out.max[c] = _max[c];
+    out.mean[c] = (float)_mean[c];
+    out.stddev[c] = (float)sqrt(_m2[c] / (double)_n);
+  }
+}
@@ -0,0 +1,139 @@
+#include "rollup.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#ifdef ARDUINO
+#include <esp_heap_caps.h>
+#endif
+
+RollupEngine rollups;
+constexpr RollupTierConfig RollupEngine::kTiers[ROLLUP_TIERS];
+
+static void *rollupAlloc(size_t bytes, bool &psram) {
+#if defined(ARDUINO) && defined(BOARD_HAS_PSRAM)
+  void *p = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (p) { psram = true; return p; }
+#endif
+  psram = false;
+  return malloc(bytes);
+}
+
+bool RollupEngine::begin() {
+  bool allPsram = true;
+  for (int i = 0; i < ROLLUP_TIERS; i++) {
+    if (_buckets[i]) continue;
+    size_t bytes = kTiers[i].capacity * sizeof(RollupBucket);
+    bool ps = false;
+    _buckets[i] = (RollupBucket*)rollupAlloc(bytes, ps);
+    if (!_buckets[i]) return false;
+    memset(_buckets[i], 0, bytes);
+    _bytes += bytes;
+    allPsram = allPsram && ps;
+  }
+  _psram = allPsram;
+  return true;
+}
+
+void RollupEngine::add(uint32_t t, float tempC, float humidity) {
+  if (isnan(tempC) || isnan(humidity)) return;
+  portENTER_CRITICAL(&_mux);
+  for (int i = 0; i < ROLLUP_TIERS; i++) {
+    RollupBucket *ring = _buckets[i];
+    if (!ring) continue;
+    const uint32_t res = kTiers[i].resolution;
+    const uint32_t start = t - (t % res);
+    RollupBucket &b = ring[(t / res) % kTiers[i].capacity];
+    if (b.count == 0 || b.start != start) {
+      // Slot holds an older lap of the ring (or nothing): restart it
+      b.start = start;
+      b.count = 0;
+      b.tMin = b.tMax = tempC;
+      b.hMin = b.hMax = humidity;
+      b.tSum = 0; b.hSum = 0;
+    }
+    if (tempC < b.tMin) b.tMin = tempC;
+    if (tempC > b.tMax) b.tMax = tempC;
+    if (humidity < b.hMin) b.hMin = humidity;
+    if (humidity > b.hMax) b.hMax = humidity;
+    b.tSum += tempC;
+    b.hSum += humidity;
+    b.count++;
+  }
+  portEXIT_CRITICAL(&_mux);
+}
+
+int RollupEngine::selectTier(uint32_t from, uint32_t to, uint32_t now, uint32_t minPoints) const {
+  uint32_t span = (to > from) ? (to - from) : 0;
+  int finestCovering = -1;
+  for (int i = ROLLUP_TIERS - 1; i >= 0; i--) {
+    uint64_t retention = (uint64_t)kTiers[i].resolution * kTiers[i].capacity;
+    bool covers = (uint64_t)(now - std::min(from, now)) <= retention;
+    if (!covers) continue;
+    if (span / kTiers[i].resolution >= minPoints) return i;
+    finestCovering = i;
+  }
+  return finestCovering >= 0 ? finestCovering : ROLLUP_TIERS - 1;
+}
+
+bool RollupEngine::bucketAt(int tier, uint32_t bucketStart, RollupBucket &out) const {
+  if (tier < 0 || tier >= ROLLUP_TIERS || !_buckets[tier]) return false;
+  const RollupBucket *ring = _buckets[tier];
+  size_t slot = (bucketStart / kTiers[tier].resolution) % kTiers[tier].capacity;
+  portENTER_CRITICAL(&_mux);
+  out = ring[slot];
+  portEXIT_CRITICAL(&_mux);
+  return out.count > 0 && out.start == bucketStart;
+}
+
+// ---- Query cursor ----
+
+RollupEngine::Cursor::Cursor(const RollupEngine &engine, int tier, uint32_t from, uint32_t to, int64_t tsOffset, bool fahrenheit)
+  : _engine(engine), _tier(tier), _to(to), _from(from), _tsOffset(tsOffset), _fahrenheit(fahrenheit) {
+  _res = kTiers[tier].resolution;
+  _cur = from - (from % _res);
+}
+
+size_t RollupEngine::Cursor::read(uint8_t *buf, size_t maxLen) {
+  size_t len = 0;
+  while (len < maxLen) {
+    if (_textOff < _textLen) {
+      size_t toCopy = std::min(_textLen - _textOff, maxLen - len);
+      memcpy(buf + len, _text + _textOff, toCopy);
+      _textOff += toCopy;
+      len += toCopy;
+      continue;
+    }
+    _textLen = _textOff = 0;
+    int n = 0;
+    if (!_headerDone) {
+      n = snprintf(_text, sizeof(_text), "{\"tier\":%lu,\"from\":%lld,\"to\":%lld,\"units\":\"%s\",\"points\":[",
+                   (unsigned long)_res, (long long)(_from + _tsOffset), (long long)(_to + _tsOffset), _fahrenheit ? "F" : "C");
+      _headerDone = true;
+    } else if (_footerDone) {
+      break;
+    } else if (_cur > _to) {
+      n = snprintf(_text, sizeof(_text), "]}");
+      _footerDone = true;
+    } else {
+      RollupBucket b;
+      bool ok = _engine.bucketAt(_tier, _cur, b);
+      uint32_t start = _cur;
+      _cur += _res;  // 32-bit seconds of a 64-bit uptime: wraps after 136 years
+      if (!ok) continue;
+      float tMin = b.tMin, tMax = b.tMax, tAvg = (float)(b.tSum / b.count);
+      if (_fahrenheit) {
+        tMin = tMin * 9.0f / 5.0f + 32.0f;
+        tMax = tMax * 9.0f / 5.0f + 32.0f;
+        tAvg = tAvg * 9.0f / 5.0f + 32.0f;
+      }
+      n = snprintf(_text, sizeof(_text), "%s[%lld,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%lu]", _first ? "" : ",",
+                   (long long)(start + _tsOffset), tMin, tAvg, tMax,
+                   b.hMin, (float)(b.hSum / b.count), b.hMax, (unsigned long)b.count);
+      _first = false;
+    }
+    _textLen = (n > 0 && (size_t)n < sizeof(_text)) ? (size_t)n : 0;
+  }
+  return len;
+}
@@ -0,0 +1,115 @@
+#include "route_metrics.h"
+#if defined(ARDUINO) && defined(BOARD_HAS_PSRAM)
+#include <esp_heap_caps.h>
+#endif
+
+RouteMetrics routeMetrics;
+
+// _code and _writtenLength are protected; member pointers formed through a
+// subclass read them from any response without depending on accessor names
+struct ResponseProbe : AsyncWebServerResponse {
+  static int code(const AsyncWebServerResponse *r) { return r->*(&ResponseProbe::_code); }
+  static size_t written(const AsyncWebServerResponse *r) { return r->*(&ResponseProbe::_writtenLength); }
+};
+
+bool RouteMetrics::begin() {
+  if (_routes) return true;
+  const size_t bytes = memoryBytes();
+#if defined(ARDUINO) && defined(BOARD_HAS_PSRAM)
+  _routes = (RouteStats*)heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  _psram = _routes != nullptr;
+#endif
+  if (!_routes) _routes = (RouteStats*)malloc(bytes);
+  if (!_routes) return false;
+  memset(_routes, 0, bytes);
+  return true;
+}
+
+int RouteMetrics::add(const char *path, WebRequestMethodComposite method) {
+  if (!_routes || _count >= ROUTE_METRICS_MAX) return -1;
+  const int idx = _count++;
+  RouteStats &r = _routes[idx];
+  r.path = path;
+  r.method = method;
+  r.handlerUs.reset();
+  r.totalUs.reset();
+  return idx;
+}
+
+// A POST body arrives in chunks before the request handler runs; their time
+// is kept in the open entry and added to handlerUs with the handler's own, and
+// totalUs starts at the first chunk
+ArRequestHandlerFunction RouteMetrics::wrap(uint8_t route, ArRequestHandlerFunction onRequest) {
+  return [this, route, onRequest](AsyncWebServerRequest *request) {
+    uint32_t start = micros();
+    onRequest(request);
+    uint32_t us = micros() - start;
+    Open *o = find(request);
+    if (o) us += o->bodyUs;
+    else opened(route, request, start);
+    _routes[route].handlerUs.add(us);
+    _routes[route].requests++;
+  };
+}
+
+ArUploadHandlerFunction RouteMetrics::wrapUpload(uint8_t route, ArUploadHandlerFunction onUpload) {
+  if (!onUpload) return onUpload;
+  return [this, route, onUpload](AsyncWebServerRequest *request, const String &filename, size_t index,
+                                 uint8_t *data, size_t len, bool final) {
+    uint32_t start = micros();
+    onUpload(request, filename, index, data, len, final);
+    chunk(route, request, start);
+  };
+}
+
+ArBodyHandlerFunction RouteMetrics::wrapBody(uint8_t route, ArBodyHandlerFunction onBody) {
+  if (!onBody) return onBody;
+  return [this, route, onBody](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+    uint32_t start = micros();
+    onBody(request, data, len, index, total);
+    chunk(route, request, start);
+  };
+}
+
+RouteMetrics::Open *RouteMetrics::find(AsyncWebServerRequest *request) {
+  for (auto &o : _open) if (o.request == request) return &o;
+  return nullptr;
+}
+
+RouteMetrics::Open *RouteMetrics::opened(uint8_t route, AsyncWebServerRequest *request, uint32_t startUs) {
+  for (auto &o : _open) {
+    if (o.request) continue;
+    o = { request, startUs, 0, route };
+    RouteStats &r = _routes[route];
+    if (++r.inFlight > r.peakInFlight) r.peakInFlight = r.inFlight;
+    // Single pointer capture fits std::function's inline storage (no allocation)
+    request->onDisconnect([request]() { routeMetrics.closed(request); });
+    return &o;
+  }
+  return nullptr;
+}
+
+void RouteMetrics::chunk(uint8_t route, AsyncWebServerRequest *request, uint32_t startUs) {
+  const uint32_t us = micros() - startUs;
+  Open *o = find(request);
+  if (!o) o = opened(route, request, startUs);
+  if (o) o->bodyUs += us;
+}
+
+void RouteMetrics::closed(AsyncWebServerRequest *request) {
+  for (int i = 0; i < ROUTE_METRICS_INFLIGHT; i++) {
+    if (_open[i].request != request) continue;
+    RouteStats &r = _routes[_open[i].route];
+    r.totalUs.add(micros() - _open[i].startUs);
+    r.inFlight--;
+    // The response is deleted with the request, right after this callback
+    const AsyncWebServerResponse *resp = request->getResponse();
+    if (resp) {
+      int cls = ResponseProbe::code(resp) / 100;
+      if (cls >= 1 && cls <= 5) r.status[cls - 1]++;
+      r.bytesOut += ResponseProbe::written(resp);
+    }
+    _open[i].request = nullptr;
+    return;
+  }
+}
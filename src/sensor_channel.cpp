@@ -0,0 +1,60 @@
+#include "sensor_channel.h"
+#include <math.h>
+#include <stdio.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+SensorHub sensorHub;
+
+int SensorHub::add(const char *id, SensorDriver *driver) {
+  if (_count >= SENSOR_MAX_CHANNELS || !driver) return -1;
+  SensorChannel &ch = _channels[_count];
+  snprintf(ch.id, sizeof(ch.id), "%s", id);
+  ch.driver = driver;
+  return _count++;
+}
+
+void SensorHub::configureFilters(const FilterConfig &temp, const FilterConfig &hum) {
+  for (int i = 0; i < _count; i++) {
+    _channels[i].tempFilter.configure(temp);
+    _channels[i].humFilter.configure(hum);
+  }
+}
+
+uint32_t SensorHub::poll(uint32_t nowMs, uint32_t retryMs, float *temp, float *hum) {
+  float rawT[SENSOR_MAX_CHANNELS], rawH[SENSOR_MAX_CHANNELS];
+  SensorPoll res[SENSOR_MAX_CHANNELS];
+  bool anyRetry = false;
+
+  if (_bus) _bus->poll(nowMs);
+  for (int i = 0; i < _count; i++) {
+    rawT[i] = rawH[i] = NAN;
+    res[i] = _channels[i].driver->collect(rawT[i], rawH[i]);
+    anyRetry = anyRetry || (res[i] == SENSOR_NOT_READY && _channels[i].driver->retryable());
+  }
+  // A single shared wait covers every lagging sensor
+  if (anyRetry && retryMs) {
+    vTaskDelay(pdMS_TO_TICKS(retryMs));
+    for (int i = 0; i < _count; i++) {
+      if (res[i] == SENSOR_NOT_READY && _channels[i].driver->retryable()) {
+        res[i] = _channels[i].driver->collect(rawT[i], rawH[i]);
+      }
+    }
+  }
+
+  uint32_t mask = 0;
+  for (int i = 0; i < _count; i++) {
+    if (res[i] != SENSOR_OK) continue;
+    SensorChannel &ch = _channels[i];
+    bool ready = ch.tempFilter.push(rawT[i], nowMs, temp[i]);
+    if (ch.driver->hasHumidity()) {
+      // Both channels are pushed every time so their decimation stays in step
+      bool hReady = ch.humFilter.push(rawH[i], nowMs, hum[i]);
+      ready = ready && hReady;
+    } else {
+      hum[i] = NAN;
+    }
+    if (ready) mask |= 1u << i;
+  }
+  return mask;
+}
@@ -0,0 +1,90 @@
+#include "sensor_drivers.h"
+
+// ---- SHT3x ----
+
+SensorPoll Sht3xDriver::collect(float &tempC, float &humidity) {
+  switch (_sht.fetch(tempC, humidity)) {
+    case Sht3xPeriodic::SHT_OK: return SENSOR_OK;
+    case Sht3xPeriodic::SHT_NOT_READY: return SENSOR_NOT_READY;
+    default: return SENSOR_ERROR;
+  }
+}
+
+SensorDriverCounters Sht3xDriver::counters() const {
+  Sht3xPeriodic::Counters c = _sht.counters();
+  return { c.ok, c.notReady, c.crcErrors + c.busErrors, c.restarts };
+}
+
+// ---- DS18B20 ----
+
+#define DS18B20_FAMILY        0x28
+#define DS18B20_CONVERT_T     0x44
+#define DS18B20_READ_SCRATCH  0xBE
+#define DS18B20_WRITE_SCRATCH 0x4E
+
+uint8_t Ds18b20Bus::begin(uint8_t resolutionBits) {
+  if (resolutionBits < 9) resolutionBits = 9;
+  if (resolutionBits > 12) resolutionBits = 12;
+  _convMs = 94u << (resolutionBits - 9);   // 94/188/375/750 ms
+  _count = 0;
+  uint8_t rom[8];
+  _wire.reset_search();
+  while (_count < SENSOR_MAX_CHANNELS && _wire.search(rom)) {
+    if (rom[0] != DS18B20_FAMILY || OneWire::crc8(rom, 7) != rom[7]) continue;
+    memcpy(_roms[_count++], rom, 8);
+  }
+  if (_count) {
+    // Same resolution on every probe (TH/TL alarms unused)
+    _wire.reset();
+    _wire.skip();
+    _wire.write(DS18B20_WRITE_SCRATCH);
+    _wire.write(0);
+    _wire.write(0);
+    _wire.write((uint8_t)(((resolutionBits - 9) << 5) | 0x1F));
+  }
+  return _count;
+}
+
+void Ds18b20Bus::poll(uint32_t nowMs) {
+  if (!_count) return;
+  if (_converting) {
+    if (nowMs - _convertStart >= _convMs) {
+      _converting = false;
+      _generation++;
+    }
+    return;
+  }
+  // One broadcast conversion for all probes on the bus
+  if (!_wire.reset()) return;
+  _wire.skip();
+  _wire.write(DS18B20_CONVERT_T);
+  _converting = true;
+  _convertStart = nowMs;
+}
+
+bool Ds18b20Bus::readScratchpad(const uint8_t *rom, float &tempC) {
+  uint8_t data[9];
+  if (!_wire.reset()) return false;
+  _wire.select(rom);
+  _wire.write(DS18B20_READ_SCRATCH);
+  for (int i = 0; i < 9; i++) data[i] = _wire.read();
+  if (OneWire::crc8(data, 8) != data[8]) return false;
+  int16_t raw = (int16_t)((data[1] << 8) | data[0]);
+  tempC = raw / 16.0f;
+  return true;
+}
+
+SensorPoll Ds18b20Probe::collect(float &tempC, float &humidity) {
+  (void)humidity;
+  uint32_t gen = _bus.generation();
+  if (gen == _seenGeneration) return SENSOR_NOT_READY;  // between conversions: expected, not counted
+  _seenGeneration = gen;
+  if (!_bus.readScratchpad(_bus.rom(_index), tempC)) { _counters.errors++; return SENSOR_ERROR; }
+  _counters.ok++;
+  return SENSOR_OK;
+}
+
+void Ds18b20Probe::address(char *out, size_t len) const {
+  const uint8_t *r = _bus.rom(_index);
+  snprintf(out, len, "%02x%02x%02x%02x%02x%02x%02x%02x", r[0], r[1], r[2], r[3], r[4], r[5], r[6], r[7]);
+}
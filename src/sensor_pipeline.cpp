@@ -0,0 +1,68 @@
+#include "sensor_pipeline.h"
+#include <math.h>
+
+bool SensorPipeline::begin(const SensorHub &hub, PsychroMode mode) {
+  _mode = mode;
+  bool ok = true;
+  _work.channelCount = (uint8_t)hub.count();
+  for (int i = 0; i < hub.count(); i++) {
+    _work.channels[i].hasHumidity = hub.channel(i).driver->hasHumidity();
+    ok = _stats[i].begin() && ok;
+  }
+  return ok;
+}
+
+static EnvironmentData deriveEnvironment(float temperature, float humidity, bool hasHumidity,
+                                         uint32_t nowMs, PsychroMode mode) {
+  EnvironmentData d;
+  d.temperature = temperature;
+  d.humidity = humidity;
+  if (hasHumidity) {
+    Psychro p;
+    psychroCompute(temperature, humidity, p, mode);
+    d.dewPoint = p.dewPoint;
+    d.heatIndex = p.heatIndex;
+    d.vaporPressureDeficit = p.vpd;
+    d.absoluteHumidity = p.absoluteHumidity;
+  } else {
+    d.dewPoint = d.heatIndex = d.vaporPressureDeficit = d.absoluteHumidity = NAN;
+  }
+  d.timestamp = nowMs;
+  d.valid = true;
+  return d;
+}
+
+const SensorSnapshot &SensorPipeline::process(uint32_t ready, const float *temp, const float *hum, uint32_t nowMs) {
+  // Extend millis() to 64 bits so the statistics clock survives the 49.7-day wrap
+  _uptimeMs = _clockStarted ? _uptimeMs + (uint32_t)(nowMs - _lastMs) : nowMs;
+  _lastMs = nowMs;
+  _clockStarted = true;
+  const uint32_t uptimeSec = (uint32_t)(_uptimeMs / 1000);
+  _work.uptimeSec = uptimeSec;
+  for (int i = 0; i < _work.channelCount; i++) {
+    if (!(ready & (1u << i))) continue;
+    ChannelState &cs = _work.channels[i];
+    cs.data = deriveEnvironment(temp[i], hum[i], cs.hasHumidity, nowMs, _mode);
+
+    RollingStats &rs = _stats[i];
+    // Temperature-only channels keep zeros in the humidity/dew slots (not reported)
+    const EnvironmentData &d = cs.data;
+    const float x[STAT_CHANNELS] = { d.temperature, cs.hasHumidity ? d.humidity : 0.0f, cs.hasHumidity ? d.dewPoint : 0.0f };
+    rs.add(uptimeSec, x);
+    rs.sinceBoot(cs.stats.boot);
+    for (int w = 0; w < STATS_WINDOWS; w++) rs.window(w, cs.stats.windows[w]);
+    cs.stats.initialized = cs.stats.boot.count > 0;
+  }
+  return _work;
+}
+
+size_t SensorPipeline::statsBytes() const {
+  size_t n = 0;
+  for (int i = 0; i < _work.channelCount; i++) n += _stats[i].memoryBytes();
+  return n;
+}
+
+bool SensorPipeline::statsInPsram() const {
+  for (int i = 0; i < _work.channelCount; i++) if (!_stats[i].inPsram()) return false;
+  return true;
+}
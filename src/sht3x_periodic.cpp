@@ -0,0 +1,88 @@
+#include "sht3x_periodic.h"
+
+#define SHT3X_CMD_FETCH       0xE000
+#define SHT3X_CMD_BREAK       0x3093
+#define SHT3X_CMD_SOFT_RESET  0x30A2
+#define SHT3X_MAX_ERRORS      5      // consecutive bus/CRC errors before restarting periodic mode
+
+bool Sht3xPeriodic::command(uint16_t cmd) {
+  _wire->beginTransmission(_addr);
+  _wire->write((uint8_t)(cmd >> 8));
+  _wire->write((uint8_t)(cmd & 0xFF));
+  return _wire->endTransmission() == 0;
+}
+
+// CRC-8, polynomial 0x31, init 0xFF (datasheet section 4.12)
+uint8_t Sht3xPeriodic::crc8(const uint8_t *data, size_t len) {
+  uint8_t crc = 0xFF;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    for (int b = 0; b < 8; b++) crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+  }
+  return crc;
+}
+
+bool Sht3xPeriodic::begin(TwoWire &wire, uint16_t mode) {
+  _wire = &wire;
+  _mode = mode;
+  return restart();
+}
+
+bool Sht3xPeriodic::restart() {
+  if (!_wire) return false;
+  // Leave any previous periodic mode, reset, then start the configured one.
+  // These delays only run at startup and on error recovery.
+  command(SHT3X_CMD_BREAK);
+  delay(1);
+  command(SHT3X_CMD_SOFT_RESET);
+  delay(2);
+  _consecutiveErrors = 0;
+  if (!command(_mode)) { _state = SHT_STOPPED; return false; }
+  _state = SHT_RUNNING;
+  return true;
+}
+
+void Sht3xPeriodic::stop() {
+  if (_wire) command(SHT3X_CMD_BREAK);
+  _state = SHT_STOPPED;
+}
+
+uint32_t Sht3xPeriodic::periodMs() const {
+  switch (_mode) {
+    case SHT3X_PERIODIC_1MPS_HIGH: return 1000;
+    case SHT3X_PERIODIC_2MPS_HIGH: return 500;
+    case SHT3X_PERIODIC_4MPS_HIGH: return 250;
+    default: return 100;
+  }
+}
+
+void Sht3xPeriodic::fault(Result r) {
+  if (r == SHT_CRC_ERROR) _counters.crcErrors++; else _counters.busErrors++;
+  if (++_consecutiveErrors >= SHT3X_MAX_ERRORS) {
+    _state = SHT_RECOVERING;
+    _counters.restarts++;
+    restart();
+  }
+}
+
+Sht3xPeriodic::Result Sht3xPeriodic::fetch(float &tempC, float &humidity) {
+  if (!_wire) return SHT_BUS_ERROR;
+  if (_state != SHT_RUNNING && !restart()) { fault(SHT_BUS_ERROR); return SHT_BUS_ERROR; }
+  if (!command(SHT3X_CMD_FETCH)) { fault(SHT_BUS_ERROR); return SHT_BUS_ERROR; }
+  // The sensor NACKs the read header when no new measurement is available
+  if (_wire->requestFrom(_addr, (uint8_t)6) != 6) {
+    while (_wire->available()) _wire->read();
+    _counters.notReady++;
+    return SHT_NOT_READY;
+  }
+  uint8_t buf[6];
+  for (int i = 0; i < 6; i++) buf[i] = (uint8_t)_wire->read();
+  if (crc8(buf, 2) != buf[2] || crc8(buf + 3, 2) != buf[5]) { fault(SHT_CRC_ERROR); return SHT_CRC_ERROR; }
+  uint16_t rawT = ((uint16_t)buf[0] << 8) | buf[1];
+  uint16_t rawH = ((uint16_t)buf[3] << 8) | buf[4];
+  tempC = -45.0f + 175.0f * (float)rawT / 65535.0f;
+  humidity = 100.0f * (float)rawH / 65535.0f;
+  _consecutiveErrors = 0;
+  _counters.ok++;
+  return SHT_OK;
+}
@@ -0,0 +1,126 @@
+#include "signal_filter.h"
+#include <math.h>
+
+void SignalFilter::configure(const FilterConfig &cfg) {
+  _cfg = cfg;
+  if (_cfg.decimation < 1) _cfg.decimation = 1;
+  if (_cfg.median < 1) _cfg.median = 1;
+  if (_cfg.median > FILTER_MAX_WINDOW) _cfg.median = FILTER_MAX_WINDOW;
+  if ((_cfg.median & 1) == 0) _cfg.median--;  // odd windows only
+  if (!(_cfg.emaAlpha > 0.0f && _cfg.emaAlpha <= 1.0f)) _cfg.emaAlpha = 1.0f;
+  reset();
+}
+
+void SignalFilter::reset() {
+  _winHead = _winCount = 0;
+  _haveLast = false;
+  _rejectRun = 0;
+  _haveSmooth = false;
+  _p = 1.0f;
+  _haveHeld = false;
+  _decSum = 0;
+  _decCount = 0;
+}
+
+// Insertion sort on a stack copy; n <= FILTER_MAX_WINDOW
+float SignalFilter::medianOf(const float *v, uint8_t n) {
+  float s[FILTER_MAX_WINDOW];
+  for (uint8_t i = 0; i < n; i++) {
+    float x = v[i];
+    int j = i - 1;
+    while (j >= 0 && s[j] > x) { s[j + 1] = s[j]; j--; }
+    s[j + 1] = x;
+  }
+  return (n & 1) ? s[n / 2] : 0.5f * (s[n / 2 - 1] + s[n / 2]);
+}
+
+bool SignalFilter::isOutlier(float x, uint32_t tMs) {
+  if (_cfg.maxRate > 0.0f && _haveLast) {
+    float dt = (tMs - _lastMs) / 1000.0f;
+    if (dt < 0.001f) dt = 0.001f;
+    if (fabsf(x - _last) > _cfg.maxRate * dt) { _rejectedRate++; return true; }
+  }
+  if (_cfg.madK > 0.0f && _winCount >= 5) {
+    float med = medianOf(_win, _winCount);
+    float dev[FILTER_MAX_WINDOW];
+    for (uint8_t i = 0; i < _winCount; i++) dev[i] = fabsf(_win[i] - med);
+    float mad = medianOf(dev, _winCount) * 1.4826f;
+    // A perfectly flat window gives MAD 0; don't reject on quantisation steps then
+    if (mad > 0.0f && fabsf(x - med) > _cfg.madK * mad) { _rejectedMad++; return true; }
+  }
+  return false;
+}
+
+bool SignalFilter::push(float x, uint32_t tMs, float &out) {
+  if (isnan(x)) return false;
+
+  float y;
+  if (isOutlier(x, tMs) && ++_rejectRun < FILTER_MAX_REJECTS) {
+    // Hold the previous value so decimation keeps the same cadence on every channel
+    if (!_haveHeld) return false;
+    y = _held;
+  } else {
+    if (_rejectRun >= FILTER_MAX_REJECTS) {
+      // Persistent disagreement is a real step change: re-seed, keeping the decimation phase
+      float decSum = _decSum;
+      uint8_t decCount = _decCount;
+      reset();
+      _decSum = decSum;
+      _decCount = decCount;
+    }
+    _rejectRun = 0;
+    y = condition(x, tMs);
+  }
+
+  _decSum += y;
+  if (++_decCount < _cfg.decimation) return false;
+  out = _decSum / _decCount;
+  _decSum = 0;
+  _decCount = 0;
+  return true;
+}
+
+float SignalFilter::condition(float x, uint32_t tMs) {
+  _last = x;
+  _lastMs = tMs;
+  _haveLast = true;
+
+  _win[_winHead] = x;
+  _winHead = (_winHead + 1) % FILTER_MAX_WINDOW;
+  if (_winCount < FILTER_MAX_WINDOW) _winCount++;
+
+  // Median over the newest `median` accepted samples
+  float y = x;
+  if (_cfg.median > 1) {
+    uint8_t n = _winCount < _cfg.median ? _winCount : _cfg.median;
+    float recent[FILTER_MAX_WINDOW];
+    for (uint8_t i = 0; i < n; i++) recent[i] = _win[(_winHead + FILTER_MAX_WINDOW - 1 - i) % FILTER_MAX_WINDOW];
+    y = medianOf(recent, n);
+  }
+
+  switch (_cfg.smoothing) {
+    case FILTER_SMOOTH_EMA:
+      _smooth = _haveSmooth ? _smooth + _cfg.emaAlpha * (y - _smooth) : y;
+      _haveSmooth = true;
+      y = _smooth;
+      break;
+    case FILTER_SMOOTH_KALMAN:
+      if (!_haveSmooth) {
+        _smooth = y;
+        _p = _cfg.kalmanR;
+        _haveSmooth = true;
+      } else {
+        _p += _cfg.kalmanQ;
+        float k = _p / (_p + _cfg.kalmanR);
+        _smooth += k * (y - _smooth);
+        _p *= (1.0f - k);
+      }
+      y = _smooth;
+      break;
+    default:
+      break;
+  }
+  _held = y;
+  _haveHeld = true;
+  return y;
+}
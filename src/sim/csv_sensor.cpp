@@ -0,0 +1,50 @@
+#include "csv_sensor.h"
+#include <Arduino.h>
+
+bool CsvSensorDriver::load(const char *path) {
+  FILE *f = fopen(path, "r");
+  if (!f) return false;
+  _rows.clear();
+  _hasHumidity = true;
+  char line[128];
+  while (fgets(line, sizeof(line), f)) {
+    if (line[0] == '#') continue;
+    Row r;
+    int n = sscanf(line, "%u,%f,%f", &r.ms, &r.t, &r.h);
+    if (n < 2) continue;            // header or blank line
+    if (n == 2) { r.h = NAN; _hasHumidity = false; }
+    _rows.push_back(r);
+  }
+  fclose(f);
+  if (_rows.size() < 2) return false;
+  uint32_t t0 = _rows[0].ms;
+  for (Row &r : _rows) r.ms -= t0;
+  // Loop with one average step after the last row so the wrap is not a jump in time
+  _period = _rows.back().ms + _rows.back().ms / (uint32_t)(_rows.size() - 1);
+  const char *slash = strrchr(path, '/');
+  _name = slash ? slash + 1 : path;
+  _next = 0;
+  _loopStart = millis();
+  return true;
+}
+
+SensorPoll CsvSensorDriver::collect(float &tempC, float &humidity) {
+  if (_rows.size() < 2) { _counters.errors++; return SENSOR_ERROR; }
+  uint32_t now = millis();
+  if (_next == _rows.size() && now - _loopStart >= _period) {
+    _loopStart += _period;
+    _next = 0;
+  }
+  if (_next == _rows.size() || now - _loopStart < _rows[_next].ms) { _counters.notReady++; return SENSOR_NOT_READY; }
+  // Latest due row; rows skipped by a slow caller are dropped, as on a real sensor
+  while (_next + 1 < _rows.size() && now - _loopStart >= _rows[_next + 1].ms) _next++;
+  const Row &r = _rows[_next++];
+  tempC = r.t;
+  if (_hasHumidity) humidity = r.h;
+  _counters.ok++;
+  return SENSOR_OK;
+}
+
+void CsvSensorDriver::address(char *out, size_t len) const {
+  snprintf(out, len, "%s", _name.c_str());
+}
@@ -0,0 +1,33 @@
+#pragma once
+// SensorDriver that replays a recorded trace against the simulated clock.
+//
+// CSV rows are `ms,tempC[,rh]` (lines starting with '#' and a non-numeric header
+// are skipped); ms is relative to the first row. Each row is delivered once,
+// when the clock reaches it, so samples (and glitches) arrive at the recorded
+// rate; cycles in between get SENSOR_NOT_READY. The trace loops, so a short
+// recording can feed a long run. A trace without the humidity column gives a
+// temperature-only channel, like a DS18B20 probe.
+#include <vector>
+#include <string>
+#include "sensor_channel.h"
+
+class CsvSensorDriver : public SensorDriver {
+public:
+  // Returns false if the file is missing or has fewer than two rows
+  bool load(const char *path);
+  const char *kind() const override { return "csv"; }
+  bool hasHumidity() const override { return _hasHumidity; }
+  SensorPoll collect(float &tempC, float &humidity) override;
+  SensorDriverCounters counters() const override { return _counters; }
+  void address(char *out, size_t len) const override;
+
+private:
+  struct Row { uint32_t ms; float t, h; };
+  std::vector<Row> _rows;
+  std::string _name;
+  bool _hasHumidity = false;
+  uint32_t _period = 0;       // loop length, ms
+  size_t _next = 0;           // next row to deliver
+  uint32_t _loopStart = 0;    // simulated ms at which the current loop began
+  SensorDriverCounters _counters = {};
+};
@@ -0,0 +1,90 @@
+// esp_camera.h replacement for the native simulator: serves JPEG files from a
+// directory in a loop, with the real driver's two-buffer limit.
+#include <esp_camera.h>
+#include <Arduino.h>
+#include <dirent.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#define FAKE_CAMERA_FB_COUNT 2
+
+struct FakeFrame {
+  std::vector<uint8_t> jpeg;
+  size_t width, height;
+};
+
+static std::vector<FakeFrame> frames;
+static size_t nextFrame = 0;
+static camera_fb_t fbs[FAKE_CAMERA_FB_COUNT];
+static bool fbHeld[FAKE_CAMERA_FB_COUNT];
+
+// Dimensions from the first SOF marker; 0x0 if none is found
+static void jpegSize(const std::vector<uint8_t> &j, size_t &w, size_t &h) {
+  w = h = 0;
+  size_t i = 2;
+  while (i + 9 < j.size()) {
+    if (j[i] != 0xFF) { i++; continue; }
+    uint8_t m = j[i + 1];
+    if (m >= 0xC0 && m <= 0xCF && m != 0xC4 && m != 0xC8 && m != 0xCC) {
+      h = (j[i + 5] << 8) | j[i + 6];
+      w = (j[i + 7] << 8) | j[i + 8];
+      return;
+    }
+    i += 2 + ((j[i + 2] << 8) | j[i + 3]);
+  }
+}
+
+int fakeCameraOpen(const char *dir) {
+  frames.clear();
+  nextFrame = 0;
+  DIR *d = opendir(dir);
+  if (!d) return 0;
+  std::vector<std::string> names;
+  while (struct dirent *e = readdir(d)) {
+    std::string n = e->d_name;
+    if (n.size() > 4 && (n.compare(n.size() - 4, 4, ".jpg") == 0 || n.compare(n.size() - 4, 4, ".JPG") == 0)) names.push_back(n);
+  }
+  closedir(d);
+  std::sort(names.begin(), names.end());
+  for (const std::string &n : names) {
+    FILE *f = fopen((std::string(dir) + "/" + n).c_str(), "rb");
+    if (!f) continue;
+    FakeFrame fr;
+    uint8_t chunk[4096];
+    size_t got;
+    while ((got = fread(chunk, 1, sizeof(chunk), f)) > 0) fr.jpeg.insert(fr.jpeg.end(), chunk, chunk + got);
+    fclose(f);
+    if (fr.jpeg.size() < 4 || fr.jpeg[0] != 0xFF || fr.jpeg[1] != 0xD8) continue;
+    jpegSize(fr.jpeg, fr.width, fr.height);
+    frames.push_back(std::move(fr));
+  }
+  return (int)frames.size();
+}
+
+camera_fb_t *esp_camera_fb_get() {
+  if (frames.empty()) return nullptr;
+  for (int i = 0; i < FAKE_CAMERA_FB_COUNT; i++) {
+    if (fbHeld[i]) continue;
+    FakeFrame &fr = frames[nextFrame];
+    nextFrame = (nextFrame + 1) % frames.size();
+    camera_fb_t &fb = fbs[i];
+    fb.buf = fr.jpeg.data();
+    fb.len = fr.jpeg.size();
+    fb.width = fr.width;
+    fb.height = fr.height;
+    fb.format = PIXFORMAT_JPEG;
+    uint32_t us = micros();
+    fb.timestamp.tv_sec = us / 1000000;
+    fb.timestamp.tv_usec = us % 1000000;
+    fbHeld[i] = true;
+    return &fb;
+  }
+  return nullptr;   // every buffer is held by the caller, as on the device
+}
+
+void esp_camera_fb_return(camera_fb_t *fb) {
+  for (int i = 0; i < FAKE_CAMERA_FB_COUNT; i++) {
+    if (fb == &fbs[i]) fbHeld[i] = false;
+  }
+}
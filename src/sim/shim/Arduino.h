@@ -0,0 +1,13 @@
+#pragma once
+// Minimal Arduino core for the native simulator: time comes from the simulated
+// clock in sim_clock.cpp, which advances only when a task delays.
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
@@ -0,0 +1,28 @@
+#pragma once
+// esp32-camera frame-buffer API backed by JPEG files on disk (fake_camera.cpp).
+// Frames are loaded into memory by fakeCameraOpen(); like the real driver with
+// fb_count = 2, at most two buffers can be held at once.
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/time.h>
+
+typedef int esp_err_t;
+#define ESP_OK    0
+#define ESP_FAIL -1
+
+typedef enum { PIXFORMAT_JPEG = 4 } pixformat_t;
+
+typedef struct {
+  uint8_t *buf;
+  size_t len;
+  size_t width;
+  size_t height;
+  pixformat_t format;
+  struct timeval timestamp;
+} camera_fb_t;
+
+camera_fb_t *esp_camera_fb_get();
+void esp_camera_fb_return(camera_fb_t *fb);
+
+// Simulator only: load every *.jpg in `dir` (name order); returns the count
+int fakeCameraOpen(const char *dir);
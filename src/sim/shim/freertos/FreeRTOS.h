@@ -0,0 +1,14 @@
+#pragma once
+// FreeRTOS subset for the native simulator. The simulator runs the sensor task
+// body on one thread, so critical sections are no-ops.
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+#define configTICK_RATE_HZ   1000
+#define portTICK_PERIOD_MS   1
+#define pdMS_TO_TICKS(ms)    ((TickType_t)(ms))
+
+typedef struct { int unused; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED { 0 }
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux)  ((void)(mux))
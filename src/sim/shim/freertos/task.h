@@ -0,0 +1,7 @@
+#pragma once
+#include "FreeRTOS.h"
+
+// Delays advance the simulated clock instead of sleeping
+TickType_t xTaskGetTickCount();
+void vTaskDelay(TickType_t ticks);
+void vTaskDelayUntil(TickType_t *previousWake, TickType_t period);
@@ -0,0 +1,23 @@
+// Simulated time for the native build. Nothing sleeps: vTaskDelay and
+// vTaskDelayUntil move the clock forward, so a day of sensor cycles runs as
+// fast as the host can execute them.
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+static uint64_t simUs = 0;
+
+uint32_t millis() { return (uint32_t)(simUs / 1000); }
+uint32_t micros() { return (uint32_t)simUs; }
+void delay(uint32_t ms) { simUs += (uint64_t)ms * 1000; }
+
+TickType_t xTaskGetTickCount() { return (TickType_t)(simUs / 1000); }
+
+void vTaskDelay(TickType_t ticks) { simUs += (uint64_t)ticks * 1000; }
+
+void vTaskDelayUntil(TickType_t *previousWake, TickType_t period) {
+  *previousWake += period;
+  // Jump to the wake tick; a late caller (cycle overran) returns immediately
+  int32_t ahead = (int32_t)(*previousWake - xTaskGetTickCount());
+  if (ahead > 0) simUs += (uint64_t)ahead * 1000 - simUs % 1000;
+}
@@ -0,0 +1,189 @@
+// Native simulator: runs the firmware's sensor -> filter -> psychrometrics ->
+// statistics -> seqlock -> rollup -> telemetry path on a Linux host at
+// accelerated (simulated) time, replaying CSV traces in place of the sensors.
+//
+//   pio run -e native && .pio/build/native/program --hours 24 src/sim/traces/enclosure.csv
+//
+// Options:
+//   --hours H      simulated duration (default 24)
+//   --exact        libm psychrometrics instead of the fast path
+//   --frames DIR   also grab/return camera frames from JPEG files at 10 fps
+// Each further argument is a trace; the first is the primary channel.
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_camera.h>
+#include <chrono>
+#include "sensor_channel.h"
+#include "sensor_pipeline.h"
+#include "seqlock.h"
+#include "rollup.h"
+#include "telemetry_frame.h"
+#include "histogram.h"
+#include "csv_sensor.h"
+
+// Test builds (pio test -e native) link the sources without this main()
+#ifndef PIO_UNIT_TESTING
+
+#define SIM_SENSOR_INTERVAL_MS  100   // same cadence as SENSOR_UPDATE_INTERVAL_MS
+#define SIM_RETRY_MS            10
+#define SIM_CAMERA_INTERVAL_MS  100
+
+// Stubbed network/heap state reported in telemetry frames
+#define SIM_RSSI        -55
+#define SIM_FREE_HEAP   180000
+#define SIM_FREE_PSRAM  7800000
+
+static SeqLock<SensorSnapshot> sensorState;
+static SensorPipeline sensorPipeline;
+
+// Same thresholds as the firmware defaults (AppSettings)
+static uint8_t simTempStatus(float t) {
+  return t < 22.0f ? TELEMETRY_STATUS_TOO_COLD : t > 32.0f ? TELEMETRY_STATUS_TOO_HOT : TELEMETRY_STATUS_PERFECT;
+}
+static uint8_t simHumStatus(float h) {
+  return h < 50.0f ? TELEMETRY_STATUS_TOO_DRY : h > 80.0f ? TELEMETRY_STATUS_TOO_WET : TELEMETRY_STATUS_PERFECT;
+}
+
+static uint64_t wallNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void printLog2(const char *name, const Log2Histogram<24> &h) {
+  printf("  %-14s n=%u mean=%u p50<=%u p99<=%u max=%u ns\n", name, (unsigned)h.count, (unsigned)h.mean(),
+         (unsigned)h.percentile(50), (unsigned)h.percentile(99), (unsigned)h.max);
+}
+
+int main(int argc, char **argv) {
+  float hours = 24.0f;
+  PsychroMode mode = PSYCHRO_FAST;
+  const char *framesDir = nullptr;
+  static CsvSensorDriver traces[SENSOR_MAX_CHANNELS];
+  int nTraces = 0;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--hours") && i + 1 < argc) hours = atof(argv[++i]);
+    else if (!strcmp(argv[i], "--exact")) mode = PSYCHRO_EXACT;
+    else if (!strcmp(argv[i], "--frames") && i + 1 < argc) framesDir = argv[++i];
+    else if (nTraces < SENSOR_MAX_CHANNELS) {
+      if (!traces[nTraces].load(argv[i])) { fprintf(stderr, "cannot load trace %s\n", argv[i]); return 1; }
+      char id[12];
+      snprintf(id, sizeof(id), "sim%d", nTraces + 1);
+      sensorHub.add(id, &traces[nTraces++]);
+    }
+  }
+  if (!nTraces) {
+    fprintf(stderr, "usage: %s [--hours H] [--exact] [--frames DIR] trace.csv [trace.csv ...]\n", argv[0]);
+    return 2;
+  }
+  int nFrames = framesDir ? fakeCameraOpen(framesDir) : 0;
+  if (framesDir && !nFrames) fprintf(stderr, "no JPEG frames in %s; camera disabled\n", framesDir);
+
+  FilterConfig tempCfg;       // firmware defaults: median of 3, rate limits 2 C/s, 10 %RH/s
+  tempCfg.median = 3;
+  tempCfg.maxRate = 2.0f;
+  FilterConfig humCfg = tempCfg;
+  humCfg.maxRate = 10.0f;
+  humCfg.kalmanR = 0.25f;
+  sensorHub.configureFilters(tempCfg, humCfg);
+  if (!sensorPipeline.begin(sensorHub, mode) || !rollups.begin()) {
+    fprintf(stderr, "allocation failed\n");
+    return 1;
+  }
+
+  Log2Histogram<24> cycleNs, frameNs, cameraNs;
+  cycleNs.reset();
+  frameNs.reset();
+  cameraNs.reset();
+  uint32_t readings = 0, frameBytes = 0, camFrames = 0, camMisses = 0;
+  uint64_t camBytes = 0;
+  uint8_t frame[sizeof(TelemetryLiveFrame) + SENSOR_MAX_CHANNELS * sizeof(TelemetryChannelEntry)];
+
+  const uint32_t endMs = (uint32_t)(hours * 3600000.0f);
+  TickType_t lastWake = xTaskGetTickCount();
+  uint32_t lastFrameMs = 0, lastCamMs = 0;
+  uint64_t wallStart = wallNs();
+
+  while (millis() < endMs) {
+    vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(SIM_SENSOR_INTERVAL_MS));
+
+    // sensorTask body
+    uint64_t t0 = wallNs();
+    float temp[SENSOR_MAX_CHANNELS], hum[SENSOR_MAX_CHANNELS];
+    uint32_t ready = sensorHub.poll(millis(), SIM_RETRY_MS, temp, hum);
+    if (ready) {
+      const SensorSnapshot &snap = sensorPipeline.process(ready, temp, hum, millis());
+      sensorState.publish(snap);
+      if (ready & 1u) {
+        const EnvironmentData &d = snap.channels[0].data;
+        rollups.add(snap.uptimeSec, d.temperature, d.humidity);
+        readings++;
+      }
+    }
+    cycleNs.add((uint32_t)(wallNs() - t0));
+
+    // webTask binary telemetry at TELEMETRY_BIN_INTERVAL_MS
+    if (millis() - lastFrameMs >= TELEMETRY_BIN_INTERVAL_MS) {
+      lastFrameMs = millis();
+      uint64_t f0 = wallNs();
+      static SensorSnapshot snap;
+      TelemetryContext ctx = {};
+      ctx.seq = sensorState.read(snap);
+      ctx.uptime = millis();
+      ctx.sta = true;
+      ctx.rssi = SIM_RSSI;
+      ctx.camera = nFrames > 0;
+      ctx.freeHeap = SIM_FREE_HEAP;
+      ctx.freePsram = SIM_FREE_PSRAM;
+      ctx.sensorHz = readings * 1000.0f / millis();
+      ctx.tempStatus = simTempStatus;
+      ctx.humStatus = simHumStatus;
+      frameBytes = (uint32_t)telemetryPackLive(snap, ctx, frame, sizeof(frame));
+      frameNs.add((uint32_t)(wallNs() - f0));
+    }
+
+    if (nFrames && millis() - lastCamMs >= SIM_CAMERA_INTERVAL_MS) {
+      lastCamMs = millis();
+      uint64_t c0 = wallNs();
+      camera_fb_t *fb = esp_camera_fb_get();
+      if (fb) {
+        camBytes += fb->len;
+        camFrames++;
+        esp_camera_fb_return(fb);
+      } else {
+        camMisses++;
+      }
+      cameraNs.add((uint32_t)(wallNs() - c0));
+    }
+  }
+  double wallS = (wallNs() - wallStart) / 1e9;
+
+  printf("Simulated %.2f h in %.3f s wall (%.0fx real time), %s psychrometrics\n",
+         millis() / 3600000.0, wallS, millis() / 1000.0 / wallS, mode == PSYCHRO_FAST ? "fast" : "exact");
+  printf("Host cost per operation:\n");
+  printLog2("sensor cycle", cycleNs);
+  printLog2("telemetry pack", frameNs);
+  if (nFrames) printLog2("camera grab", cameraNs);
+  printf("Primary readings: %u, telemetry frame: %u bytes, rollups: %u bytes\n",
+         (unsigned)readings, (unsigned)frameBytes, (unsigned)rollups.memoryBytes());
+  if (nFrames) printf("Camera: %u frames, %.1f MB, %u misses\n", (unsigned)camFrames, camBytes / 1e6, (unsigned)camMisses);
+
+  SensorSnapshot snap;
+  sensorState.read(snap);
+  for (int i = 0; i < snap.channelCount; i++) {
+    const ChannelState &cs = snap.channels[i];
+    const SensorChannel &hc = sensorHub.channel(i);
+    char addr[64];
+    hc.driver->address(addr, sizeof(addr));
+    printf("%s (%s): T %.2f", hc.id, addr, cs.data.temperature);
+    if (cs.hasHumidity) printf("  RH %.1f  dew %.2f  VPD %.3f", cs.data.humidity, cs.data.dewPoint, cs.data.vaporPressureDeficit);
+    printf("  rejected rate/MAD %u/%u\n", (unsigned)hc.tempFilter.rejectedRate(), (unsigned)hc.tempFilter.rejectedMad());
+    for (int w = 0; w < STATS_WINDOWS; w++) {
+      const StatSummary &s = cs.stats.windows[w];
+      printf("  %-4s n=%-6u T min %.2f max %.2f avg %.2f std %.3f\n", RollingStats::kWindows[w].name,
+             (unsigned)s.count, s.min[STAT_TEMP], s.max[STAT_TEMP], s.mean[STAT_TEMP], s.stddev[STAT_TEMP]);
+    }
+  }
+  return 0;
+}
+
+#endif  // PIO_UNIT_TESTING
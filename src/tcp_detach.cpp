@@ -0,0 +1,28 @@
+#include "tcp_detach.h"
+#include <lwip/tcp.h>
+#include <lwip/tcpip.h>
+#include <lwip/priv/tcp_priv.h>
+#include <lwip/priv/tcpip_priv.h>
+
+struct DetachCall {
+  struct tcpip_api_call_data call;
+  struct tcp_pcb *pcb;
+};
+
+// lwIP thread
+static err_t discardDetached(struct tcpip_api_call_data *data) {
+  struct tcp_pcb *pcb = ((DetachCall*)data)->pcb;
+  for (struct tcp_pcb *p = tcp_active_pcbs; p; p = p->next) {
+    if (p != pcb) continue;
+    if (!p->callback_arg && (p->unsent || p->unacked)) tcp_abort(p);
+    break;
+  }
+  return ERR_OK;
+}
+
+void tcpDiscardDetached(struct tcp_pcb *pcb) {
+  if (!pcb) return;
+  DetachCall msg = {};
+  msg.pcb = pcb;
+  tcpip_api_call(discardDetached, &msg.call);
+}
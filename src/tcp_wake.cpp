@@ -0,0 +1,61 @@
+#include "tcp_wake.h"
+#include <lwip/tcp.h>
+#include <lwip/tcpip.h>
+#include <lwip/priv/tcp_priv.h>
+
+TcpWakeList cameraWaiters;
+
+bool TcpWakeList::add(AsyncClient *client) {
+  if (!client || !client->pcb()) return false;
+  bool ok = false;
+  portENTER_CRITICAL(&_mux);
+  for (auto &e : _entries) if (e.client == client) { ok = true; break; }
+  if (!ok) {
+    for (auto &e : _entries) {
+      if (e.client) continue;
+      e = { client, client->pcb() };
+      _used++;
+      ok = true;
+      break;
+    }
+  }
+  portEXIT_CRITICAL(&_mux);
+  return ok;
+}
+
+void TcpWakeList::remove(AsyncClient *client) {
+  portENTER_CRITICAL(&_mux);
+  for (auto &e : _entries) {
+    if (e.client != client) continue;
+    e = {};
+    _used--;
+  }
+  portEXIT_CRITICAL(&_mux);
+}
+
+void TcpWakeList::wake() {
+  portENTER_CRITICAL(&_mux);
+  bool post = _used > 0 && !_queued;
+  if (post) _queued = true;
+  portEXIT_CRITICAL(&_mux);
+  if (post && tcpip_callback(&TcpWakeList::run, this) != ERR_OK) _queued = false;
+}
+
+void TcpWakeList::run(void *self) {
+  TcpWakeList &list = *(TcpWakeList*)self;
+  Entry entries[TCP_WAKE_SLOTS];
+  portENTER_CRITICAL(&list._mux);
+  memcpy(entries, list._entries, sizeof(entries));
+  list._queued = false;
+  portEXIT_CRITICAL(&list._mux);
+  for (const Entry &e : entries) {
+    if (!e.pcb) continue;
+    // Only a pcb lwIP still has open and AsyncTCP still owns (its arg is the
+    // client); a connection closed since add() is simply skipped
+    for (struct tcp_pcb *p = tcp_active_pcbs; p; p = p->next) {
+      if (p != e.pcb) continue;
+      if (p->callback_arg == e.client && p->poll) p->poll(p->callback_arg, p);
+      break;
+    }
+  }
+}
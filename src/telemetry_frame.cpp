@@ -0,0 +1,62 @@
+#include "telemetry_frame.h"
+#include "sensor_pipeline.h"
+#include <string.h>
+
+size_t telemetryPackLive(const SensorSnapshot &snap, const TelemetryContext &ctx, uint8_t *buf, size_t cap) {
+  const bool fahrenheit = ctx.fahrenheit;
+  auto disp = [fahrenheit](float c) { return fahrenheit ? c * 9.0f / 5.0f + 32.0f : c; };
+  const EnvironmentData &currentData = snap.channels[0].data;
+  const Statistics &stats = snap.channels[0].stats;
+  if (cap < sizeof(TelemetryLiveFrame)) return 0;
+  TelemetryLiveFrame &f = *(TelemetryLiveFrame*)buf;
+  memset(&f, 0, sizeof(f));
+  f.magic = TELEMETRY_MAGIC;
+  f.version = TELEMETRY_SCHEMA_VERSION;
+  f.type = TELEMETRY_FRAME_LIVE;
+  f.flags = (currentData.valid ? TELEMETRY_FLAG_VALID : 0) |
+            (fahrenheit ? TELEMETRY_FLAG_UNITS_F : 0) |
+            (stats.initialized ? TELEMETRY_FLAG_STATS : 0) |
+            (ctx.sta ? TELEMETRY_FLAG_STA : 0) |
+            (ctx.camera ? TELEMETRY_FLAG_CAMERA : 0);
+  f.seq = ctx.seq;
+  f.timestamp = currentData.timestamp;
+  f.uptime = ctx.uptime;
+  f.temperature = disp(currentData.temperature);
+  f.humidity = currentData.humidity;
+  f.dewPoint = disp(currentData.dewPoint);
+  f.heatIndex = disp(currentData.heatIndex);
+  f.vpd = currentData.vaporPressureDeficit;
+  f.absoluteHumidity = currentData.absoluteHumidity;
+  f.tempStatus = ctx.tempStatus(currentData.temperature);
+  f.humStatus = ctx.humStatus(currentData.humidity);
+  f.rssi = ctx.sta ? ctx.rssi : 0;
+  if (stats.initialized) {
+    const StatSummary &b = stats.boot;
+    f.tempMin = b.min[STAT_TEMP]; f.tempMax = b.max[STAT_TEMP]; f.tempAvg = b.mean[STAT_TEMP];
+    f.humMin = b.min[STAT_HUM];   f.humMax = b.max[STAT_HUM];   f.humAvg = b.mean[STAT_HUM];
+    f.dewMin = b.min[STAT_DEW];   f.dewMax = b.max[STAT_DEW];   f.dewAvg = b.mean[STAT_DEW];
+    f.readingCount = b.count;
+  }
+  f.freeHeap = ctx.freeHeap;
+  f.freePsram = ctx.freePsram;
+  f.sensorHz = ctx.sensorHz;
+
+  size_t len = sizeof(TelemetryLiveFrame);
+  for (int i = 0; i < snap.channelCount && len + sizeof(TelemetryChannelEntry) <= cap; i++) {
+    const ChannelState &cs = snap.channels[i];
+    TelemetryChannelEntry e;
+    memset(&e, 0, sizeof(e));
+    e.index = (uint8_t)i;
+    e.flags = (cs.data.valid ? TELEMETRY_CH_VALID : 0) | (cs.hasHumidity ? TELEMETRY_CH_HUMIDITY : 0);
+    e.tempStatus = ctx.tempStatus(cs.data.temperature);
+    e.humStatus = cs.hasHumidity ? ctx.humStatus(cs.data.humidity) : (uint8_t)TELEMETRY_STATUS_PERFECT;
+    e.temperature = disp(cs.data.temperature);
+    e.humidity = cs.hasHumidity ? cs.data.humidity : 0.0f;
+    e.dewPoint = cs.hasHumidity ? disp(cs.data.dewPoint) : 0.0f;
+    e.vpd = cs.hasHumidity ? cs.data.vaporPressureDeficit : 0.0f;
+    memcpy(buf + len, &e, sizeof(e));
+    len += sizeof(e);
+    f.channelCount++;
+  }
+  return len;
+}
@@ -0,0 +1,147 @@
+// MetricsCursor: OpenMetrics framing (TYPE/UNIT/HELP, suffixes, labels,
+// special values, # EOF) and identical output for any chunk size.
+#include <unity.h>
+#include <string>
+#include "metrics_writer.h"
+
+struct Ctx { double temp[3]; bool valid[3]; uint32_t requests; };
+
+static MetricStep sampleTemp(const void *ctx, int i, MetricSample &s) {
+  const Ctx &c = *(const Ctx*)ctx;
+  if (i >= 3) return METRIC_END;
+  if (!c.valid[i]) return METRIC_SKIP;
+  snprintf(s.labels, sizeof(s.labels), "channel=\"ch%d\"", i);
+  s.value = c.temp[i];
+  return METRIC_EMIT;
+}
+
+static MetricStep sampleRequests(const void *ctx, int i, MetricSample &s) {
+  if (i) return METRIC_END;
+  s.value = ((const Ctx*)ctx)->requests;
+  return METRIC_EMIT;
+}
+
+static MetricStep sampleMode(const void *ctx, int i, MetricSample &s) {
+  static const char *modes[] = { "sta", "ap" };
+  if (i >= 2) return METRIC_END;
+  snprintf(s.labels, sizeof(s.labels), "reptimon_wifi_mode=\"%s\"", modes[i]);
+  s.value = i == 0;
+  return METRIC_EMIT;
+}
+
+static MetricStep sampleBuild(const void *ctx, int i, MetricSample &s) {
+  if (i) return METRIC_END;
+  snprintf(s.labels, sizeof(s.labels), "version=\"1.2.3\"");
+  s.value = 1;
+  return METRIC_EMIT;
+}
+
+static MetricStep sampleSpecial(const void *ctx, int i, MetricSample &s) {
+  static const double v[] = { NAN, INFINITY, -INFINITY, 0.1 };
+  if (i >= 4) return METRIC_END;
+  s.value = v[i];
+  return METRIC_EMIT;
+}
+
+static const MetricFamily kFamilies[] = {
+  { "reptimon_temperature_celsius", METRIC_GAUGE, "celsius", "Conditioned temperature", sampleTemp },
+  { "reptimon_http_requests", METRIC_COUNTER, nullptr, "API requests", sampleRequests },
+  { "reptimon_wifi_mode", METRIC_STATESET, nullptr, nullptr, sampleMode },
+  { "reptimon_build", METRIC_INFO, nullptr, nullptr, sampleBuild },
+  { "reptimon_special", METRIC_GAUGE, nullptr, nullptr, sampleSpecial },
+};
+
+static const char *kExpected =
+  "# TYPE reptimon_temperature_celsius gauge\n"
+  "# UNIT reptimon_temperature_celsius celsius\n"
+  "# HELP reptimon_temperature_celsius Conditioned temperature\n"
+  "reptimon_temperature_celsius{channel=\"ch0\"} 27.5\n"
+  "reptimon_temperature_celsius{channel=\"ch2\"} -3.25\n"
+  "# TYPE reptimon_http_requests counter\n"
+  "# HELP reptimon_http_requests API requests\n"
+  "reptimon_http_requests_total 42\n"
+  "# TYPE reptimon_wifi_mode stateset\n"
+  "reptimon_wifi_mode{reptimon_wifi_mode=\"sta\"} 1\n"
+  "reptimon_wifi_mode{reptimon_wifi_mode=\"ap\"} 0\n"
+  "# TYPE reptimon_build info\n"
+  "reptimon_build_info{version=\"1.2.3\"} 1\n"
+  "# TYPE reptimon_special gauge\n"
+  "reptimon_special NaN\n"
+  "reptimon_special +Inf\n"
+  "reptimon_special -Inf\n"
+  "reptimon_special 0.1\n"
+  "# EOF\n";
+
+static const Ctx kCtx = { { 27.5, 99.0, -3.25 }, { true, false, true }, 42 };
+
+static std::string drain(MetricsCursor &cur, size_t chunk) {
+  std::string out;
+  uint8_t buf[512];
+  for (;;) {
+    size_t n = cur.read(buf, chunk);
+    if (!n) break;
+    TEST_ASSERT_TRUE(n <= chunk);
+    out.append((const char*)buf, n);
+  }
+  return out;
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_exposition_format() {
+  MetricsCursor cur(kFamilies, sizeof(kFamilies) / sizeof(kFamilies[0]), &kCtx);
+  TEST_ASSERT_EQUAL_STRING(kExpected, drain(cur, 512).c_str());
+  uint8_t buf[8];
+  TEST_ASSERT_EQUAL_UINT32(0, cur.read(buf, sizeof(buf)));
+}
+
+// Chunk boundaries fall inside lines; the concatenation must not change
+static void test_any_chunk_size() {
+  for (size_t chunk = 1; chunk <= 64; chunk++) {
+    MetricsCursor cur(kFamilies, sizeof(kFamilies) / sizeof(kFamilies[0]), &kCtx);
+    TEST_ASSERT_EQUAL_STRING(kExpected, drain(cur, chunk).c_str());
+  }
+}
+
+static void test_empty_table_is_eof_only() {
+  MetricsCursor cur(kFamilies, 0, &kCtx);
+  TEST_ASSERT_EQUAL_STRING("# EOF\n", drain(cur, 16).c_str());
+}
+
+static MetricStep sampleLongLabels(const void *ctx, int i, MetricSample &s) {
+  if (i >= 2) return METRIC_END;
+  if (i == 0) {
+    memset(s.labels, 'a', sizeof(s.labels) - 1);
+    s.labels[sizeof(s.labels) - 1] = '\0';
+    memcpy(s.labels, "k=\"", 3);
+    s.labels[sizeof(s.labels) - 2] = '"';
+  } else {
+    snprintf(s.labels, sizeof(s.labels), "k=\"short\"");
+  }
+  s.value = i;
+  return METRIC_EMIT;
+}
+
+// A line longer than the cursor's buffer is dropped whole, never truncated
+static void test_oversized_line_dropped() {
+  static const MetricFamily fam[] = {
+    { "reptimon_a_metric_with_a_rather_long_family_name_so_that_its_sample_line_with_full_labels_"
+      "overflows_the_cursor_line_buffer_of_224_bytes",
+      METRIC_COUNTER, nullptr, nullptr, sampleLongLabels },
+  };
+  MetricsCursor cur(fam, 1, nullptr);
+  std::string out = drain(cur, 64);
+  TEST_ASSERT_TRUE(out.find("aaaa") == std::string::npos);
+  TEST_ASSERT_TRUE(out.find("_total{k=\"short\"} 1\n") != std::string::npos);
+  TEST_ASSERT_TRUE(out.size() >= 6 && out.compare(out.size() - 6, 6, "# EOF\n") == 0);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_exposition_format);
+  RUN_TEST(test_any_chunk_size);
+  RUN_TEST(test_empty_table_is_eof_only);
+  RUN_TEST(test_oversized_line_dropped);
+  return UNITY_END();
+}
@@ -0,0 +1,129 @@
+// psychroCompute() in both modes against the per-value formulas it replaced,
+// evaluated in double, over the full supported T/RH range; plus host timing
+// of both paths through psychroBatch().
+#include <unity.h>
+#include <math.h>
+#include <chrono>
+#include "psychro.h"
+
+#define GRID_T_MIN   -20.0f
+#define GRID_T_MAX    60.0f
+#define GRID_T_STEP    0.25f
+#define GRID_RH_MIN    1.0f
+#define GRID_RH_MAX  100.0f
+#define GRID_RH_STEP   0.25f
+
+// Reference: the original calculateDewPoint/HeatIndex/VPD/AbsoluteHumidity
+struct Reference { double es, ea, vpd, ah, dew, hi; };
+
+static Reference reference(double t, double rh) {
+  Reference r;
+  r.es = 0.6108 * exp((17.27 * t) / (t + 237.3));
+  r.ea = r.es * rh * 0.01;
+  r.vpd = r.es - r.ea;
+  r.ah = (r.ea * 2.16679) / (t + 273.15);
+  double alpha = ((17.27 * t) / (237.7 + t)) + log(rh * 0.01);
+  r.dew = (237.7 * alpha) / (17.27 - alpha);
+  r.hi = t < 27.0 ? t : 0.5 * (t + 61.0 + ((t - 68.0) * 1.2) + (rh * 0.094));
+  return r;
+}
+
+struct GridError { double rel, dew, hi; };
+
+static GridError sweep(PsychroMode mode) {
+  GridError e = { 0, 0, 0 };
+  for (float t = GRID_T_MIN; t <= GRID_T_MAX; t += GRID_T_STEP) {
+    for (float rh = GRID_RH_MIN; rh <= GRID_RH_MAX; rh += GRID_RH_STEP) {
+      Psychro p;
+      psychroCompute(t, rh, p, mode);
+      Reference r = reference(t, rh);
+      const double got[4] = { p.es, p.ea, p.vpd, p.absoluteHumidity };
+      const double want[4] = { r.es, r.ea, r.vpd, r.ah };
+      for (int k = 0; k < 4; k++) {
+        // vpd vanishes at 100 %RH; compare it relative to es instead
+        double scale = k == 2 ? r.es : want[k];
+        double rel = fabs(got[k] - want[k]) / scale;
+        if (rel > e.rel) e.rel = rel;
+      }
+      if (fabs(p.dewPoint - r.dew) > e.dew) e.dew = fabs(p.dewPoint - r.dew);
+      if (fabs(p.heatIndex - r.hi) > e.hi) e.hi = fabs(p.heatIndex - r.hi);
+    }
+  }
+  char msg[128];
+  snprintf(msg, sizeof(msg), "%s: max rel err %.2e, dew point %.2e C, heat index %.2e C",
+           mode == PSYCHRO_FAST ? "fast" : "exact", e.rel, e.dew, e.hi);
+  TEST_MESSAGE(msg);
+  return e;
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_exact_matches_reference() {
+  GridError e = sweep(PSYCHRO_EXACT);
+  TEST_ASSERT_TRUE(e.rel < 1e-6);
+  TEST_ASSERT_TRUE(e.dew < 1e-4);
+  TEST_ASSERT_TRUE(e.hi < 1e-4);
+}
+
+// Bounds documented in psychro.h
+static void test_fast_matches_reference() {
+  GridError e = sweep(PSYCHRO_FAST);
+  TEST_ASSERT_TRUE(e.rel < 5e-6);
+  TEST_ASSERT_TRUE(e.dew < 1e-4);
+  TEST_ASSERT_TRUE(e.hi < 1e-4);
+}
+
+// 0 %RH has no dew point: both paths must agree on NaN
+static void test_zero_humidity() {
+  for (float t = GRID_T_MIN; t <= GRID_T_MAX; t += 10.0f) {
+    Psychro exact, fast;
+    psychroCompute(t, 0.0f, exact, PSYCHRO_EXACT);
+    psychroCompute(t, 0.0f, fast, PSYCHRO_FAST);
+    TEST_ASSERT_FLOAT_IS_NAN(exact.dewPoint);
+    TEST_ASSERT_FLOAT_IS_NAN(fast.dewPoint);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, fast.ea);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, exact.vpd, fast.vpd);
+  }
+}
+
+static void test_saturated_dew_point_equals_temperature() {
+  for (float t = GRID_T_MIN; t <= GRID_T_MAX; t += 5.0f) {
+    Psychro p;
+    psychroCompute(t, 100.0f, p, PSYCHRO_FAST);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, t, p.dewPoint);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, p.vpd);
+  }
+}
+
+// Not asserted (host timing varies); reported for comparison between paths
+static void test_batch_timing() {
+  const int n = 4096, rounds = 200;
+  static float t[n], h[n];
+  static Psychro out[n];
+  for (int i = 0; i < n; i++) {
+    t[i] = GRID_T_MIN + (GRID_T_MAX - GRID_T_MIN) * (i % 97) / 96.0f;
+    h[i] = GRID_RH_MIN + (GRID_RH_MAX - GRID_RH_MIN) * (i % 89) / 88.0f;
+  }
+  double ns[2];
+  for (int m = 0; m < 2; m++) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) psychroBatch(t, h, out, n, m ? PSYCHRO_FAST : PSYCHRO_EXACT);
+    auto t1 = std::chrono::steady_clock::now();
+    ns[m] = std::chrono::duration<double, std::nano>(t1 - t0).count() / ((double)n * rounds);
+  }
+  char msg[96];
+  snprintf(msg, sizeof(msg), "psychroBatch: exact %.1f ns, fast %.1f ns per sample", ns[0], ns[1]);
+  TEST_MESSAGE(msg);
+  TEST_ASSERT_TRUE(out[n - 1].es > 0);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_exact_matches_reference);
+  RUN_TEST(test_fast_matches_reference);
+  RUN_TEST(test_zero_humidity);
+  RUN_TEST(test_saturated_dew_point_equals_temperature);
+  RUN_TEST(test_batch_timing);
+  return UNITY_END();
+}
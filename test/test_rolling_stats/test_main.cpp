@@ -0,0 +1,146 @@
+// RollingStats windows against a brute-force recomputation over the raw
+// samples, including across the 49.7-day millis() wrap seen by SensorPipeline.
+#include <unity.h>
+#include <vector>
+#include "rolling_stats.h"
+#include "sensor_channel.h"
+#include "sensor_pipeline.h"
+
+struct Sample { uint64_t t; float x[STAT_CHANNELS]; };
+
+static uint32_t lcg = 12345;
+static float noise(float scale) {
+  lcg = lcg * 1664525u + 1013904223u;
+  return ((lcg >> 8) / 16777216.0f - 0.5f) * scale;
+}
+
+// Window w as of the newest sample: every sample whose block is within the
+// last blocks-per-window blocks
+static void bruteWindow(const std::vector<Sample> &all, int w, StatSummary &out) {
+  const StatWindowConfig &cfg = RollingStats::kWindows[w];
+  const uint64_t blocks = cfg.seconds / cfg.blockSec;
+  const uint64_t curIdx = all.back().t / cfg.blockSec;
+  const uint64_t oldest = curIdx + 1 >= blocks ? curIdx + 1 - blocks : 0;
+  memset(&out, 0, sizeof(out));
+  double sum[STAT_CHANNELS] = { 0 }, sq[STAT_CHANNELS] = { 0 };
+  for (const Sample &s : all) {
+    if (s.t / cfg.blockSec < oldest) continue;
+    for (int c = 0; c < STAT_CHANNELS; c++) {
+      if (!out.count || s.x[c] < out.min[c]) out.min[c] = s.x[c];
+      if (!out.count || s.x[c] > out.max[c]) out.max[c] = s.x[c];
+      sum[c] += s.x[c];
+      sq[c] += (double)s.x[c] * s.x[c];
+    }
+    out.count++;
+  }
+  for (int c = 0; c < STAT_CHANNELS; c++) {
+    double m = sum[c] / out.count;
+    double var = sq[c] / out.count - m * m;
+    out.mean[c] = (float)m;
+    out.stddev[c] = var > 0 ? (float)sqrt(var) : 0.0f;
+  }
+}
+
+static void checkWindow(const StatSummary &got, const StatSummary &want, int channels) {
+  TEST_ASSERT_EQUAL_UINT32(want.count, got.count);
+  for (int c = 0; c < channels; c++) {
+    TEST_ASSERT_EQUAL_FLOAT(want.min[c], got.min[c]);
+    TEST_ASSERT_EQUAL_FLOAT(want.max[c], got.max[c]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, want.mean[c], got.mean[c]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, want.stddev[c], got.stddev[c]);
+  }
+}
+
+void setUp() {}
+void tearDown() {}
+
+// 30 h of 1 Hz samples on a slow drift plus noise; both windows are compared
+// after every few blocks, so block closes, evictions and deque expiry are all hit
+static void test_windows_match_brute_force() {
+  RollingStats rs;
+  TEST_ASSERT_TRUE(rs.begin());
+  std::vector<Sample> all;
+  for (uint32_t t = 0; t < 30 * 3600; t++) {
+    Sample s;
+    s.t = t;
+    s.x[STAT_TEMP] = 27.0f + 4.0f * sinf(t / 5000.0f) + noise(0.5f);
+    s.x[STAT_HUM] = 65.0f + 10.0f * cosf(t / 7000.0f) + noise(2.0f);
+    s.x[STAT_DEW] = 19.0f + noise(1.0f);
+    rs.add(t, s.x);
+    all.push_back(s);
+    if (t % 997 == 0 || t == 30 * 3600 - 1) {
+      for (int w = 0; w < STATS_WINDOWS; w++) {
+        StatSummary got, want;
+        rs.window(w, got);
+        bruteWindow(all, w, want);
+        checkWindow(got, want, STAT_CHANNELS);
+      }
+    }
+  }
+  TEST_ASSERT_EQUAL(all.size(), rs.totalSamples());
+}
+
+// A gap longer than the window empties it down to the new block
+static void test_gap_longer_than_window() {
+  RollingStats rs;
+  TEST_ASSERT_TRUE(rs.begin());
+  const float a[STAT_CHANNELS] = { 10, 20, 5 }, b[STAT_CHANNELS] = { 30, 60, 15 };
+  for (uint32_t t = 0; t < 600; t++) rs.add(t, a);
+  rs.add(600 + 2 * 86400, b);
+  for (int w = 0; w < STATS_WINDOWS; w++) {
+    StatSummary s;
+    rs.window(w, s);
+    TEST_ASSERT_EQUAL_UINT32(1, s.count);
+    TEST_ASSERT_EQUAL_FLOAT(30.0f, s.min[STAT_TEMP]);
+    TEST_ASSERT_EQUAL_FLOAT(30.0f, s.max[STAT_TEMP]);
+  }
+}
+
+class ConstDriver : public SensorDriver {
+public:
+  const char *kind() const override { return "test"; }
+  bool hasHumidity() const override { return true; }
+  SensorPoll collect(float &t, float &h) override { t = 0; h = 0; return SENSOR_OK; }
+  SensorDriverCounters counters() const override { return {}; }
+  void address(char *out, size_t len) const override { snprintf(out, len, "-"); }
+};
+
+// Feed the pipeline a millis() clock that wraps 30 min in; the windows must
+// keep matching the samples by true elapsed time on both sides of the wrap
+static void test_pipeline_survives_millis_wrap() {
+  static ConstDriver driver;
+  static SensorHub hub;
+  static SensorPipeline pipeline;
+  hub.add("t1", &driver);
+  TEST_ASSERT_TRUE(pipeline.begin(hub, PSYCHRO_EXACT));
+
+  const uint32_t startMs = 0xFFFFFFFFu - 30u * 60u * 1000u;
+  std::vector<Sample> all;
+  for (uint32_t i = 0; i < 3 * 3600; i++) {
+    const uint64_t uptimeMs = (uint64_t)startMs + (uint64_t)i * 1000;
+    float temp = 25.0f + 3.0f * sinf(i / 900.0f) + noise(0.4f);
+    float hum = 60.0f + noise(4.0f);
+    const SensorSnapshot &snap = pipeline.process(1u, &temp, &hum, (uint32_t)uptimeMs);
+    Sample s;
+    s.t = uptimeMs / 1000;
+    s.x[STAT_TEMP] = temp;
+    s.x[STAT_HUM] = hum;
+    s.x[STAT_DEW] = snap.channels[0].data.dewPoint;
+    all.push_back(s);
+    if (i % 293 == 0 || i == 3 * 3600 - 1) {
+      for (int w = 0; w < STATS_WINDOWS; w++) {
+        StatSummary want;
+        bruteWindow(all, w, want);
+        checkWindow(snap.channels[0].stats.windows[w], want, STAT_CHANNELS);
+      }
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_windows_match_brute_force);
+  RUN_TEST(test_gap_longer_than_window);
+  RUN_TEST(test_pipeline_survives_millis_wrap);
+  return UNITY_END();
+}
@@ -0,0 +1,140 @@
+// RollupEngine bucket contents per tier, ring reuse, the query cursor's JSON,
+// and rollups fed from SensorPipeline's clock across the 49.7-day millis() wrap.
+#include <unity.h>
+#include <string>
+#include "rollup.h"
+#include "sensor_channel.h"
+#include "sensor_pipeline.h"
+
+static RollupEngine engine;
+
+static std::string readAll(RollupEngine::Cursor &c, size_t chunk) {
+  std::string out;
+  uint8_t buf[64];
+  while (size_t n = c.read(buf, std::min(chunk, sizeof(buf)))) out.append((const char*)buf, n);
+  return out;
+}
+
+static uint32_t countPoints(const std::string &json) {
+  uint32_t n = 0;
+  size_t i = json.find("\"points\":[");
+  if (i == std::string::npos) return 0;
+  for (i = json.find('[', i); (i = json.find('[', i + 1)) != std::string::npos;) n++;
+  return n;
+}
+
+void setUp() {}
+void tearDown() {}
+
+// Two hours of 1 Hz samples: temperature is the second within the minute,
+// humidity the minute within the hour
+static void test_bucket_contents() {
+  TEST_ASSERT_TRUE(engine.begin());
+  for (uint32_t t = 0; t < 7200; t++) engine.add(t, (float)(t % 60), 40.0f + (t / 60) % 60);
+
+  RollupBucket b;
+  TEST_ASSERT_TRUE(engine.bucketAt(1, 120, b));          // 1 min tier, third minute
+  TEST_ASSERT_EQUAL_UINT32(120, b.start);
+  TEST_ASSERT_EQUAL_UINT32(60, b.count);
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, b.tMin);
+  TEST_ASSERT_EQUAL_FLOAT(59.0f, b.tMax);
+  TEST_ASSERT_EQUAL_FLOAT(1770.0, (float)b.tSum);
+  TEST_ASSERT_EQUAL_FLOAT(42.0f, b.hMin);
+  TEST_ASSERT_EQUAL_FLOAT(42.0f, b.hMax);
+
+  TEST_ASSERT_TRUE(engine.bucketAt(2, 900, b));          // 15 min tier
+  TEST_ASSERT_EQUAL_UINT32(900, b.count);
+  TEST_ASSERT_EQUAL_FLOAT(55.0f, b.hMin);
+  TEST_ASSERT_EQUAL_FLOAT(69.0f, b.hMax);
+
+  TEST_ASSERT_TRUE(engine.bucketAt(3, 3600, b));         // 1 h tier
+  TEST_ASSERT_EQUAL_UINT32(3600, b.count);
+  TEST_ASSERT_EQUAL_FLOAT(29.5f, (float)(b.tSum / b.count));
+
+  // The 1 s tier keeps one hour: the first hour's slots were taken by the second
+  TEST_ASSERT_FALSE(engine.bucketAt(0, 5, b));
+  TEST_ASSERT_TRUE(engine.bucketAt(0, 3605, b));
+  TEST_ASSERT_EQUAL_UINT32(1, b.count);
+  TEST_ASSERT_EQUAL_FLOAT(5.0f, b.tMin);
+  // Never written
+  TEST_ASSERT_FALSE(engine.bucketAt(1, 7200, b));
+}
+
+static void test_select_tier() {
+  // 2 h at >= 100 points: 1 min buckets; 1 h at >= 3000 points: 1 s
+  TEST_ASSERT_EQUAL(1, engine.selectTier(0, 7200, 7200, 100));
+  TEST_ASSERT_EQUAL(0, engine.selectTier(3600, 7199, 7200, 3000));
+  // 1 s buckets no longer reach back to 0
+  TEST_ASSERT_EQUAL(1, engine.selectTier(0, 600, 7200, 600));
+}
+
+static void test_cursor_json() {
+  RollupEngine::Cursor c(engine, 1, 60, 179, 1000, false);
+  std::string json = readAll(c, 7);    // small reads split every line
+  TEST_ASSERT_EQUAL_STRING(
+    "{\"tier\":60,\"from\":1060,\"to\":1179,\"units\":\"C\",\"points\":["
+    "[1060,0.00,29.50,59.00,41.00,41.00,41.00,60],"
+    "[1120,0.00,29.50,59.00,42.00,42.00,42.00,60]]}", json.c_str());
+
+  RollupEngine::Cursor f(engine, 1, 60, 60, 0, true);
+  json = readAll(f, 64);
+  TEST_ASSERT_EQUAL_STRING(
+    "{\"tier\":60,\"from\":60,\"to\":60,\"units\":\"F\",\"points\":["
+    "[60,32.00,85.10,138.20,41.00,41.00,41.00,60]]}", json.c_str());
+}
+
+class ConstDriver : public SensorDriver {
+public:
+  const char *kind() const override { return "test"; }
+  bool hasHumidity() const override { return true; }
+  SensorPoll collect(float &t, float &h) override { t = 0; h = 0; return SENSOR_OK; }
+  SensorDriverCounters counters() const override { return {}; }
+  void address(char *out, size_t len) const override { snprintf(out, len, "-"); }
+};
+
+// One hour of 1 Hz samples through SensorPipeline, with millis() wrapping
+// halfway: every minute bucket must be full and contiguous in uptime, and the
+// cursor must return all of them in order
+static void test_millis_wrap() {
+  static ConstDriver driver;
+  static SensorHub hub;
+  static SensorPipeline pipeline;
+  static RollupEngine wrapped;
+  hub.add("t1", &driver);
+  TEST_ASSERT_TRUE(pipeline.begin(hub, PSYCHRO_EXACT));
+  TEST_ASSERT_TRUE(wrapped.begin());
+
+  const uint32_t startMs = 0xFFFFFFFFu - 30u * 60u * 1000u + 1;
+  uint32_t firstSec = 0, lastSec = 0;
+  for (uint32_t i = 0; i < 3600; i++) {
+    float temp = 20.0f + i / 60, hum = 50.0f;
+    const SensorSnapshot &snap = pipeline.process(1u, &temp, &hum, startMs + i * 1000u);
+    wrapped.add(snap.uptimeSec, snap.channels[0].data.temperature, snap.channels[0].data.humidity);
+    if (!i) firstSec = snap.uptimeSec;
+    lastSec = snap.uptimeSec;
+  }
+  TEST_ASSERT_EQUAL_UINT32(3599, lastSec - firstSec);
+  TEST_ASSERT_TRUE(lastSec > 0xFFFFFFFFu / 1000);
+
+  const uint32_t from = firstSec - firstSec % 60 + 60, to = lastSec - lastSec % 60 - 1;
+  uint32_t minutes = 0;
+  for (uint32_t s = from; s < to; s += 60, minutes++) {
+    RollupBucket b;
+    TEST_ASSERT_TRUE(wrapped.bucketAt(1, s, b));
+    TEST_ASSERT_EQUAL_UINT32(60, b.count);
+    TEST_ASSERT_TRUE(b.tMax - b.tMin <= 1.0f);
+  }
+  TEST_ASSERT_TRUE(minutes >= 58);
+
+  RollupEngine::Cursor c(wrapped, 1, from, to, 0, false);
+  TEST_ASSERT_EQUAL_UINT32(minutes, countPoints(readAll(c, 64)));
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_bucket_contents);
+  RUN_TEST(test_select_tier);
+  RUN_TEST(test_cursor_json);
+  RUN_TEST(test_millis_wrap);
+  return UNITY_END();
+}
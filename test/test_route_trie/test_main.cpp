@@ -0,0 +1,77 @@
+// RouteTrie, the path matching behind ApiRouter: exact segment matches only,
+// empty segments ignored, shared prefixes, capacity limits.
+#include <unity.h>
+#include "route_trie.h"
+
+void setUp() {}
+void tearDown() {}
+
+static void test_exact_paths_match() {
+  RouteTrie<16> trie;
+  int16_t data = trie.insert("/api/data");
+  int16_t hist = trie.insert("/api/history");
+  int16_t reboot = trie.insert("/api/system/reboot");
+  TEST_ASSERT_TRUE(data > 0 && hist > 0 && reboot > 0);
+  TEST_ASSERT_TRUE(data != hist && hist != reboot);
+  TEST_ASSERT_EQUAL_INT(data, trie.find("/api/data"));
+  TEST_ASSERT_EQUAL_INT(hist, trie.find("/api/history"));
+  TEST_ASSERT_EQUAL_INT(reboot, trie.find("/api/system/reboot"));
+  // api, data, history, system, reboot + root
+  TEST_ASSERT_EQUAL_INT(6, trie.nodeCount());
+}
+
+static void test_prefixes_and_extensions_do_not_match() {
+  RouteTrie<16> trie;
+  trie.insert("/api/camera/snapshot");
+  trie.insert("/api/camera/snapshot_full");
+  TEST_ASSERT_EQUAL_INT(-1, trie.find("/api/camera/snap"));
+  TEST_ASSERT_EQUAL_INT(-1, trie.find("/api/camera/snapshotx"));
+  TEST_ASSERT_EQUAL_INT(-1, trie.find("/api/camera/snapshot/extra"));
+  TEST_ASSERT_EQUAL_INT(-1, trie.find("/API/camera/snapshot"));
+  TEST_ASSERT_TRUE(trie.find("/api/camera/snapshot") != trie.find("/api/camera/snapshot_full"));
+  // Intermediate nodes exist but carry no value until a route ends there
+  int16_t camera = trie.find("/api/camera");
+  TEST_ASSERT_TRUE(camera > 0);
+  TEST_ASSERT_EQUAL_INT(-1, trie.value(camera));
+}
+
+static void test_empty_segments_are_ignored() {
+  RouteTrie<16> trie;
+  int16_t n = trie.insert("/api/wifi/status");
+  TEST_ASSERT_EQUAL_INT(n, trie.find("api/wifi/status"));
+  TEST_ASSERT_EQUAL_INT(n, trie.find("//api//wifi/status/"));
+  TEST_ASSERT_EQUAL_INT(0, trie.find("/"));
+  TEST_ASSERT_EQUAL_INT(0, trie.find(""));
+}
+
+static void test_values_and_reinsert() {
+  RouteTrie<16> trie;
+  int16_t a = trie.insert("/metrics");
+  trie.setValue(a, 7);
+  TEST_ASSERT_EQUAL_INT(a, trie.insert("/metrics"));
+  TEST_ASSERT_EQUAL_INT(7, trie.value(trie.find("/metrics")));
+  TEST_ASSERT_EQUAL_INT(2, trie.nodeCount());
+}
+
+static void test_capacity() {
+  RouteTrie<4> trie;
+  TEST_ASSERT_TRUE(trie.insert("/a/b/c") > 0);
+  TEST_ASSERT_EQUAL_INT(-1, trie.insert("/a/d"));
+  TEST_ASSERT_TRUE(trie.find("/a/b/c") > 0);
+
+  static char longSeg[300];
+  memset(longSeg, 'x', sizeof(longSeg) - 1);
+  longSeg[0] = '/';
+  RouteTrie<4> big;
+  TEST_ASSERT_EQUAL_INT(-1, big.insert(longSeg));
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_exact_paths_match);
+  RUN_TEST(test_prefixes_and_extensions_do_not_match);
+  RUN_TEST(test_empty_segments_are_ignored);
+  RUN_TEST(test_values_and_reinsert);
+  RUN_TEST(test_capacity);
+  return UNITY_END();
+}
@@ -0,0 +1,109 @@
+// SeqLock under contention: one writer publishing as fast as it can and
+// several readers on other threads. Every payload word is derived from the
+// publish count, so a torn copy (words from two publishes) is detectable.
+#include <unity.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "seqlock.h"
+
+#define STRESS_READERS    4
+#define STRESS_PUBLISHES  2000000u
+#define PAYLOAD_WORDS     48      // larger than a cache line, like SensorSnapshot
+
+struct Payload {
+  uint32_t seq;
+  uint32_t words[PAYLOAD_WORDS];
+};
+
+static void fill(Payload &p, uint32_t seq) {
+  p.seq = seq;
+  for (uint32_t i = 0; i < PAYLOAD_WORDS; i++) p.words[i] = seq * 2654435761u + i;
+}
+
+static bool consistent(const Payload &p) {
+  for (uint32_t i = 0; i < PAYLOAD_WORDS; i++) {
+    if (p.words[i] != p.seq * 2654435761u + i) return false;
+  }
+  return true;
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_unpublished_read_is_zero() {
+  SeqLock<Payload> lock;
+  Payload p;
+  memset(&p, 0xFF, sizeof(p));
+  TEST_ASSERT_EQUAL_UINT32(0, lock.read(p));
+  TEST_ASSERT_EQUAL_UINT32(0, p.seq);
+  TEST_ASSERT_EQUAL_UINT32(0, p.words[PAYLOAD_WORDS - 1]);
+}
+
+static void test_publish_count() {
+  SeqLock<Payload> lock;
+  Payload p;
+  for (uint32_t i = 1; i <= 5; i++) {
+    fill(p, i);
+    TEST_ASSERT_EQUAL_UINT32(i, lock.publish(p));
+  }
+  Payload out;
+  TEST_ASSERT_EQUAL_UINT32(5, lock.read(out));
+  TEST_ASSERT_EQUAL_UINT32(5, out.seq);
+  TEST_ASSERT_EQUAL_UINT32(5, lock.sequence());
+}
+
+// Readers must only ever see whole payloads, matching the returned publish
+// count, and never go backwards
+static void test_concurrent_readers_never_tear() {
+  static SeqLock<Payload> lock;
+  std::atomic<bool> done{false};
+  std::atomic<uint32_t> torn{0}, mismatched{0}, backwards{0}, reads{0};
+
+  std::vector<std::thread> readers;
+  for (int r = 0; r < STRESS_READERS; r++) {
+    readers.emplace_back([&]() {
+      Payload p;
+      uint32_t last = 0, n = 0;
+      while (!done.load(std::memory_order_relaxed)) {
+        uint32_t seq = lock.read(p);
+        n++;
+        if (!seq) continue;
+        if (!consistent(p)) torn++;
+        if (p.seq != seq) mismatched++;
+        if (seq < last) backwards++;
+        last = seq;
+      }
+      reads += n;
+    });
+  }
+
+  std::thread writer([&]() {
+    Payload p;
+    for (uint32_t i = 1; i <= STRESS_PUBLISHES; i++) {
+      fill(p, i);
+      lock.publish(p);
+    }
+    done = true;
+  });
+
+  writer.join();
+  for (auto &t : readers) t.join();
+
+  char msg[96];
+  snprintf(msg, sizeof(msg), "%u reads, %u retries", (unsigned)reads.load(), (unsigned)lock.retries());
+  TEST_MESSAGE(msg);
+  TEST_ASSERT_EQUAL_UINT32(0, torn.load());
+  TEST_ASSERT_EQUAL_UINT32(0, mismatched.load());
+  TEST_ASSERT_EQUAL_UINT32(0, backwards.load());
+  TEST_ASSERT_EQUAL_UINT32(STRESS_PUBLISHES, lock.sequence());
+  TEST_ASSERT_TRUE(reads.load() > 0);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_unpublished_read_is_zero);
+  RUN_TEST(test_publish_count);
+  RUN_TEST(test_concurrent_readers_never_tear);
+  return UNITY_END();
+}
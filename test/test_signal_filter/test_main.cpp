@@ -0,0 +1,176 @@
+// SignalFilter stages on short hand-checked sequences: median, MAD and rate
+// rejection (including the re-seed on a real step change), EMA smoothing and
+// decimation, alone and chained.
+#include <unity.h>
+#include <math.h>
+#include "signal_filter.h"
+
+#define STEP_MS 1000
+
+// Push n samples at 1 Hz starting at t0; outputs (NAN where none) go to out
+static void feed(SignalFilter &f, const float *x, int n, float *out, uint32_t t0 = 0) {
+  for (int i = 0; i < n; i++) {
+    float y;
+    out[i] = f.push(x[i], t0 + i * STEP_MS, y) ? y : NAN;
+  }
+}
+
+static void expect(const float *want, const float *got, int n) {
+  for (int i = 0; i < n; i++) {
+    char msg[24];
+    snprintf(msg, sizeof(msg), "sample %d", i);
+    if (isnan(want[i])) TEST_ASSERT_TRUE_MESSAGE(isnan(got[i]), msg);
+    else TEST_ASSERT_FLOAT_WITHIN_MESSAGE(1e-5f, want[i], got[i], msg);
+  }
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_passthrough() {
+  SignalFilter f;
+  f.configure(FilterConfig());
+  const float x[] = { 20.0f, 35.0f, -4.0f, 21.5f };
+  float out[4];
+  feed(f, x, 4, out);
+  expect(x, out, 4);
+}
+
+// Median of the newest N accepted samples; fewer while the window fills
+// (even counts average the middle two)
+static void test_median() {
+  FilterConfig cfg;
+  cfg.median = 3;
+  SignalFilter f;
+  f.configure(cfg);
+  const float x[]    = { 1, 5, 2, 8, 3, 3, 9 };
+  const float want[] = { 1, 3, 2, 5, 3, 3, 3 };
+  float out[7];
+  feed(f, x, 7, out);
+  expect(want, out, 7);
+
+  // Even windows are rounded down to odd ones
+  cfg.median = 4;
+  f.configure(cfg);
+  TEST_ASSERT_EQUAL_UINT8(3, f.config().median);
+}
+
+// |x - median| > k * 1.4826 * MAD over the accepted window; a rejected sample
+// repeats the last output
+static void test_mad_rejection() {
+  FilterConfig cfg;
+  cfg.madK = 3.0f;
+  SignalFilter f;
+  f.configure(cfg);
+  // Window median 20.0, MAD 0.1 -> threshold 0.445
+  const float x[]    = { 20.0f, 20.1f, 19.9f, 20.0f, 20.2f, 25.0f, 20.4f, 20.3f, 19.0f };
+  const float want[] = { 20.0f, 20.1f, 19.9f, 20.0f, 20.2f, 20.2f, 20.4f, 20.3f, 20.3f };
+  float out[9];
+  feed(f, x, 9, out);
+  expect(want, out, 9);
+  TEST_ASSERT_EQUAL_UINT32(2, f.rejectedMad());
+  TEST_ASSERT_EQUAL_UINT32(0, f.rejectedRate());
+}
+
+// A flat window has MAD 0: the next small step is not an outlier
+static void test_mad_flat_window() {
+  FilterConfig cfg;
+  cfg.madK = 3.0f;
+  SignalFilter f;
+  f.configure(cfg);
+  const float x[] = { 20.0f, 20.0f, 20.0f, 20.0f, 20.0f, 20.1f };
+  float out[6];
+  feed(f, x, 6, out);
+  expect(x, out, 6);
+  TEST_ASSERT_EQUAL_UINT32(0, f.rejectedMad());
+}
+
+// Rate limit against the last accepted sample and the time since it
+static void test_rate_rejection() {
+  FilterConfig cfg;
+  cfg.maxRate = 1.0f;       // units per second
+  SignalFilter f;
+  f.configure(cfg);
+  // 23.0 is 2.5 above 20.5 after 1 s; 21.5 is 1.0 above it after 2 s
+  const float x[]    = { 20.0f, 20.5f, 23.0f, 21.5f };
+  const float want[] = { 20.0f, 20.5f, 20.5f, 21.5f };
+  float out[4];
+  feed(f, x, 4, out);
+  expect(want, out, 4);
+  TEST_ASSERT_EQUAL_UINT32(1, f.rejectedRate());
+}
+
+// FILTER_MAX_REJECTS outliers in a row are a real step: the filter re-seeds on
+// the new level instead of holding the old one forever
+static void test_step_change_reseeds() {
+  FilterConfig cfg;
+  cfg.maxRate = 1.0f;
+  cfg.median = 3;
+  SignalFilter f;
+  f.configure(cfg);
+  const float x[]    = { 20, 20, 30, 30, 30, 30, 30, 30 };
+  const float want[] = { 20, 20, 20, 20, 20, 20, 30, 30 };
+  static_assert(FILTER_MAX_REJECTS == 5, "sequence assumes 4 held samples");
+  float out[8];
+  feed(f, x, 8, out);
+  expect(want, out, 8);
+  TEST_ASSERT_EQUAL_UINT32(FILTER_MAX_REJECTS, f.rejectedRate());
+}
+
+static void test_ema() {
+  FilterConfig cfg;
+  cfg.smoothing = FILTER_SMOOTH_EMA;
+  cfg.emaAlpha = 0.5f;
+  SignalFilter f;
+  f.configure(cfg);
+  const float x[]    = { 0, 10, 10, 10, 2 };
+  const float want[] = { 0, 5, 7.5f, 8.75f, 5.375f };
+  float out[5];
+  feed(f, x, 5, out);
+  expect(want, out, 5);
+}
+
+// Mean of every D outputs; NaN inputs are ignored and do not advance it
+static void test_decimation() {
+  FilterConfig cfg;
+  cfg.decimation = 3;
+  SignalFilter f;
+  f.configure(cfg);
+  const float x[]    = { 1, 2, 3, 4, NAN, 5, 6, 7, 8, 9 };
+  const float want[] = { NAN, NAN, 2, NAN, NAN, NAN, 5, NAN, NAN, 8 };
+  float out[10];
+  feed(f, x, 10, out);
+  expect(want, out, 10);
+}
+
+// Rejected samples count towards decimation as the held value, so channels
+// fed in lockstep still emit together
+static void test_chain_keeps_decimation_cadence() {
+  FilterConfig cfg;
+  cfg.decimation = 2;
+  cfg.median = 3;
+  cfg.maxRate = 2.0f;
+  SignalFilter f;
+  f.configure(cfg);
+  // Accepted: 10, 12, 11, 13, 12 (median 10, 11, 11, 12, 12); 40 is held as 11
+  const float x[]    = { 10, 12, 11, 40, 13, 12 };
+  const float want[] = { NAN, 10.5f, NAN, 11, NAN, 12 };
+  float out[6];
+  feed(f, x, 6, out);
+  expect(want, out, 6);
+  TEST_ASSERT_EQUAL_UINT32(1, f.rejectedRate());
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_passthrough);
+  RUN_TEST(test_median);
+  RUN_TEST(test_mad_rejection);
+  RUN_TEST(test_mad_flat_window);
+  RUN_TEST(test_rate_rejection);
+  RUN_TEST(test_step_change_reseeds);
+  RUN_TEST(test_ema);
+  RUN_TEST(test_decimation);
+  RUN_TEST(test_chain_keeps_decimation_cadence);
+  return UNITY_END();
+}
@@ -0,0 +1,143 @@
+// Binary telemetry frames decoded at the byte offsets the dashboard uses
+// (data/script.js decodeTelemetry): the 96-byte header, which keeps the v1
+// offsets with the former reserved byte now holding the channel count, and the
+// v2 channel records after it.
+#include <unity.h>
+#include <math.h>
+#include <string.h>
+#include "telemetry_frame.h"
+#include "sensor_pipeline.h"
+
+static float f32(const uint8_t *b, size_t o) { float v; memcpy(&v, b + o, 4); return v; }
+static uint32_t u32(const uint8_t *b, size_t o) {
+  return b[o] | (uint32_t)b[o + 1] << 8 | (uint32_t)b[o + 2] << 16 | (uint32_t)b[o + 3] << 24;
+}
+
+static uint8_t tempStatus(float c) { return c > 30 ? TELEMETRY_STATUS_TOO_HOT : c < 20 ? TELEMETRY_STATUS_TOO_COLD : TELEMETRY_STATUS_PERFECT; }
+static uint8_t humStatus(float rh) { return rh > 80 ? TELEMETRY_STATUS_TOO_WET : rh < 40 ? TELEMETRY_STATUS_TOO_DRY : TELEMETRY_STATUS_PERFECT; }
+
+static SensorSnapshot snap;
+static TelemetryContext ctx;
+
+void setUp() {
+  memset(&snap, 0, sizeof(snap));
+  snap.channelCount = 2;
+  ChannelState &a = snap.channels[0];
+  a.hasHumidity = true;
+  a.data = { 25.0f, 85.0f, 22.4f, 25.5f, 0.48f, 19.6f, 123456u, true };
+  a.stats.initialized = true;
+  a.stats.boot.count = 42;
+  const float mins[3] = { 20.0f, 50.0f, 10.0f }, maxs[3] = { 30.0f, 90.0f, 24.0f }, means[3] = { 25.0f, 70.0f, 19.0f };
+  for (int c = 0; c < STAT_CHANNELS; c++) {
+    a.stats.boot.min[c] = mins[c];
+    a.stats.boot.max[c] = maxs[c];
+    a.stats.boot.mean[c] = means[c];
+  }
+  ChannelState &b = snap.channels[1];
+  b.hasHumidity = false;
+  b.data = { 35.0f, NAN, NAN, NAN, NAN, NAN, 123000u, true };
+
+  memset(&ctx, 0, sizeof(ctx));
+  ctx.seq = 7;
+  ctx.uptime = 130000;
+  ctx.sta = true;
+  ctx.rssi = -61;
+  ctx.freeHeap = 150000;
+  ctx.freePsram = 4000000;
+  ctx.sensorHz = 1.0f;
+  ctx.tempStatus = tempStatus;
+  ctx.humStatus = humStatus;
+}
+void tearDown() {}
+
+static void test_header_offsets() {
+  uint8_t buf[256];
+  size_t len = telemetryPackLive(snap, ctx, buf, sizeof(buf));
+  TEST_ASSERT_EQUAL(96 + 2 * 20, len);
+  TEST_ASSERT_EQUAL_HEX8(TELEMETRY_MAGIC, buf[0]);
+  TEST_ASSERT_EQUAL_UINT8(2, buf[1]);
+  TEST_ASSERT_EQUAL_UINT8(TELEMETRY_FRAME_LIVE, buf[2]);
+  TEST_ASSERT_EQUAL_HEX8(TELEMETRY_FLAG_VALID | TELEMETRY_FLAG_STATS | TELEMETRY_FLAG_STA, buf[3]);
+  TEST_ASSERT_EQUAL_UINT32(7, u32(buf, 4));
+  TEST_ASSERT_EQUAL_UINT32(123456, u32(buf, 8));
+  TEST_ASSERT_EQUAL_UINT32(130000, u32(buf, 12));
+  TEST_ASSERT_EQUAL_FLOAT(25.0f, f32(buf, 16));
+  TEST_ASSERT_EQUAL_FLOAT(85.0f, f32(buf, 20));
+  TEST_ASSERT_EQUAL_FLOAT(22.4f, f32(buf, 24));
+  TEST_ASSERT_EQUAL_FLOAT(25.5f, f32(buf, 28));
+  TEST_ASSERT_EQUAL_FLOAT(0.48f, f32(buf, 32));
+  TEST_ASSERT_EQUAL_FLOAT(19.6f, f32(buf, 36));
+  TEST_ASSERT_EQUAL_UINT8(TELEMETRY_STATUS_PERFECT, buf[40]);
+  TEST_ASSERT_EQUAL_UINT8(TELEMETRY_STATUS_TOO_WET, buf[41]);
+  TEST_ASSERT_EQUAL_INT8(-61, (int8_t)buf[42]);
+  TEST_ASSERT_EQUAL_UINT8(2, buf[43]);               // v1: reserved
+  const float stats[9] = { 20, 30, 25, 50, 90, 70, 10, 24, 19 };
+  for (int i = 0; i < 9; i++) TEST_ASSERT_EQUAL_FLOAT(stats[i], f32(buf, 44 + 4 * i));
+  TEST_ASSERT_EQUAL_UINT32(42, u32(buf, 80));
+  TEST_ASSERT_EQUAL_UINT32(150000, u32(buf, 84));
+  TEST_ASSERT_EQUAL_UINT32(4000000, u32(buf, 88));
+  TEST_ASSERT_EQUAL_FLOAT(1.0f, f32(buf, 92));
+}
+
+// Temperature-only channels send zeros and no humidity flag
+static void test_channel_records() {
+  uint8_t buf[256];
+  telemetryPackLive(snap, ctx, buf, sizeof(buf));
+  const uint8_t *a = buf + 96, *b = buf + 116;
+  TEST_ASSERT_EQUAL_UINT8(0, a[0]);
+  TEST_ASSERT_EQUAL_HEX8(TELEMETRY_CH_VALID | TELEMETRY_CH_HUMIDITY, a[1]);
+  TEST_ASSERT_EQUAL_UINT8(TELEMETRY_STATUS_PERFECT, a[2]);
+  TEST_ASSERT_EQUAL_UINT8(TELEMETRY_STATUS_TOO_WET, a[3]);
+  TEST_ASSERT_EQUAL_FLOAT(25.0f, f32(a, 4));
+  TEST_ASSERT_EQUAL_FLOAT(85.0f, f32(a, 8));
+  TEST_ASSERT_EQUAL_FLOAT(22.4f, f32(a, 12));
+  TEST_ASSERT_EQUAL_FLOAT(0.48f, f32(a, 16));
+
+  TEST_ASSERT_EQUAL_UINT8(1, b[0]);
+  TEST_ASSERT_EQUAL_HEX8(TELEMETRY_CH_VALID, b[1]);
+  TEST_ASSERT_EQUAL_UINT8(TELEMETRY_STATUS_TOO_HOT, b[2]);
+  TEST_ASSERT_EQUAL_UINT8(TELEMETRY_STATUS_PERFECT, b[3]);
+  TEST_ASSERT_EQUAL_FLOAT(35.0f, f32(b, 4));
+  for (int o = 8; o < 20; o += 4) TEST_ASSERT_EQUAL_FLOAT(0.0f, f32(b, o));
+}
+
+// Display-unit temperatures convert; humidity, VPD and statistics stay as sent in JSON
+static void test_fahrenheit() {
+  ctx.fahrenheit = true;
+  uint8_t buf[256];
+  telemetryPackLive(snap, ctx, buf, sizeof(buf));
+  TEST_ASSERT_TRUE(buf[3] & TELEMETRY_FLAG_UNITS_F);
+  TEST_ASSERT_EQUAL_FLOAT(77.0f, f32(buf, 16));
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 72.32f, f32(buf, 24));
+  TEST_ASSERT_EQUAL_FLOAT(85.0f, f32(buf, 20));
+  TEST_ASSERT_EQUAL_FLOAT(20.0f, f32(buf, 44));
+  TEST_ASSERT_EQUAL_FLOAT(95.0f, f32(buf, 116 + 4));
+}
+
+// Records that do not fit are left out and the count says so
+static void test_capacity() {
+  uint8_t buf[256];
+  TEST_ASSERT_EQUAL(0, telemetryPackLive(snap, ctx, buf, 95));
+  TEST_ASSERT_EQUAL(96, telemetryPackLive(snap, ctx, buf, 96));
+  TEST_ASSERT_EQUAL_UINT8(0, buf[43]);
+  TEST_ASSERT_EQUAL(116, telemetryPackLive(snap, ctx, buf, 135));
+  TEST_ASSERT_EQUAL_UINT8(1, buf[43]);
+}
+
+static void test_no_stats_until_initialized() {
+  snap.channels[0].stats.initialized = false;
+  uint8_t buf[256];
+  telemetryPackLive(snap, ctx, buf, sizeof(buf));
+  TEST_ASSERT_FALSE(buf[3] & TELEMETRY_FLAG_STATS);
+  for (int o = 44; o < 84; o += 4) TEST_ASSERT_EQUAL_UINT32(0, u32(buf, o));
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_header_offsets);
+  RUN_TEST(test_channel_records);
+  RUN_TEST(test_fahrenheit);
+  RUN_TEST(test_capacity);
+  RUN_TEST(test_no_stats_until_initialized);
+  return UNITY_END();
+}